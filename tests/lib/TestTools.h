@@ -6,6 +6,8 @@
 
 #include "zypp/Pathname.h"
 #include "zypp/PathInfo.h"
+#include "zypp/TmpPath.h"
+#include <zypp-media/MediaConfig>
 
 namespace TestTools {
   //read all contents of a file into a string)
@@ -23,6 +25,25 @@ namespace TestTools {
       std::istreambuf_iterator<char>());
     return str;
   }
+
+  //keep the mirror statistics in a fresh temp file instead of the ones of the host
+  //(use as BOOST_GLOBAL_FIXTURE or scoped in a test case)
+  struct ScopedMirrorStats
+  {
+    ScopedMirrorStats()
+      : _prev( zypp::MediaConfig::instance().download_mirror_stats_file() )
+    { zypp::MediaConfig::instance().setDownloadMirrorStatsFile( file() ); }
+
+    ~ScopedMirrorStats()
+    { zypp::MediaConfig::instance().setDownloadMirrorStatsFile( _prev ); }
+
+    zypp::Pathname file() const
+    { return _dir.path() / "mirrorstats"; }
+
+  private:
+    zypp::filesystem::TmpDir _dir;
+    zypp::Pathname _prev;
+  };
 }
 
 
@@ -0,0 +1,230 @@
+#include <iostream>
+#include <fstream>
+#include <random>
+#include <boost/test/unit_test.hpp>
+
+#include <zypp-core/AutoDispose.h>
+#include <zypp-core/fs/TmpPath.h>
+#include <zypp-curl/parser/MediaBlockList>
+
+using namespace zypp;
+using namespace zypp::media;
+
+namespace
+{
+  constexpr size_t blksize = 1024;
+  constexpr size_t nblks   = 64;
+
+  std::string randomData( std::mt19937 & gen_r, size_t size_r )
+  {
+    std::string ret( size_r, '\0' );
+    for ( auto & c : ret )
+      c = char( gen_r() );
+    return ret;
+  }
+
+  std::string readFile( const Pathname & file_r )
+  {
+    std::ifstream in( file_r.c_str() );
+    return std::string( std::istreambuf_iterator<char>( in ), std::istreambuf_iterator<char>() );
+  }
+
+  /** Blocklist with rsums (unless \a rsumseq_r is 0) and sha1 checksums for \a data_r, a short last block is zero padded. */
+  MediaBlockList makeBlockList( const std::string & data_r, uint rsumseq_r, size_t blksize_r = blksize )
+  {
+    MediaBlockList bl( data_r.size() );
+    const size_t pad = data_r.size() % blksize_r ? blksize_r : 0;
+    for ( size_t i = 0; i * blksize_r < data_r.size(); ++i )
+    {
+      std::string blk { data_r.substr( i * blksize_r, blksize_r ) };
+      bl.addBlock( i * blksize_r, blk.size() );
+      blk.resize( blksize_r, '\0' );
+      if ( rsumseq_r )
+        bl.setRsum( i, 4, bl.updateRsum( 0, blk.data(), blksize_r ), pad );
+
+      Digest dig;
+      dig.create( Digest::sha1() );
+      dig.update( blk.data(), blksize_r );
+      UByteArray cs { dig.digestVector() };
+      bl.setChecksum( i, Digest::sha1(), cs.size(), cs.data(), pad );
+    }
+    bl.setRsumSequence( rsumseq_r );
+    return bl;
+  }
+
+  /** Let a batched and a byte by byte reuseBlocks() scan \a delta_r and check they find the same blocks. */
+  MediaBlockList checkBatchedReuse( const std::string & target_r, const std::string & delta_r, uint rsumseq_r, size_t blksize_r = blksize )
+  {
+    filesystem::TmpFile deltaFile;
+    {
+      std::ofstream out( deltaFile.path().c_str() );
+      out << delta_r;
+    }
+
+    MediaBlockList batched { makeBlockList( target_r, rsumseq_r, blksize_r ) };
+    MediaBlockList scalar  { makeBlockList( target_r, rsumseq_r, blksize_r ) };
+    scalar.setRsumBatching( false );
+    BOOST_CHECK( batched.rsumBatching() );
+
+    filesystem::TmpFile batchedOut;
+    filesystem::TmpFile scalarOut;
+    {
+      AutoFILE f( fopen( batchedOut.path().c_str(), "w" ) );
+      batched.reuseBlocks( f, deltaFile.path().asString() );
+    }
+    {
+      AutoFILE f( fopen( scalarOut.path().c_str(), "w" ) );
+      scalar.reuseBlocks( f, deltaFile.path().asString() );
+    }
+
+    // both ways must find the same blocks
+    BOOST_CHECK_EQUAL( batched.asString(), scalar.asString() );
+    BOOST_CHECK( readFile( batchedOut.path() ) == readFile( scalarOut.path() ) );
+    return batched;
+  }
+}
+
+BOOST_AUTO_TEST_CASE(reuse_blocks_batched)
+{
+  BOOST_TEST_MESSAGE( "rsum kernel: " << MediaBlockList::rsumKernelName() );
+
+  std::mt19937 gen( 42 );
+  const std::string target { randomData( gen, nblks * blksize ) };
+
+  // the delta file is shifted by an odd number of bytes and misses 2 blocks
+  std::string delta { randomData( gen, 301 ) + target };
+  delta.replace( 301 + 10 * blksize, 2 * blksize, randomData( gen, 2 * blksize ) );
+
+  for ( uint rsumseq : { 1U, 2U } )
+  {
+    BOOST_TEST_CONTEXT( "rsumseq " << rsumseq )
+    {
+      MediaBlockList batched { checkBatchedReuse( target, delta, rsumseq ) };
+      BOOST_CHECK_LT( batched.numBlocks(), nblks / 2 );
+      if ( rsumseq == 1 )
+      {
+        BOOST_REQUIRE_EQUAL( batched.numBlocks(), 2 );
+        BOOST_CHECK_EQUAL( batched.getBlock( 0 ).off, off_t( 10 * blksize ) );
+        BOOST_CHECK_EQUAL( batched.getBlock( 1 ).off, off_t( 11 * blksize ) );
+      }
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(reuse_blocks_batched_odd_sizes)
+{
+  std::mt19937 gen( 1234 );
+  // a block size which is not a power of 2 and a last block shorter than the vector width
+  for ( size_t bs : { size_t(1000), blksize } )
+  {
+    const std::string target { randomData( gen, nblks * bs + 5 ) };
+    std::string delta { target };
+    delta.replace( 10 * bs, bs, randomData( gen, bs ) );
+    const std::string shiftedDelta { randomData( gen, 13 ) + delta };
+
+    for ( uint rsumseq : { 1U, 2U } )
+    {
+      BOOST_TEST_CONTEXT( "blksize " << bs << " rsumseq " << rsumseq )
+      {
+        checkBatchedReuse( target, delta, rsumseq, bs );
+        MediaBlockList shifted { checkBatchedReuse( target, shiftedDelta, rsumseq, bs ) };
+        // the rsums of a block size which is not a power of 2 can not be rolled,
+        // so only the blocks following a match are found in the shifted file
+        if ( bs == blksize )
+          BOOST_CHECK_LT( shifted.numBlocks(), nblks / 2 );
+      }
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(rsum_kernels)
+{
+  const std::vector<std::string> kernels { MediaBlockList::rsumKernelNames() };
+  BOOST_REQUIRE( !kernels.empty() );
+  BOOST_CHECK_EQUAL( kernels.front(), MediaBlockList::rsumKernelName() );
+  BOOST_CHECK_EQUAL( kernels.back(), "scalar" );
+  for ( const auto & kernel : kernels )
+    BOOST_TEST_MESSAGE( "supported rsum kernel: " << kernel );
+
+  std::mt19937 gen( 815 );
+  const MediaBlockList bl;
+  // n covers tails shorter than the 8 ( sse2 ) and 16 ( avx2 ) windows rolled at once
+  for ( size_t bs : { 16, 1000, 1023, 1024, 4096 } )
+  {
+    for ( size_t n : { 1, 2, 7, 8, 9, 15, 16, 17, 23, 33, 256, 1001 } )
+    {
+      BOOST_TEST_CONTEXT( "blksize " << bs << " windows " << n )
+      {
+        const std::string data { randomData( gen, n - 1 + bs ) };
+        const auto d = reinterpret_cast<const unsigned char *>( data.data() );
+
+        const std::vector<unsigned int> scalar { MediaBlockList::rollRsums( "scalar", d, bs, n ) };
+        BOOST_REQUIRE_EQUAL( scalar.size(), n );
+        BOOST_CHECK( MediaBlockList::rollRsums( "nokernel", d, bs, n ).empty() );
+
+        // only the rsums of a power of 2 block size can be rolled
+        if ( ( bs & ( bs - 1 ) ) == 0 )
+        {
+          for ( size_t j = 0; j < n; ++j )
+            BOOST_REQUIRE_EQUAL( scalar[j], bl.updateRsum( 0, data.data() + j, bs ) );
+        }
+
+        for ( const auto & kernel : kernels )
+        {
+          BOOST_TEST_CONTEXT( "kernel " << kernel )
+          {
+            const std::vector<unsigned int> rsums { MediaBlockList::rollRsums( kernel, d, bs, n ) };
+            BOOST_CHECK( rsums == scalar );
+          }
+        }
+      }
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(reuse_blocks_threaded)
+{
+  std::mt19937 gen( 4711 );
+  const std::string target { randomData( gen, nblks * blksize ) };
+
+  // blocks at the same offset for the plain checksum check, shifted ones for the rsum search
+  std::string delta { target };
+  delta.replace( 20 * blksize, blksize, randomData( gen, blksize ) );
+  std::string shiftedDelta { randomData( gen, 77 ) + delta };
+
+  for ( uint rsumseq : { 0U, 1U, 2U } )
+  {
+    BOOST_TEST_CONTEXT( "rsumseq " << rsumseq )
+    {
+      filesystem::TmpFile deltaFile;
+      {
+        std::ofstream out( deltaFile.path().c_str() );
+        out << ( rsumseq ? shiftedDelta : delta );
+      }
+
+      MediaBlockList serial { makeBlockList( target, rsumseq ) };
+      serial.setReuseThreads( 1 );
+      filesystem::TmpFile serialOut;
+      {
+        AutoFILE f( fopen( serialOut.path().c_str(), "w" ) );
+        serial.reuseBlocks( f, deltaFile.path().asString() );
+      }
+      BOOST_CHECK_LT( serial.numBlocks(), nblks / 2 );
+
+      // the part boundaries must not lose or duplicate blocks
+      for ( unsigned threads : { 2U, 3U, 7U } )
+      {
+        MediaBlockList threaded { makeBlockList( target, rsumseq ) };
+        threaded.setReuseThreads( threads );
+        BOOST_CHECK_EQUAL( threaded.reuseThreads(), threads );
+        filesystem::TmpFile threadedOut;
+        {
+          AutoFILE f( fopen( threadedOut.path().c_str(), "w" ) );
+          threaded.reuseBlocks( f, deltaFile.path().asString() );
+        }
+        BOOST_CHECK_EQUAL( threaded.asString(), serial.asString() );
+        BOOST_CHECK( readFile( threadedOut.path() ) == readFile( serialOut.path() ) );
+      }
+    }
+  }
+}
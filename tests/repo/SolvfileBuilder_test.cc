@@ -0,0 +1,127 @@
+#include <iostream>
+#include <fstream>
+#include <map>
+#include <set>
+
+#include <boost/test/unit_test.hpp>
+
+#include <zypp/base/LogTools.h>
+#include <zypp/TmpPath.h>
+#include <zypp/PathInfo.h>
+#include <zypp/sat/Pool.h>
+#include <zypp/sat/LookupAttr.h>
+#include <zypp/repo/SolvfileBuilder.h>
+
+#include "TestSetup.h"
+
+using namespace zypp;
+using namespace zypp::repo;
+
+#define DATADIR (Pathname(TESTS_SRC_DIR) + "/repo")
+
+namespace
+{
+  using Content = std::map<std::string, std::multiset<std::string>>;
+
+  /** Per solvable: the dependencies, the main lookups and all attributes stored for it. */
+  Content content( const Repository & repo_r )
+  {
+    Content ret;
+    for ( const auto & solv : repo_r.solvables() )
+    {
+      std::string key { solv.asString() };
+      for ( unsigned i = 1; ret.count( key ); ++i )	// same NVRA twice
+        key = solv.asString() + " #" + str::numstring( i );
+      std::multiset<std::string> & attrs { ret[key] };
+
+      for ( Dep dep : { Dep::PROVIDES, Dep::PREREQUIRES, Dep::REQUIRES, Dep::CONFLICTS, Dep::OBSOLETES,
+                        Dep::RECOMMENDS, Dep::SUGGESTS, Dep::ENHANCES, Dep::SUPPLEMENTS } )
+      {
+        for ( const auto & cap : solv.dep( dep ) )
+          attrs.insert( dep.asString() + ": " + cap.asString() );
+      }
+
+      attrs.insert( "vendor: " + solv.vendor().asString() );
+      attrs.insert( str::Str() << "location: " << solv.lookupLocation() );
+      attrs.insert( str::Str() << "checksum: " << solv.lookupCheckSumAttribute( sat::SolvAttr::checksum ) );
+      attrs.insert( str::Str() << "downloadsize: " << solv.downloadSize().blocks( ByteCount::B ) );
+      attrs.insert( str::Str() << "installsize: " << solv.installSize().blocks( ByteCount::B ) );
+
+      // everything else, like file lists, summaries, descriptions, update references, ...
+      for ( auto it = sat::LookupAttr( sat::SolvAttr::allAttr, solv ).begin(); ! it.atEnd(); ++it )
+        attrs.insert( str::Str() << it.inSolvAttr() << " = " << it.asString() );
+    }
+    return ret;
+  }
+
+  /** The in-process solv file must provide the same solvables and attributes as the one built by repo2solv. */
+  void compareWithRepo2solv( const Pathname & repodir_r, const RepoType & type_r )
+  {
+    BOOST_REQUIRE( buildSolvfileSupported( type_r ) );
+
+    TestSetup test( Arch_x86_64 );
+    test.loadRepo( repodir_r, "repo2solv" );	// built via RepoManager/repo2solv
+    Repository ref { test.satpool().reposFind( "repo2solv" ) };
+    BOOST_REQUIRE( ref );
+
+    filesystem::TmpDir tmp;
+    buildSolvfile( type_r, repodir_r, tmp.path()/"solv" );
+    Repository repo { test.satpool().addRepoSolv( tmp.path()/"solv", "inprocess" ) };
+    BOOST_REQUIRE( repo );
+
+    BOOST_CHECK_EQUAL( repo.solvablesSize(), ref.solvablesSize() );
+    const Content have { content( repo ) };
+    const Content want { content( ref ) };
+    for ( const auto & [ solv, attrs ] : want )
+    {
+      BOOST_TEST_CONTEXT( solv )
+      {
+        const auto it { have.find( solv ) };
+        BOOST_REQUIRE( it != have.end() );
+        BOOST_CHECK_EQUAL_COLLECTIONS( it->second.begin(), it->second.end(), attrs.begin(), attrs.end() );
+      }
+    }
+    BOOST_CHECK_EQUAL( have.size(), want.size() );
+    BOOST_CHECK_EQUAL( repo.generatedTimestamp(), ref.generatedTimestamp() );
+    BOOST_CHECK_EQUAL( repo.suggestedExpirationTimestamp(), ref.suggestedExpirationTimestamp() );
+  }
+}
+
+BOOST_AUTO_TEST_CASE(unsupported)
+{
+  BOOST_CHECK( ! buildSolvfileSupported( RepoType::RPMPLAINDIR ) );
+  filesystem::TmpDir tmp;
+  BOOST_CHECK_THROW( buildSolvfile( RepoType::RPMPLAINDIR, DATADIR/"yum/data/extensions", tmp.path()/"solv" ), RepoException );
+  BOOST_CHECK_THROW( buildSolvfile( RepoType::RPMMD, tmp.path(), tmp.path()/"solv" ), RepoException );
+}
+
+BOOST_AUTO_TEST_CASE(rpmmd)
+{
+  compareWithRepo2solv( DATADIR/"yum/data/extensions", RepoType::RPMMD );
+}
+
+BOOST_AUTO_TEST_CASE(susetags)
+{
+  compareWithRepo2solv( DATADIR/"susetags/data/stable-x86-subset", RepoType::YAST2 );
+}
+
+BOOST_AUTO_TEST_CASE(zstd)
+{
+  // InputStream can't decode zstd, such metadata are left to repo2solv
+  filesystem::TmpDir tmp;
+
+  const Pathname descr { tmp.path()/"susetags/suse/setup/descr" };
+  filesystem::assert_dir( descr );
+  std::ofstream( (descr/"packages.zst").c_str() ) << "zstd";
+  BOOST_CHECK_THROW( buildSolvfile( RepoType::YAST2, tmp.path()/"susetags", tmp.path()/"solv" ), RepoException );
+
+  const Pathname repodata { tmp.path()/"rpmmd/repodata" };
+  filesystem::assert_dir( repodata );
+  std::ofstream( (repodata/"repomd.xml").c_str() )
+    << "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+    << "<repomd xmlns=\"http://linux.duke.edu/metadata/repo\">\n"
+    << "  <data type=\"primary\"><location href=\"repodata/primary.xml.zst\"/></data>\n"
+    << "</repomd>\n";
+  std::ofstream( (repodata/"primary.xml.zst").c_str() ) << "zstd";
+  BOOST_CHECK_THROW( buildSolvfile( RepoType::RPMMD, tmp.path()/"rpmmd", tmp.path()/"solv" ), RepoException );
+}
@@ -1,4 +1,31 @@
 #include "TestSetup.h"
+#include <fstream>
+#include <solv/pool.h>
+#include <zypp/sat/detail/PoolImpl.h>
+
+namespace
+{
+  /** The providers of all dependencies in the pool, as strings to be comparable across builds. */
+  std::map<std::string,std::multiset<std::string>> allProviders()
+  {
+    std::map<std::string,std::multiset<std::string>> ret;
+    for ( const sat::Solvable & solv : sat::Pool::instance().solvables() )
+    {
+      for ( Dep dep : { Dep::PROVIDES, Dep::REQUIRES, Dep::CONFLICTS, Dep::OBSOLETES, Dep::RECOMMENDS, Dep::SUPPLEMENTS } )
+      {
+        for ( const Capability & cap : solv.dep( dep ) )
+        {
+          if ( ret.count( cap.asString() ) )
+            continue;
+          std::multiset<std::string> & providers( ret[cap.asString()] );
+          for ( const sat::Solvable & provider : sat::WhatProvides( cap ) )
+            providers.insert( provider.asString() + "@" + provider.repository().alias() );
+        }
+      }
+    }
+    return ret;
+  }
+}
 
 BOOST_AUTO_TEST_CASE(WhatProvides)
 {
@@ -60,3 +87,89 @@ BOOST_AUTO_TEST_CASE(WhatProvides)
     BOOST_CHECK( a == q.begin() );
   }
 }
+
+BOOST_AUTO_TEST_CASE(WhatProvidesIncremental)
+{
+  TestSetup test( Arch_x86_64 );
+  sat::Pool satpool( test.satpool() );
+  test.loadRepo( TESTS_SRC_DIR"/data/openSUSE-11.1" );
+  satpool.prepare();
+  const sat::detail::PoolImpl & poolimpl { sat::detail::PoolMember::myPool() };
+  const unsigned builds = poolimpl.whatprovidesBuilds();
+  const unsigned updates = poolimpl.whatprovidesUpdates();
+
+  // the index is updated after repos were added...
+  satpool.reposInsert( "RepoHIGH" ).addTesttags( TESTS_SRC_DIR"/data/TCSelectable/RepoHIGH.repo" );
+  satpool.reposInsert( "RepoMID" ).addTesttags( TESTS_SRC_DIR"/data/TCSelectable/RepoMID.repo" );
+  const auto added { allProviders() };
+  BOOST_CHECK( ! added.empty() );
+  BOOST_CHECK_EQUAL( poolimpl.whatprovidesUpdates(), updates + 1 );
+  BOOST_CHECK_EQUAL( poolimpl.whatprovidesBuilds(), builds );
+  ::pool_freewhatprovides( satpool.get() );	// enforce a full build
+  BOOST_CHECK( added == allProviders() );
+  BOOST_CHECK_EQUAL( poolimpl.whatprovidesBuilds(), builds + 1 );
+
+  // ...or removed
+  satpool.reposErase( "RepoHIGH" );
+  const auto removed { allProviders() };
+  BOOST_CHECK_EQUAL( poolimpl.whatprovidesUpdates(), updates + 2 );
+  BOOST_CHECK_EQUAL( poolimpl.whatprovidesBuilds(), builds + 1 );
+  ::pool_freewhatprovides( satpool.get() );
+  BOOST_CHECK( removed == allProviders() );
+  BOOST_CHECK( removed != added );
+
+  // a changed architecture needs a full build
+  ZConfig::instance().setSystemArchitecture( Arch_i586 );
+  satpool.reposErase( "RepoMID" );
+  satpool.prepare();
+  BOOST_CHECK_EQUAL( poolimpl.whatprovidesUpdates(), updates + 2 );
+  BOOST_CHECK_EQUAL( poolimpl.whatprovidesBuilds(), builds + 3 );
+  ZConfig::instance().setSystemArchitecture( Arch_x86_64 );
+}
+
+BOOST_AUTO_TEST_CASE(WhatProvidesSnapshot)
+{
+  ZConfig::instance().repo_whatprovides_snapshot( true );
+  filesystem::TmpDir root;
+  const Pathname snapshot { RepoManagerOptions::makeTestSetup( root.path() ).repoSolvCachePath / ".whatprovides" };
+
+  std::map<std::string,std::multiset<std::string>> built;
+  {
+    TestSetup test( root.path(), Arch_x86_64 );
+    test.loadRepo( TESTS_SRC_DIR"/data/openSUSE-11.1" );
+    test.satpool().prepare();
+    built = allProviders();
+    BOOST_CHECK( ! built.empty() );
+  }
+  PathInfo saved( snapshot );
+  BOOST_REQUIRE( saved.isFile() );
+
+  // the same repos loaded again use the snapshot (it is not rewritten)...
+  {
+    TestSetup test( root.path(), Arch_x86_64 );
+    test.loadRepos();
+    test.satpool().prepare();
+    BOOST_CHECK( built == allProviders() );
+    BOOST_CHECK_EQUAL( PathInfo( snapshot ).ino(), saved.ino() );
+    // ...and it matches a full build
+    ZConfig::instance().repo_whatprovides_snapshot( false );
+    ::pool_freewhatprovides( test.satpool().get() );
+    BOOST_CHECK( built == allProviders() );
+  }
+
+  // a corrupt snapshot is not used but built anew
+  {
+    std::fstream str( snapshot.c_str(), std::ios::in | std::ios::out | std::ios::binary );
+    str.seekp( -int(sizeof(sat::detail::IdType)), std::ios::end );
+    const sat::detail::IdType bad { -1 };
+    str.write( reinterpret_cast<const char *>( &bad ), sizeof(bad) );
+  }
+  {
+    ZConfig::instance().repo_whatprovides_snapshot( true );
+    TestSetup test( root.path(), Arch_x86_64 );
+    test.loadRepos();
+    test.satpool().prepare();
+    BOOST_CHECK( built == allProviders() );
+    BOOST_CHECK( PathInfo( snapshot ).ino() != saved.ino() );
+  }
+}
@@ -0,0 +1,195 @@
+#include <boost/test/unit_test.hpp>
+
+#include <zypp/target/CommitPackageCache.h>
+#include <zypp/target/CommitPackageCacheImpl.h>
+#include <zypp/repo/RepoProvideFile.h>
+#include <zypp/Package.h>
+#include <zypp/PathInfo.h>
+
+#include "TestSetup.h"
+#include "TestTools.h"
+#include "WebServer.h"
+
+#define DATADIR (Pathname(TESTS_SRC_DIR) + "/zypp/data/CommitPackageCache")
+#define WEBDATADIR (Pathname(TESTS_SRC_DIR) + "/zypp/data/CommitPackagePrefetcher")
+
+using namespace zypp;
+using zypp::target::CommitPackageCache;
+using zypp::target::computeHeaps;
+
+using TestTools::ScopedMirrorStats;
+BOOST_GLOBAL_FIXTURE( ScopedMirrorStats );
+
+namespace
+{
+  using Heaps = std::vector<std::vector<std::string>>;
+
+  /** The package \a name_r, installed or available. */
+  PoolItem find( const std::string & name_r, bool installed_r = false )
+  {
+    for ( const PoolItem & pi : ResPool::instance().byName( name_r ) )
+    {
+      if ( pi.satSolvable().isSystem() == installed_r )
+        return pi;
+    }
+    BOOST_FAIL( "No package " + name_r );
+    return PoolItem();
+  }
+
+  /** The commit list \a items_r, setting each item to transact. */
+  std::vector<sat::Solvable> commitList( std::initializer_list<PoolItem> items_r )
+  {
+    std::vector<sat::Solvable> ret;
+    for ( const PoolItem & pi : items_r )
+    {
+      pi.status().setTransact( true, ResStatus::USER );
+      ret.push_back( pi.satSolvable() );
+    }
+    return ret;
+  }
+
+  /** The package names per heap. */
+  Heaps names( const std::vector<std::vector<PoolItem>> & heaps_r )
+  {
+    Heaps ret;
+    for ( const auto & heap : heaps_r )
+    {
+      ret.emplace_back();
+      for ( const PoolItem & pi : heap )
+        ret.back().push_back( pi.name() );
+    }
+    return ret;
+  }
+
+  std::string asString( const Heaps & heaps_r )
+  {
+    std::string ret;
+    for ( const auto & heap : heaps_r )
+      ret += "[" + str::join( heap, "," ) + "]";
+    return ret;
+  }
+}
+
+#define CHECK_HEAPS( COMMITLIST, SIZE, EXPECTED ) \
+  do { \
+    const Heaps got { names( computeHeaps( COMMITLIST, ByteCount( SIZE ) ) ) }; \
+    BOOST_CHECK_MESSAGE( got == Heaps EXPECTED, "got " << asString( got ) ); \
+  } while ( false )
+
+BOOST_AUTO_TEST_CASE(heaps_max_size_zero)
+{
+  TestSetup test( Arch_x86_64 );
+  test.loadRepo( DATADIR/"repo", "repo" );
+  test.satpool().prepare();
+
+  // each package alone, unless a requirement is provided by a later step (b requires c)
+  CHECK_HEAPS( commitList({ find("a"), find("b"), find("c"), find("e"), find("f") }), 0,
+               ({ {"a"}, {"b","c"}, {"e"}, {"f"} }) );
+  // c is installed before b needs it
+  CHECK_HEAPS( commitList({ find("c"), find("b"), find("e") }), 0,
+               ({ {"c"}, {"b"}, {"e"} }) );
+}
+
+BOOST_AUTO_TEST_CASE(heaps_oversized_package)
+{
+  TestSetup test( Arch_x86_64 );
+  test.loadRepo( DATADIR/"repo", "repo" );
+  test.satpool().prepare();
+
+  // d (5000) gets a heap of its own, a dependency lets a heap grow beyond the limit
+  CHECK_HEAPS( commitList({ find("a"), find("d"), find("e"), find("b"), find("c") }), 2500,
+               ({ {"a"}, {"d"}, {"e","b","c"} }) );
+  // all fit in one
+  CHECK_HEAPS( commitList({ find("a"), find("b"), find("c") }), 3000,
+               ({ {"a","b","c"} }) );
+}
+
+BOOST_AUTO_TEST_CASE(heaps_dependency_order)
+{
+  TestSetup test( Arch_x86_64 );
+  test.loadTargetRepo( DATADIR/"system" );
+  test.loadRepo( DATADIR/"repo", "repo" );
+  test.satpool().prepare();
+
+  // provided by nothing in the transaction (rpmlib)
+  CHECK_HEAPS( commitList({ find("f"), find("e") }), 0,
+               ({ {"f"}, {"e"} }) );
+  // provided by the still installed c
+  CHECK_HEAPS( commitList({ find("b"), find("c"), find("e") }), 0,
+               ({ {"b"}, {"c"}, {"e"} }) );
+
+  // the installed c is removed before b is installed: b waits for the new c
+  PoolItem sysc { find( "c", true ) };
+  CHECK_HEAPS( commitList({ sysc, find("b"), find("c"), find("e") }), 0,
+               ({ {"b","c"}, {"e"} }) );
+  // ...but not if it is removed after b
+  CHECK_HEAPS( commitList({ find("b"), sysc, find("c"), find("e") }), 0,
+               ({ {"b"}, {"c"}, {"e"} }) );
+}
+
+BOOST_AUTO_TEST_CASE(download_in_heaps)
+{
+  TestSetup test( Arch_x86_64 );
+  WebServer web( WEBDATADIR.c_str(), 10001 );
+  BOOST_REQUIRE( web.start() );
+  for ( const std::string & alias : { "repo1", "repo2" } )
+  {
+    test.loadRepo( WEBDATADIR / alias, alias );
+    Repository repo { test.satpool().reposFind( alias ) };
+    RepoInfo info { repo.info() };
+    Url url { web.url() };
+    url.setPathName( "/" + alias );
+    info.setBaseUrl( url );
+    info.setPackagesPath( test.root() / "packages" / alias );
+    repo.setInfo( info );
+  }
+
+  std::vector<sat::Solvable> list;
+  for ( const PoolItem & pi : test.pool() )
+  {
+    if ( ! pi.isKind<Package>() )
+      continue;
+    pi.status().setTransact( true, ResStatus::USER );
+    list.push_back( pi.satSolvable() );
+  }
+  BOOST_REQUIRE_EQUAL( list.size(), 8 );
+
+  auto stagedFile = []( const PoolItem & pi_r ) {
+    const RepoInfo & info { pi_r->repoInfo() };
+    return repo::RepoMediaAccess::stagingPath( info ) / info.path() / pi_r->asKind<Package>()->location().filename();
+  };
+
+  // The packages are 7KiB each, so 2 of them make a heap.
+  const ByteCount maxHeapSize { 32000 };
+  const std::vector<std::vector<PoolItem>> heaps { computeHeaps( list, ByteCount( maxHeapSize / 2 ) ) };
+  BOOST_REQUIRE_EQUAL( heaps.size(), 4 );
+
+  unsigned missed = 0;
+  CommitPackageCache cache( [&]( const PoolItem & pi_r, bool ) {
+    const Pathname file { stagedFile( pi_r ) };
+    if ( ! PathInfo( file ).isFile() )
+      ++missed;
+    return ManagedFile( file );
+  });
+  cache.setCommitList( list );
+  cache.downloadInHeaps( maxHeapSize );
+
+  // only the 1st heap is downloaded in advance, the 2nd one in the background
+  for ( const PoolItem & pi : heaps[0] )
+    BOOST_CHECK( PathInfo( stagedFile( pi ) ).isFile() );
+  for ( unsigned i = 2; i < heaps.size(); ++i )
+    for ( const PoolItem & pi : heaps[i] )
+      BOOST_CHECK( ! PathInfo( stagedFile( pi ) ).isExist() );
+
+  for ( unsigned i = 0; i < heaps.size(); ++i )
+  {
+    for ( const PoolItem & pi : heaps[i] )
+      cache.get( pi );
+
+    if ( i > 0 )	// the previous heap is done
+      for ( const PoolItem & pi : heaps[i-1] )
+        BOOST_CHECK( ! PathInfo( stagedFile( pi ) ).isExist() );
+  }
+  // each package was staged when it was asked for
+  BOOST_CHECK_EQUAL( missed, 0 );
+}
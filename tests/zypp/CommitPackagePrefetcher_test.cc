@@ -0,0 +1,197 @@
+#include <boost/test/unit_test.hpp>
+
+#include <zypp/target/CommitPackagePrefetcher.h>
+#include <zypp/repo/RepoProvideFile.h>
+#include <zypp/Package.h>
+#include <zypp/PathInfo.h>
+
+#include "TestSetup.h"
+#include "TestTools.h"
+#include "WebServer.h"
+
+#define DATADIR (Pathname(TESTS_SRC_DIR) + "/zypp/data/CommitPackagePrefetcher")
+
+using namespace zypp;
+using zypp::target::CommitPackagePrefetcher;
+
+using TestTools::ScopedMirrorStats;
+BOOST_GLOBAL_FIXTURE( ScopedMirrorStats );
+
+namespace
+{
+  /** The rpm-md repos below \ref DATADIR loaded from disk, but pretending to be served by \a web_r. */
+  void loadWebRepos( TestSetup & test_r, const WebServer & web_r )
+  {
+    for ( const std::string & alias : { "repo1", "repo2" } )
+    {
+      test_r.loadRepo( DATADIR / alias, alias );
+      Repository repo { test_r.satpool().reposFind( alias ) };
+      BOOST_REQUIRE( repo );
+
+      RepoInfo info { repo.info() };
+      Url url { web_r.url() };
+      url.setPathName( "/" + alias );
+      info.setBaseUrl( url );
+      info.setPackagesPath( test_r.root() / "packages" / alias );
+      repo.setInfo( info );
+    }
+  }
+
+  /** Queue all packages in the pool. */
+  unsigned addAll( CommitPackagePrefetcher & prefetcher_r )
+  {
+    unsigned ret = 0;
+    for ( const PoolItem & pi : ResPool::instance() )
+    {
+      if ( prefetcher_r.add( pi ) )
+        ++ret;
+    }
+    return ret;
+  }
+}
+
+BOOST_AUTO_TEST_CASE(delta_cost_model)
+{
+  CommitPackagePrefetcher::DeltaCostModel model;
+  model._downloadRate = 1000;	// 1000 bytes/s
+  model._applyRate    = 10000;	// 10000 bytes/s
+  model._maxApply     = 1;
+
+  // full: 10s; delta: 1s + 1s
+  BOOST_CHECK( model.preferDelta( 10000, 1000 ) );
+  // full: 10s; delta: 9.5s + 1s
+  BOOST_CHECK( ! model.preferDelta( 10000, 9500 ) );
+  // equal cost keeps the full package
+  BOOST_CHECK( ! model.preferDelta( 10000, 9000 ) );
+
+  // a queue of pending applydeltarpm makes the delta lose...
+  model._pendingApply = 80000;	// 8s to wait
+  BOOST_CHECK( ! model.preferDelta( 10000, 1000 ) );
+  // ...unless more of them may run at once
+  model._maxApply = 4;
+  BOOST_CHECK( model.preferDelta( 10000, 1000 ) );
+}
+
+BOOST_AUTO_TEST_CASE(delta_cost_model_slow_network)
+{
+  CommitPackagePrefetcher::DeltaCostModel model;
+  model._downloadRate = 100;
+  model._applyRate    = 1000000;
+  // On a slow line nearly any smaller delta wins...
+  BOOST_CHECK( model.preferDelta( 10000, 9000 ) );
+  // ...but never one that is not smaller.
+  BOOST_CHECK( ! model.preferDelta( 10000, 10000 ) );
+  BOOST_CHECK( ! model.preferDelta( 10000, 20000 ) );
+}
+
+BOOST_AUTO_TEST_CASE(prefetch_limits)
+{
+  TestSetup test( Arch_x86_64 );
+  WebServer web( DATADIR.c_str(), 10001 );
+  BOOST_REQUIRE( web.start() );
+  loadWebRepos( test, web );
+
+  {
+    CommitPackagePrefetcher prefetcher( 3, 2 );
+    BOOST_REQUIRE_EQUAL( addAll( prefetcher ), 8 );
+    BOOST_CHECK_EQUAL( prefetcher.run(), 8 );
+    BOOST_CHECK_EQUAL( prefetcher.peakParallel(), 3 );
+    BOOST_CHECK_EQUAL( prefetcher.peakPerRepo(), 2 );
+  }
+  {
+    CommitPackagePrefetcher prefetcher( 8, 1 );
+    BOOST_REQUIRE_EQUAL( addAll( prefetcher ), 8 );
+    BOOST_CHECK_EQUAL( prefetcher.run(), 8 );
+    BOOST_CHECK_EQUAL( prefetcher.peakParallel(), 2 );	// one per repo
+    BOOST_CHECK_EQUAL( prefetcher.peakPerRepo(), 1 );
+  }
+  {
+    CommitPackagePrefetcher prefetcher( 8, 3 );
+    BOOST_REQUIRE_EQUAL( addAll( prefetcher ), 8 );
+    BOOST_CHECK_EQUAL( prefetcher.run(), 8 );
+    BOOST_CHECK_EQUAL( prefetcher.peakParallel(), 6 );
+    BOOST_CHECK_EQUAL( prefetcher.peakPerRepo(), 3 );
+    // nothing left to do
+    BOOST_CHECK_EQUAL( prefetcher.run(), 0 );
+  }
+}
+
+BOOST_AUTO_TEST_CASE(prefetch_staging)
+{
+  TestSetup test( Arch_x86_64 );
+  WebServer web( DATADIR.c_str(), 10001 );
+  BOOST_REQUIRE( web.start() );
+  loadWebRepos( test, web );
+
+  std::vector<Package::constPtr> pkgs;
+  for ( const PoolItem & pi : test.pool() )
+  {
+    if ( pi.isKind<Package>() )
+      pkgs.push_back( pi->asKind<Package>() );
+  }
+  BOOST_REQUIRE_EQUAL( pkgs.size(), 8 );
+
+  std::vector<Pathname> staged;
+  {
+    CommitPackagePrefetcher prefetcher( 4, 2 );
+    BOOST_REQUIRE_EQUAL( addAll( prefetcher ), 8 );
+    BOOST_CHECK( prefetcher.add( PoolItem( pkgs.front()->satSolvable() ) ) );	// queued already
+    BOOST_CHECK_EQUAL( prefetcher.size(), 8 );
+    BOOST_CHECK_EQUAL( prefetcher.run(), 8 );
+
+    // staged below the repos packagesPath, matching the checksum
+    for ( const Package::constPtr & pkg : pkgs )
+    {
+      const RepoInfo & info { pkg->repoInfo() };
+      const Pathname file { repo::RepoMediaAccess::stagingPath( info ) / info.path() / pkg->location().filename() };
+      BOOST_REQUIRE_MESSAGE( PathInfo( file ).isFile(), file );
+      BOOST_CHECK( filesystem::is_checksum( file, pkg->location().checksum() ) );
+      staged.push_back( file );
+    }
+    BOOST_CHECK_EQUAL( prefetcher.stagedFilesToCheck().size(), 0 );	// no pkgGpgCheck for these repos
+
+    // Found in the staging area by checksum, the server is not asked again.
+    web.stop();
+    repo::RepoMediaAccess access;
+    for ( const Package::constPtr & pkg : pkgs )
+    {
+      ManagedFile file { access.provideFile( pkg->repoInfo(), pkg->location() ) };
+      BOOST_CHECK( PathInfo( file ).isFile() );
+      BOOST_CHECK( filesystem::is_checksum( file, pkg->location().checksum() ) );
+    }
+  }
+
+  // removed with the prefetcher
+  for ( const Pathname & file : staged )
+    BOOST_CHECK_MESSAGE( ! PathInfo( file ).isExist(), file );
+  for ( const Package::constPtr & pkg : pkgs )
+    BOOST_CHECK( ! PathInfo( repo::RepoMediaAccess::stagingPath( pkg->repoInfo() ) ).isExist() );
+}
+
+BOOST_AUTO_TEST_CASE(prefetch_failed_download)
+{
+  TestSetup test( Arch_x86_64 );
+  WebServer web( DATADIR.c_str(), 10001 );
+  BOOST_REQUIRE( web.start() );
+  loadWebRepos( test, web );
+
+  // failed downloads are not staged
+  Repository repo { test.satpool().reposFind( "repo1" ) };
+  RepoInfo info { repo.info() };
+  Url url { web.url() };
+  url.setPathName( "/repo2" );	// none of repo1's files is there
+  info.setBaseUrl( url );
+  repo.setInfo( info );
+
+  CommitPackagePrefetcher prefetcher( 4, 4 );
+  BOOST_REQUIRE_EQUAL( addAll( prefetcher ), 8 );
+  BOOST_CHECK_EQUAL( prefetcher.run(), 4 );
+  for ( const PoolItem & pi : test.pool() )
+  {
+    Package::constPtr pkg { pi->asKind<Package>() };
+    if ( ! pkg )
+      continue;
+    const Pathname file { repo::RepoMediaAccess::stagingPath( pkg->repoInfo() ) / pkg->location().filename() };
+    BOOST_CHECK_EQUAL( PathInfo( file ).isFile(), pkg->repoInfo().alias() == "repo2" );
+  }
+}
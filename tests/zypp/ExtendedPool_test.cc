@@ -99,3 +99,73 @@ BOOST_AUTO_TEST_CASE(t_1) {
     repocheck();
   }
 }
+
+///////////////////////////////////////////////////////////////////
+// PoolItems are created in chunks and their ResObjects on demand.
+// Lookup, compare and status must behave as if each PoolItem was
+// created individually.
+///////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_CASE(t_2) {
+  sat::Pool::instance().reposEraseAll();
+  testcase_init();
+
+  std::vector<PoolItem> items( ResPool::instance().begin(), ResPool::instance().end() );
+  BOOST_REQUIRE( ! items.empty() );
+
+  for ( const PoolItem & pi : items )
+  {
+    BOOST_CHECK( pi );
+    BOOST_CHECK_EQUAL( PoolItem( pi.satSolvable() ), pi );	// lookup by Solvable
+    BOOST_CHECK_EQUAL( pi.satSolvable(), pi.resolvable()->satSolvable() );
+    BOOST_CHECK_EQUAL( PoolItem( pi.resolvable() ), pi );	// lookup by ResObject
+    BOOST_CHECK_EQUAL( PoolItem( pi.satSolvable() ).resolvable(), pi.resolvable() ); // created just once
+  }
+
+  // status is shared among all copies
+  PoolItem pi( items.front() );
+  pi.status().setLock( true, ResStatus::USER );
+  BOOST_CHECK( PoolItem( pi.satSolvable() ).status().isLocked() );
+  pi.statusReset();
+  BOOST_CHECK( ! PoolItem( pi.satSolvable() ).status().isLocked() );
+
+  // After reusing the IDs old PoolItems must not compare equal to the new ones.
+  testcase_init2();
+  BOOST_CHECK( PoolItem( pi.satSolvable() ) != pi );
+  repocheck();
+}
+
+///////////////////////////////////////////////////////////////////
+// Adding or removing a repo patches the PoolItem store: the PoolItems
+// (and their status) of the remaining repos are kept and the ident
+// index is updated accordingly.
+///////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_CASE(t_3) {
+  sat::Pool::instance().reposEraseAll();
+  testcase_init();
+  ResPool pool( ResPool::instance() );
+
+  PoolItem pi( *pool.byIdentBegin( ResKind::package, "package" ) );
+  BOOST_REQUIRE( pi );
+  BOOST_CHECK_EQUAL( std::distance( pool.byIdentBegin( ResKind::package, "package" ), pool.byIdentEnd( ResKind::package, "package" ) ), 1 );
+  pi.status().setLock( true, ResStatus::USER );
+  unsigned size = pool.size();
+
+  Repository repo( sat::Pool::instance().reposInsert( "SEQB" ) );
+  repo.addTesttags( TESTS_SRC_DIR"/data/PoolReuseIds/SeqB/SeqB.repo" );
+  BOOST_CHECK_EQUAL( pool.size(), size + repo.solvablesSize() );
+  BOOST_CHECK_EQUAL( PoolItem( pi.satSolvable() ), pi );
+  BOOST_CHECK( pi.status().isLocked() );
+  BOOST_CHECK_EQUAL( std::distance( pool.byIdentBegin( ResKind::package, "package" ), pool.byIdentEnd( ResKind::package, "package" ) ), 2 );
+  repocheck();
+
+  repo.eraseFromPool();
+  BOOST_CHECK_EQUAL( pool.size(), size );
+  BOOST_CHECK_EQUAL( PoolItem( pi.satSolvable() ), pi );
+  BOOST_CHECK( pi.status().isLocked() );
+  BOOST_CHECK_EQUAL( std::distance( pool.byIdentBegin( ResKind::package, "package" ), pool.byIdentEnd( ResKind::package, "package" ) ), 1 );
+  BOOST_CHECK_EQUAL( std::distance( pool.begin(), pool.end() ), size );
+  repocheck();
+  pi.statusReset();
+}
@@ -116,3 +116,64 @@ BOOST_AUTO_TEST_CASE( locks_empty )
   locks.removeEmpty();
   BOOST_CHECK( locks.size() == 0 );
 }
+
+BOOST_AUTO_TEST_CASE( locks_apply_combined )
+{
+  cout << "****apply combined****"  << endl;
+  std::list<PoolQuery> queries;
+  for ( const char * name : { "zypper", "libzypp" } )
+  {
+    PoolQuery q;	// by ident
+    q.addAttribute( sat::SolvAttr::name, name );
+    q.addKind( ResKind::package );
+    q.setMatchGlob();
+    q.setCaseSensitive( true );
+    queries.push_back( q );
+  }
+  for ( const char * name : { "kde*", "yast2-*", "*-devel" } )
+  {
+    PoolQuery q;	// joined into one query
+    q.addAttribute( sat::SolvAttr::name, name );
+    q.addKind( ResKind::package );
+    q.setMatchGlob();
+    queries.push_back( q );
+  }
+  {
+    PoolQuery q;
+    q.addAttribute( sat::SolvAttr::summary, "library" );
+    queries.push_back( q );
+  }
+  {
+    PoolQuery q;
+    q.addAttribute( sat::SolvAttr::name, "^lib.*[0-9]$" );
+    q.setMatchRegex();
+    queries.push_back( q );
+  }
+  {
+    PoolQuery q;
+    q.addDependency( sat::SolvAttr::name, "zypper", Rel::GE, Edition("0.12") );
+    queries.push_back( q );
+  }
+
+  filesystem::TmpFile file;
+  writePoolQueriesToFile( file, queries.begin(), queries.end() );
+  queries.clear();
+  readPoolQueriesFromFile( file, std::back_inserter( queries ) );
+
+  sat::SolvableSet expected;
+  for ( const PoolQuery & q : queries )
+    expected.insert( q.begin(), q.end() );
+  BOOST_CHECK( ! expected.empty() );
+
+  for ( const PoolItem & pi : test.pool() )
+    pi.status().setLock( false, ResStatus::USER );
+  Locks & locks = Locks::instance();
+  locks.readAndApply( file );
+  for ( const PoolItem & pi : test.pool() )
+    BOOST_CHECK_MESSAGE( pi.status().isLocked() == expected.contains( pi ), pi );
+
+  for ( const PoolQuery & q : queries )
+    locks.removeLock( q );
+  locks.merge();
+  BOOST_CHECK( locks.size() == 0 );
+}
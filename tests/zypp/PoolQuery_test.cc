@@ -1,6 +1,7 @@
 #include "TestSetup.h"
 #include <zypp/PoolQuery.h>
 #include <zypp/PoolQueryUtil.tcc>
+#include <thread>
 
 #define BOOST_TEST_MODULE PoolQuery
 
@@ -987,3 +988,173 @@ BOOST_AUTO_TEST_CASE(zypperLocksSerialize)
     }
   }
 }
+
+/** The matches of \a q_r (with details), to compare serial and parallel queries. */
+std::vector<std::string> queryResult( const PoolQuery & q_r )
+{
+  std::vector<std::string> ret;
+  for_( it, q_r.begin(), q_r.end() )
+  {
+    ret.push_back( it->asString() + "@" + it->repository().alias() );
+    for_( mit, it.matchesBegin(), it.matchesEnd() )
+      ret.push_back( "  " + mit->inSolvAttr().asString() + " " + mit->asString() );
+  }
+  return ret;
+}
+
+BOOST_AUTO_TEST_CASE(pool_query_parallel)
+{
+  cout << "****parallel****"  << endl;
+  std::vector<PoolQuery> queries;
+  {
+    PoolQuery q;
+    q.addString( "zypp" );	// all attributes
+    queries.push_back( q );
+  }
+  {
+    PoolQuery q;
+    q.addString( "library" );
+    q.addAttribute( sat::SolvAttr::summary );
+    q.addAttribute( sat::SolvAttr::description );
+    queries.push_back( q );
+  }
+  {
+    PoolQuery q;
+    q.addAttribute( sat::SolvAttr::description, "^[A-Z].*(tool|utility)" );
+    q.setMatchRegex();
+    q.setCaseSensitive();
+    queries.push_back( q );
+  }
+  {
+    PoolQuery q;
+    q.addAttribute( sat::SolvAttr::filelist, "/usr/bin/" );
+    q.setFilesMatchFullPath();
+    queries.push_back( q );
+  }
+  {
+    PoolQuery q;
+    q.addDependency( sat::SolvAttr::provides, "zypper", Rel::GE, Edition("0.12") );
+    q.addKind( ResKind::package );
+    queries.push_back( q );
+  }
+  {
+    PoolQuery q;
+    q.addString( "lib*" );
+    q.addAttribute( sat::SolvAttr::name );
+    q.setMatchGlob();
+    q.setUninstalledOnly();
+    queries.push_back( q );
+  }
+
+  for ( PoolQuery & q : queries )
+  {
+    const std::vector<std::string> serial { queryResult( q ) };
+    BOOST_CHECK( ! serial.empty() );
+    BOOST_CHECK_EQUAL( q.usedParallelJobs(), 0 );
+    BOOST_REQUIRE_GE( test.satpool().reposSize(), 2 );
+    for ( unsigned jobs : { 0U, 2U, 8U } )
+    {
+      q.setParallelJobs( jobs );
+      BOOST_CHECK_MESSAGE( queryResult( q ) == serial, q );
+      // one thread per repo at most
+      const unsigned expected { std::min<unsigned>( jobs ? jobs : std::max( std::thread::hardware_concurrency(), 1U ), test.satpool().reposSize() ) };
+      BOOST_CHECK_EQUAL( q.usedParallelJobs(), expected );
+    }
+    q.setParallelJobs( 1 );
+    queryResult( q );
+    BOOST_CHECK_EQUAL( q.usedParallelJobs(), 0 );
+  }
+}
+
+BOOST_AUTO_TEST_CASE(pool_query_trigram_index)
+{
+  cout << "****trigram_index****"  << endl;
+  std::vector<PoolQuery> queries;
+  {
+    PoolQuery q;
+    q.addAttribute( sat::SolvAttr::name, "zyp" );
+    queries.push_back( q );
+  }
+  {
+    PoolQuery q;
+    q.addString( "LibZypp" );
+    q.addAttribute( sat::SolvAttr::name );
+    q.addAttribute( sat::SolvAttr::summary );
+    queries.push_back( q );
+  }
+  {
+    PoolQuery q;
+    q.addAttribute( sat::SolvAttr::summary, "Library" );
+    q.setCaseSensitive();
+    queries.push_back( q );
+  }
+  {
+    PoolQuery q;
+    q.addAttribute( sat::SolvAttr::name, "kde*-zh*" );
+    q.setMatchGlob();
+    queries.push_back( q );
+  }
+  {
+    PoolQuery q;
+    q.addDependency( sat::SolvAttr::name, "zypper", Rel::GE, Edition("0.12") );
+    queries.push_back( q );
+  }
+  {
+    PoolQuery q;	// not served by the index
+    q.addAttribute( sat::SolvAttr::name, "^zy" );
+    q.setMatchRegex();
+    queries.push_back( q );
+  }
+
+  for ( const PoolQuery & q : queries )
+  {
+    const std::vector<std::string> serial { queryResult( q ) };
+    BOOST_CHECK( ! serial.empty() );
+    ZConfig::instance().repo_search_index( true );
+    BOOST_CHECK_MESSAGE( queryResult( q ) == serial, q );
+    ZConfig::instance().repo_search_index( false );
+  }
+
+  // the index is saved next to the solv file
+  const Pathname solvCachePath { RepoManagerOptions::makeTestSetup( test.root() ).repoSolvCachePath };
+  BOOST_CHECK( PathInfo( solvCachePath/"opensuse"/"solv.name.trigrams" ).isFile() );
+  BOOST_CHECK( PathInfo( solvCachePath/"opensuse"/"solv.summary.trigrams" ).isFile() );
+}
+
+BOOST_AUTO_TEST_CASE(pool_query_compiled)
+{
+  cout << "****compiled****"  << endl;
+  PoolQuery q;
+  q.addAttribute( sat::SolvAttr::name, "zypp" );
+  q.setUninstalledOnly();
+
+  CompiledPoolQuery cq( q );
+  BOOST_CHECK_EQUAL( cq.size(), q.size() );
+  for ( const sat::Solvable & solv : q )
+    BOOST_CHECK( cq.contains( solv ) );
+
+  // a snapshot of the query
+  q.setMatchExact();
+  BOOST_CHECK( cq.size() != q.size() );
+
+  // remembered while the pool is unchanged
+  const sat::SolvableSet::Container * remembered { &cq.result().get() };
+  BOOST_CHECK_EQUAL( &cq.result().get(), remembered );
+
+  // searched again after the pool changed
+  const sat::SolvableSet::size_type size { cq.size() };
+  test.loadRepo( TESTS_SRC_DIR "/data/OBS_zypp_svn-11.1", "zyppsvn-copy" );
+  Repository copy { test.satpool().reposFind( "zyppsvn-copy" ) };
+  BOOST_REQUIRE( copy );
+  BOOST_CHECK_GT( cq.size(), size );
+  unsigned inCopy = 0;
+  for ( const sat::Solvable & solv : cq.result() )
+  {
+    if ( solv.repository() == copy )
+      ++inCopy;
+  }
+  BOOST_CHECK_EQUAL( size + inCopy, cq.size() );
+
+  copy.eraseFromPool();
+  BOOST_CHECK_EQUAL( cq.size(), size );
+}
@@ -13,8 +13,15 @@
 #include <zypp/ServiceInfo.h>
 
 #include <zypp/RepoManager.h>
+#include <zypp/ng/repomanager.h>
+#include <zypp/ng/reporthelper.h>
+#include <zypp/ng/context.h>
+#include <zypp/ng/workflows/contextfacade.h>
+#include <zypp/ng/repo/workflows/repomanagerwf.h>
+#include <zypp-media/ng/Provide>
 
 #include "TestSetup.h"
+#include "WebServer.h"
 
 #include <boost/test/unit_test.hpp>
 
@@ -32,6 +39,33 @@ using namespace zypp::repo;
 
 #define REPODATADIR (Pathname(TESTS_SRC_DIR) + "/repo/susetags/data/addon_in_subdir")
 
+#define WEBREPODATADIR (Pathname(TESTS_SRC_DIR) + "/zypp/data/CommitPackagePrefetcher")
+
+namespace
+{
+  /** The rpm-md repo below \a path_r on \a web_r. */
+  RepoInfo webRepo( const WebServer & web_r, const std::string & alias_r, const std::string & path_r )
+  {
+    Url url { web_r.url() };
+    url.setPathName( path_r );
+    RepoInfo info;
+    info.setAlias( alias_r );
+    info.setType( RepoType::RPMMD );
+    info.setBaseUrl( url );
+    return info;
+  }
+
+  /** A sync RepoManager refreshing downloading repos concurrently. */
+  zyppng::SyncRepoManagerRef concurrentRepoManager( const Pathname & root_r )
+  {
+    auto mgr = zyppng::SyncRepoManager::create( zyppng::SyncContext::defaultContext(), RepoManagerOptions::makeTestSetup( root_r ) ).unwrap();
+    auto ctx = zyppng::Context::create();
+    ctx->provider()->setWorkerPath( Pathname( TESTS_BUILD_DIR ).dirname() / "tools" / "workers" );
+    mgr->setConcurrentRefreshContext( ctx ).unwrap();
+    return mgr;
+  }
+}
+
 BOOST_AUTO_TEST_CASE(refresh_addon_in_subdir)
 {
     KeyRingTestReceiver keyring_callbacks;
@@ -274,6 +308,176 @@ BOOST_AUTO_TEST_CASE(repomanager_test)
 
 }
 
+BOOST_AUTO_TEST_CASE(refresh_concurrently_result_order)
+{
+  KeyRingTestReceiver keyring_callbacks;
+  keyring_callbacks.answerAcceptUnsignedFile( true );
+
+  TmpDir tmpCachePath;
+  WebServer web( WEBREPODATADIR.c_str(), 10001 );
+  BOOST_REQUIRE( web.start() );
+
+  RepoInfo local;
+  local.setAlias( "local" );
+  local.setType( RepoType::RPMMD );
+  local.setBaseUrl( (WEBREPODATADIR/"repo1").asDirUrl() );
+
+  const std::vector<RepoInfo> infos {
+    webRepo( web, "repo2", "/repo2" ),
+    webRepo( web, "missing", "/missing" ),
+    local,
+    webRepo( web, "repo1", "/repo1" ),
+  };
+  auto mgr = concurrentRepoManager( tmpCachePath );
+  const auto res = mgr->refreshMetadata( infos, RepoManagerFlags::RefreshForced );
+
+  // one result per repo, in the order they were passed
+  BOOST_REQUIRE_EQUAL( res.size(), infos.size() );
+  for ( unsigned i = 0; i < infos.size(); ++i )
+    BOOST_CHECK_EQUAL( res[i].first.alias(), infos[i].alias() );
+
+  // the failing repo does not affect the others
+  BOOST_CHECK( res[0].second );
+  BOOST_CHECK( ! res[1].second );
+  BOOST_CHECK( res[2].second );
+  BOOST_CHECK( res[3].second );
+  for ( const char * alias : { "repo2", "local", "repo1" } )
+    BOOST_CHECK_MESSAGE( PathInfo( tmpCachePath/"solv"/alias/"solv" ).isFile(), alias );
+  BOOST_CHECK( ! PathInfo( tmpCachePath/"solv"/"missing" ).isExist() );
+}
+
+BOOST_AUTO_TEST_CASE(refresh_concurrently_legacy_reports)
+{
+  KeyRingTestReceiver keyring_callbacks;
+
+  TmpDir tmpCachePath;
+  WebServer web( WEBREPODATADIR.c_str(), 10001 );
+  BOOST_REQUIRE( web.start() );
+
+  const std::vector<RepoInfo> infos { webRepo( web, "repo1", "/repo1" ), webRepo( web, "repo2", "/repo2" ) };
+  auto mgr = concurrentRepoManager( tmpCachePath );
+
+  // the unsigned repos are asked about via the legacy report, and its answer counts
+  keyring_callbacks.answerAcceptUnsignedFile( false );
+  for ( const auto & res : mgr->refreshMetadata( infos, RepoManagerFlags::RefreshForced ) )
+    BOOST_CHECK_MESSAGE( ! res.second, res.first.alias() );
+  BOOST_CHECK( keyring_callbacks.askedAcceptUnsignedFile() );
+
+  keyring_callbacks.reset();
+  keyring_callbacks.answerAcceptUnsignedFile( true );
+  for ( const auto & res : mgr->refreshMetadata( infos, RepoManagerFlags::RefreshForced ) )
+    BOOST_CHECK_MESSAGE( res.second, res.first.alias() );
+  BOOST_CHECK( keyring_callbacks.askedAcceptUnsignedFile() );
+}
+
+BOOST_AUTO_TEST_CASE(buildcache_batch)
+{
+  TmpDir tmpCachePath;
+  RepoManagerOptions opts { RepoManagerOptions::makeTestSetup( tmpCachePath ) };
+  opts.buildCacheInProcess = false;	// repo2solv jobs
+
+  // the raw metadata of repo1 and repo2, and a broken one in between
+  const std::vector<std::pair<std::string,std::string>> repos { { "a", "repo1" }, { "b", "repo2" }, { "broken", "repo1" }, { "c", "repo2" } };
+  std::vector<RepoInfo> infos;
+  for ( const auto & [alias, dir] : repos )
+  {
+    RepoInfo info;
+    info.setAlias( alias );
+    info.setType( RepoType::RPMMD );
+    info.setBaseUrl( (WEBREPODATADIR/dir).asDirUrl() );
+    infos.push_back( info );
+
+    const Pathname raw { opts.repoRawCachePath/alias };
+    BOOST_REQUIRE_EQUAL( assert_dir( raw ), 0 );
+    BOOST_REQUIRE_EQUAL( copy_dir( WEBREPODATADIR/dir/"repodata", raw ), 0 );
+  }
+  {
+    const Pathname primary { opts.repoRawCachePath/"broken"/"repodata"/"primary.xml.gz" };
+    BOOST_REQUIRE_EQUAL( unlink( primary ), 0 );
+    std::ofstream( primary.c_str() ) << "<metadata><package";
+  }
+
+  // the first package of the solv file built for alias_r
+  auto firstPackage = [&]( const std::string & alias_r ) {
+    sat::Pool satpool { sat::Pool::instance() };
+    Repository repo { satpool.addRepoSolv( opts.repoSolvCachePath/alias_r/"solv", alias_r ) };
+    std::string ret { repo.solvablesEmpty() ? "" : repo.solvablesBegin()->name() };
+    satpool.reposErase( alias_r );
+    return ret;
+  };
+
+  for ( unsigned maxJobs : { 1U, 2U } )
+  {
+    BOOST_TEST_CONTEXT( "maxJobs " << maxJobs )
+    {
+      RepoManagerOptions jobOpts { opts };
+      jobOpts.buildCacheMaxConcurrentJobs = maxJobs;
+      auto mgr = zyppng::SyncRepoManager::create( zyppng::SyncContext::defaultContext(), jobOpts ).unwrap();
+
+      const auto res = mgr->buildCache( infos, RepoManagerFlags::BuildForced );
+      BOOST_CHECK_EQUAL( zyppng::RepoManagerWorkflow::buildCacheJobsPeak(), maxJobs );
+
+      // one result per repo, in the order they were passed
+      BOOST_REQUIRE_EQUAL( res.size(), infos.size() );
+      for ( unsigned i = 0; i < infos.size(); ++i )
+        BOOST_CHECK_EQUAL( res[i].first.alias(), infos[i].alias() );
+
+      // the broken repo fails alone, the others get their own solv file
+      BOOST_CHECK( res[0].second );
+      BOOST_CHECK( res[1].second );
+      BOOST_CHECK( ! res[2].second );
+      BOOST_CHECK( res[3].second );
+      BOOST_CHECK_EQUAL( firstPackage( "a" ), "alpha" );
+      BOOST_CHECK_EQUAL( firstPackage( "b" ), "epsilon" );
+      BOOST_CHECK_EQUAL( firstPackage( "c" ), "epsilon" );
+      BOOST_CHECK( ! PathInfo( opts.repoSolvCachePath/"broken"/"solv" ).isExist() );
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(legacy_reports_list_choice)
+{
+  struct ListChoiceReceiver : public callback::ReceiveReport<JobReport>
+  {
+    void report( const UserData & userData_r ) override
+    {
+      if ( userData_r.type() != ContentType( JobReport::LIST_CHOICE_REQUEST ) )
+        return;
+      _label = userData_r.get<std::string>( "Label" );
+      _answers = userData_r.get<std::vector<std::pair<std::string,std::string>>>( "Answers" ).size();
+      _defaultAnswer = userData_r.get<unsigned>( "DefaultAnswer" );
+      userData_r.set( "Choice", _choice );
+    }
+    std::string _label;
+    unsigned _answers = 0;
+    unsigned _defaultAnswer = 0;
+    unsigned _choice = 0;
+  } receiver;
+  receiver.connect();
+
+  auto ctx = zyppng::Context::create();
+  std::vector<zyppng::connection> conns { zyppng::connectLegacyReports( ctx ) };
+
+  auto ask = [&]() {
+    auto req = zyppng::ListChoiceRequest::create( "Pick one", std::vector<zyppng::ListChoiceRequest::Choice>{ {"a", ""}, {"b", ""}, {"c", ""} }, 1 );
+    ctx->sendUserRequest( req );
+    return req->choice();
+  };
+
+  receiver._choice = 2;
+  BOOST_CHECK_EQUAL( ask(), 2 );
+  BOOST_CHECK_EQUAL( receiver._label, "Pick one" );
+  BOOST_CHECK_EQUAL( receiver._answers, 3 );
+  BOOST_CHECK_EQUAL( receiver._defaultAnswer, 1 );
+
+  // an invalid choice falls back to the default
+  receiver._choice = 3;
+  BOOST_CHECK_EQUAL( ask(), 1 );
+
+  for ( auto & conn : conns )
+    conn.disconnect();
+}
+
 BOOST_AUTO_TEST_CASE(repo_seting_test)
 {
   RepoInfo repo;
@@ -98,3 +98,42 @@ BOOST_AUTO_TEST_CASE(inrOnlyRequires)
   // Fillup only namespace recommends
   BOOST_checkresult( resolve( inrMode|onlyRequires ), { Apde } );
 }
+
+BOOST_AUTO_TEST_CASE(reuseSolverResult)
+{
+  test.resolver().setReuseSolverResult( true );
+  Ap.status().setTransact( true, ResStatus::USER );
+  BOOST_checkresult( resolve(), { Ap, Ip, Apde, Aprec } );
+  sat::detail::CSolver * solver = test.resolver().get();
+
+  // unchanged: the last run is reused
+  BOOST_checkresult( resolve(), { Ap, Ip, Apde, Aprec } );
+  BOOST_CHECK_EQUAL( test.resolver().get(), solver );
+
+  // changed flags
+  BOOST_checkresult( resolve( onlyRequires ), { Ap, Ip, Apde } );
+  BOOST_CHECK( test.resolver().get() != solver );
+  solver = test.resolver().get();
+
+  // changed jobs
+  Ap.status().setTransact( false, ResStatus::USER );
+  BOOST_checkresult( resolve( inrMode|onlyRequires ), { Apde } );
+  BOOST_CHECK( test.resolver().get() != solver );
+  solver = test.resolver().get();
+  BOOST_checkresult( resolve( inrMode|onlyRequires ), { Apde } );
+  BOOST_CHECK_EQUAL( test.resolver().get(), solver );
+
+  // changed namespace providers: same jobs, but french is wanted now
+  const LocaleSet requested { sat::Pool::instance().getRequestedLocales() };
+  LocaleSet withFr { requested };
+  withFr.insert( Locale( "fr" ) );
+  sat::Pool::instance().initRequestedLocales( withFr );	// no locale jobs
+  BOOST_checkresult( resolve( inrMode|onlyRequires ), { Apde, Apfr } );
+  BOOST_CHECK( test.resolver().get() != solver );
+  solver = test.resolver().get();
+  BOOST_checkresult( resolve( inrMode|onlyRequires ), { Apde, Apfr } );
+  BOOST_CHECK_EQUAL( test.resolver().get(), solver );
+  sat::Pool::instance().initRequestedLocales( requested );
+
+  test.resolver().setReuseSolverResult( false );
+}
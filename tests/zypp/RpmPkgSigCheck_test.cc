@@ -276,3 +276,27 @@ BOOST_AUTO_TEST_CASE(signed_broken_header_pkg_withkey)
   } };
   BOOST_CHECK_EQUAL( xpct, cs );
 }
+
+BOOST_AUTO_TEST_CASE(check_at_once_withkey)
+{
+  // Several packages checked at once must produce the same results as checked one by one.
+  std::vector<Pathname> rpms {
+    DATADIR/"no.rpm",
+    DATADIR/"unsigned.rpm",
+    DATADIR/"signed.rpm",
+    DATADIR/"signed_broken.rpm",
+    DATADIR/"signed_broken_header.rpm",
+  };
+  std::vector<CheckResult> xpct;
+  for ( const Pathname & rpm : rpms )
+    xpct.push_back( gcheckPackageSignature( rpm ) );
+
+  std::vector<RpmDb::CheckPackageResult> res { test.target().rpmDb().checkPackageSignatures( rpms, 2 ) };
+  BOOST_REQUIRE_EQUAL( res.size(), rpms.size() );
+  for ( unsigned i = 0; i < rpms.size(); ++i )
+  {
+    BOOST_CHECK_EQUAL( res[i], xpct[i].result );
+    // the next check returns the remembered result and details
+    BOOST_CHECK_EQUAL( gcheckPackageSignature( rpms[i] ), xpct[i] );
+  }
+}
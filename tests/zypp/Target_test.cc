@@ -12,11 +12,62 @@
 #include <zypp/ZYpp.h>
 #include <zypp/ZYppFactory.h>
 #include <zypp/TmpPath.h>
+#include <zypp/ExternalProgram.h>
+#include <zypp/sat/Queue.h>
+#include <zypp/target/TargetImpl.h>
+#include <zypp/target/rpm/RpmDb.h>
+#include <zypp/target/rpm/RpmHeader.h>
+
+extern "C"
+{
+#include <solv/pool.h>
+#include <solv/repo.h>
+#include <solv/repo_solv.h>
+}
 
 using boost::unit_test::test_case;
 using namespace zypp;
 using namespace zypp::filesystem;
 
+namespace
+{
+  /** The solvables in \a solv_r as sorted strings (NEVRA, rpmdbid and dependencies). */
+  std::vector<std::string> solvContent( const Pathname & solv_r )
+  {
+    std::vector<std::string> ret;
+    AutoDispose<::Pool*> poolGuard { ::pool_create(), ::pool_free };
+    ::Pool * pool = poolGuard;
+    ::Repo * repo = ::repo_create( pool, "content" );
+    {
+      AutoFILE fp { ::fopen( solv_r.c_str(), "re" ) };
+      BOOST_REQUIRE( fp );
+      BOOST_REQUIRE_EQUAL( ::repo_add_solv( repo, fp, 0 ), 0 );
+    }
+
+    ::Solvable * s = nullptr;
+    sat::detail::SolvableIdType p = 0;
+    FOR_REPO_SOLVABLES( repo, p, s )
+    {
+      std::string str { ::pool_solvable2str( pool, s ) };
+      if ( repo->rpmdbid )
+        str += str::Str() << " #" << repo->rpmdbid[p - repo->start];
+      for ( sat::detail::IdType key : { SOLVABLE_PROVIDES, SOLVABLE_REQUIRES, SOLVABLE_CONFLICTS, SOLVABLE_OBSOLETES } )
+      {
+        sat::Queue q;
+        ::solvable_lookup_deparray( s, key, q, -1 );
+        std::vector<std::string> deps;
+        for ( sat::detail::IdType dep : q )
+          deps.push_back( ::pool_dep2str( pool, dep ) );
+        std::sort( deps.begin(), deps.end() );
+        str += " [" + str::join( deps, "," ) + "]";
+      }
+      ret.push_back( std::move(str) );
+    }
+    std::sort( ret.begin(), ret.end() );
+    return ret;
+  }
+}
+
 BOOST_AUTO_TEST_CASE(target_test)
 {
 
@@ -54,3 +105,55 @@ BOOST_AUTO_TEST_CASE(target_test)
     BOOST_CHECK_EQUAL( dlabel.summary, "A cool distribution" );
     BOOST_CHECK_EQUAL( dlabel.shortName, "" );
 }
+
+BOOST_AUTO_TEST_CASE(patch_system_solv)
+{
+  filesystem::TmpDir tmp;
+  const Pathname root { tmp.path() };
+  const Pathname rpmfile { Pathname(TESTS_SRC_DIR) / "/zypp/data/RpmPkgSigCheck/unsigned.rpm" };
+  const std::string name { target::rpm::RpmHeader::readPackage( rpmfile, target::rpm::RpmHeader::NOVERIFY )->tag_name() };
+
+  // Not necessarily rpm's default dbpath: patchSystemSolv must read the same database as rpmdb2solv -D.
+  assert_dir( root / "/var/lib/rpm" );
+  target::rpm::RpmDb rpmdb;
+  rpmdb.initDatabase( root );
+  BOOST_REQUIRE_EQUAL( rpmdb.dbPath(), Pathname("/var/lib/rpm") );
+
+  // like TargetImpl::buildCache
+  auto rpmdb2solv = [&]( const Pathname & out_r ) {
+    ExternalProgram::Arguments cmd {
+      "rpmdb2solv", "-r", root.asString(), "-D", rpmdb.dbPath().asString(),
+      "-X", "-p", Pathname::assertprefix( root, "/etc/products.d" ).asString(), "-o", out_r.asString()
+    };
+    ExternalProgram prog( cmd, ExternalProgram::Stderr_To_Stdout );
+    for ( std::string output( prog.receiveLine() ); output.length(); output = prog.receiveLine() )
+      WAR << "  " << output;
+    BOOST_REQUIRE_EQUAL( prog.close(), 0 );
+  };
+  const target::rpm::RpmInstFlags flags { target::rpm::RPMINST_JUSTDB | target::rpm::RPMINST_NODEPS
+                                          | target::rpm::RPMINST_NOSIGNATURE | target::rpm::RPMINST_NODIGEST };
+
+  const Pathname empty { root / "empty.solv" };
+  const Pathname installed { root / "installed.solv" };
+  const Pathname removed { root / "removed.solv" };
+  const Pathname rebuilt { root / "rebuilt.solv" };
+  rpmdb2solv( empty );
+
+  // install
+  rpmdb.installPackage( rpmfile, flags );
+  BOOST_REQUIRE( target::patchSystemSolv( root, rpmdb.dbPath(), empty, installed, { name } ) );
+  rpmdb2solv( rebuilt );
+  BOOST_CHECK( solvContent( installed ) == solvContent( rebuilt ) );
+  BOOST_CHECK_EQUAL( solvContent( installed ).size(), solvContent( empty ).size() + 1 );
+
+  // remove
+  rpmdb.removePackage( name, flags );
+  BOOST_REQUIRE( target::patchSystemSolv( root, rpmdb.dbPath(), installed, removed, { name } ) );
+  rpmdb2solv( rebuilt );
+  BOOST_CHECK( solvContent( removed ) == solvContent( rebuilt ) );
+
+  // headers not part of the commit need a rebuild
+  rpmdb.installPackage( rpmfile, flags );
+  BOOST_CHECK( ! target::patchSystemSolv( root, rpmdb.dbPath(), removed, installed, { "not-" + name } ) );
+  BOOST_CHECK( ! target::patchSystemSolv( root, rpmdb.dbPath(), removed, installed, {} ) );
+}
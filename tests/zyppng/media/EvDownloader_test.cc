@@ -5,6 +5,7 @@
 #include <zypp-curl/ng/network/NetworkRequestError>
 #include <zypp-curl/ng/network/NetworkRequestDispatcher>
 #include <zypp-curl/ng/network/Request>
+#include <zypp-curl/ng/network/private/mirrorcontrol_p.h>
 #include <zypp-media/auth/CredentialManager>
 #include <zypp/Digest.h>
 #include <zypp/TmpPath.h>
@@ -12,7 +13,9 @@
 #include <zypp/ZConfig.h>
 #include <iostream>
 #include <fstream>
+#include <map>
 #include <random>
+#include <thread>
 #include "WebServer.h"
 #include "TestTools.h"
 
@@ -36,6 +39,9 @@
 
 namespace bdata = boost::unit_test::data;
 
+using TestTools::ScopedMirrorStats;
+BOOST_GLOBAL_FIXTURE( ScopedMirrorStats );
+
 bool withSSL[] = {true, false};
 
 BOOST_DATA_TEST_CASE( dltest_basic, bdata::make( withSSL ), withSSL)
@@ -108,6 +114,65 @@ BOOST_DATA_TEST_CASE( dltest_basic, bdata::make( withSSL ), withSSL)
 }
 
 
+BOOST_AUTO_TEST_CASE( dltest_file_checksum )
+{
+  auto ev = zyppng::EventLoop::create();
+
+  zyppng::Downloader::Ptr downloader = std::make_shared<zyppng::Downloader>();
+
+  std::string dummyContent = "This is just some dummy content,\nto test calculating the checksum while downloading.\n";
+  const zypp::CheckSum expected = zypp::CheckSum::sha256FromString( dummyContent );
+
+  WebServer web((zypp::Pathname(TESTS_SRC_DIR)/"data"/"dummywebroot").c_str(), 10001, false );
+  web.addRequestHandler("getData", WebServer::makeResponse("200", dummyContent ) );
+  BOOST_REQUIRE( web.start() );
+
+  zypp::filesystem::TmpDir targetDir;
+  zypp::Pathname targetFile = targetDir.path() / "file";
+  zyppng::Url weburl (web.url());
+  weburl.setPathName("/handler/getData");
+
+  auto download = [&]( const zyppng::DownloadSpec &spec ) {
+    zyppng::Download::Ptr dl = downloader->downloadFile( spec );
+    dl->spec().setTransferSettings( web.transferSettings() );
+    dl->sigFinished().connect([&]( zyppng::Download & ){
+      ev->quit();
+    });
+    dl->start();
+    ev->run();
+    return dl;
+  };
+
+  {
+    // just calculated
+    auto dl = download( zyppng::DownloadSpec( weburl, targetFile, dummyContent.length() )
+                          .setFileChecksumType( "sha256" )
+                          .setMetalinkEnabled( false ) );
+    BOOST_TEST_REQ_SUCCESS( dl );
+    BOOST_CHECK_EQUAL( dl->fileChecksum(), expected );
+    zypp::filesystem::unlink( targetFile );
+  }
+  {
+    // verified
+    auto dl = download( zyppng::DownloadSpec( weburl, targetFile, dummyContent.length() )
+                          .setExpectedFileChecksum( expected )
+                          .setMetalinkEnabled( false ) );
+    BOOST_TEST_REQ_SUCCESS( dl );
+    BOOST_CHECK_EQUAL( dl->fileChecksum(), expected );
+    zypp::filesystem::unlink( targetFile );
+  }
+  {
+    // a mismatch fails the download and removes the file
+    auto dl = download( zyppng::DownloadSpec( weburl, targetFile, dummyContent.length() )
+                          .setExpectedFileChecksum( zypp::CheckSum::sha256FromString( "something else" ) )
+                          .setMetalinkEnabled( false ) );
+    BOOST_TEST_REQ_FAILED( dl );
+    BOOST_CHECK_EQUAL( dl->lastRequestError().type(), zyppng::NetworkRequestError::InvalidChecksum );
+    BOOST_CHECK( dl->fileChecksum().empty() );
+    BOOST_CHECK( !zypp::PathInfo( targetFile ).isExist() );
+  }
+}
+
 // Globals are HORRIBLY broken here, do not use any static globals they might not be initialized at the point
 // of calling the initializer of the MirrorSet vector, so we are manually initializing the Byte and KByte Units here
 const auto makeBytes( zypp::ByteCount::SizeType size ) {
@@ -428,10 +493,40 @@ WebServer::RequestHandler makeBrokenRangeHandler ( const std::string &fName )
   };
 };
 
+//creates a request handler for the Mock WebServer that answers a range request with the data from \a content
+//after \a delay, otherwise relocates the request
+WebServer::RequestHandler makeSlowBlockHandler ( const std::string &fName, const std::string *content, std::chrono::milliseconds delay )
+{
+  return [ fName, content, delay ]( WebServer::Request &req ) {
+    auto it = req.params.find( "HTTP_RANGE" );
+    if ( it != req.params.end() && zypp::str::startsWith( it->second, "bytes=" ) ) {
+        std::string range = it->second.substr( 6 ); //remove bytes=
+        size_t dash = range.find_first_of( "-" );
+        if ( dash != std::string::npos && range.find_first_of( "," ) == std::string::npos ) {
+          const off_t start = std::stoll( range.substr( 0, dash ) );
+          const off_t end   = std::min<off_t>( std::stoll( range.substr( dash+1 ) ), content->size() - 1 );
+
+          std::this_thread::sleep_for( delay );
+          req.rout << "Status: 206 Partial Content\r\n"
+                   << "Accept-Ranges: bytes\r\n"
+                   << "Content-Length: "<< ( end - start + 1 ) <<"\r\n"
+                   << "Content-Range: bytes "<<start<<"-"<<end<<"/"<<content->size()<<"\r\n"
+                   <<"\r\n"
+                   << content->substr( start, end - start + 1 );
+          return;
+        }
+    }
+    req.rout << "Location: /"<<fName<<"\r\n\r\n";
+    return;
+  };
+};
+
 int maxConcurrentDLs[] = { 1, 2, 4, 8, 10, 15 };
 
 BOOST_DATA_TEST_CASE( test1, bdata::make( generateMirr() ) * bdata::make( withSSL ) * bdata::make( maxConcurrentDLs )  , elem, withSSL, maxDLs )
 {
+  // mirrors known from a previous case would not be probed
+  TestTools::ScopedMirrorStats mirrorStats;
 
   zypp::Pathname testRoot = zypp::Pathname(TESTS_SRC_DIR)/"zyppng/data/downloader";
 
@@ -562,6 +657,90 @@ BOOST_DATA_TEST_CASE( test1, bdata::make( generateMirr() ) * bdata::make( withSS
     BOOST_REQUIRE( elem.expectedStates == allStates );
 }
 
+BOOST_AUTO_TEST_CASE( dltest_race_slow_mirror )
+{
+  TestTools::ScopedMirrorStats mirrorStats;
+
+  zypp::Pathname testRoot = zypp::Pathname(TESTS_SRC_DIR)/"zyppng/data/downloader";
+  const std::string metaTempl = TestTools::readFile ( testRoot/"test.txt.meta" );
+  const std::string content   = TestTools::readFile ( testRoot/"test.txt" );
+  BOOST_REQUIRE( !metaTempl.empty() );
+  BOOST_REQUIRE( !content.empty() );
+
+  auto ev = zyppng::EventLoop::create();
+
+  WebServer web( testRoot.c_str(), 10001, false );
+  BOOST_REQUIRE( web.start() );
+
+  zypp::filesystem::TmpFile targetFile;
+  std::shared_ptr<zyppng::Downloader> downloader = std::make_shared<zyppng::Downloader>();
+
+  zyppng::Url weburl (web.url());
+  weburl.setPathName( "/handler/test.txt" );
+
+  // the slow mirror answers later than a request needs to run before it is raced (1s),
+  // but before the activity timeout of the request (2s) makes it fail
+  std::string urls;
+  urls += makeUrl( 10, zyppng::Url( web.url().asCompleteString() + "/test.txt" ) ) + "\n";
+  urls += makeUrl( 10, zyppng::Url( web.url().asCompleteString() + "/handler/slow" ) ) + "\n";
+  std::string metaFile = zypp::str::Format( metaTempl ) % urls;
+  web.addRequestHandler( "test.txt", makeMetaFileHandler( "test.txt", &metaFile ) );
+  web.addRequestHandler( "slow", makeSlowBlockHandler( "test.txt", &content, std::chrono::milliseconds( 1500 ) ) );
+
+  using Clock = std::chrono::steady_clock;
+  std::map<zyppng::NetworkRequest *, Clock::time_point> started;
+  std::vector<Clock::duration> cancelledAfter; //< runtime of the requests that lost a race
+
+  auto dl = downloader->downloadFile( zyppng::DownloadSpec(weburl, targetFile) );
+  dl->spec().setTransferSettings( web.transferSettings() )
+    .setPreferredChunkSize( makeKBytes( 256 ) )
+    .setExpectedFileSize( makeBytes( content.size() ) );
+
+  dl->dispatcher().sigDownloadStarted().connect( [&]( zyppng::NetworkRequestDispatcher &, zyppng::NetworkRequest &req){
+    started[&req] = Clock::now();
+  });
+
+  dl->dispatcher().sigDownloadFinished().connect( [&]( zyppng::NetworkRequestDispatcher &, zyppng::NetworkRequest &req ){
+    if ( req.hasError() && req.error().type() == zyppng::NetworkRequestError::Cancelled )
+      cancelledAfter.push_back( Clock::now() - started[&req] );
+  });
+
+  dl->sigFinished().connect([&]( zyppng::Download & ){
+    ev->quit();
+  });
+
+  dl->start();
+  ev->run();
+
+  BOOST_TEST_REQ_SUCCESS( dl );
+  BOOST_REQUIRE_EQUAL( TestTools::readFile( targetFile.path() ), content );
+
+  // the fast mirror took over the block of the slow one, but not before the slow one ran long enough
+  BOOST_REQUIRE( !cancelledAfter.empty() );
+  for ( const auto &runtime : cancelledAfter )
+    BOOST_CHECK( runtime >= std::chrono::seconds( 1 ) );
+}
+
+BOOST_AUTO_TEST_CASE( dltest_mirror_stats_file )
+{
+  TestTools::ScopedMirrorStats mirrorStats;
+
+  auto ev = zyppng::EventLoop::create();
+  WebServer web( (zypp::Pathname(TESTS_SRC_DIR)/"zyppng/data/downloader").c_str(), 10001 );
+  BOOST_REQUIRE( web.start() );
+
+  // probing a mirror measures it, the statistics go to the configured file
+  auto mirrors = zyppng::MirrorControl::create();
+  mirrors->sigAllMirrorsReady().connect( [&](){ ev->quit(); } );
+  zypp::media::MetalinkMirror mirr;
+  mirr.url = web.url();
+  mirrors->registerMirrors( { mirr } );
+  ev->run();
+  mirrors.reset();
+
+  BOOST_CHECK( zypp::PathInfo( mirrorStats.file() ).isFile() );
+}
+
 //tests:
 // - broken cert
 // - correct expected filesize
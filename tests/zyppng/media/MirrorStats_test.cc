@@ -0,0 +1,104 @@
+#include <boost/test/unit_test.hpp>
+#include <zypp-curl/ng/network/private/mirrorstats_p.h>
+#include <zypp-media/MediaConfig>
+#include <zypp/TmpPath.h>
+#include <zypp/PathInfo.h>
+
+using zyppng::MirrorStats;
+using namespace std::chrono_literals;
+
+BOOST_AUTO_TEST_CASE(mirrorstats_roundtrip)
+{
+  zypp::filesystem::TmpDir tmp;
+  const auto file = tmp.path() / "cache" / "mirrorstats";
+
+  {
+    MirrorStats stats( file );
+    BOOST_REQUIRE( !stats.find("http://mirror1") );
+    stats.addLatency( "http://mirror1", 100ms );
+    stats.addLatency( "http://mirror1", 200ms );
+    stats.addTransfer( "http://mirror1", true, 1024 * 1024, 1000ms );
+    stats.addTransfer( "http://mirror2", false );
+    BOOST_REQUIRE( stats.save() );
+  }
+  BOOST_REQUIRE( zypp::PathInfo( file ).isFile() );
+
+  MirrorStats stats( file );
+  const auto m1 = stats.find("http://mirror1");
+  BOOST_REQUIRE( m1 );
+  BOOST_CHECK( m1->isWarm() );
+  BOOST_CHECK_CLOSE( m1->latency, 150.0, 1 );
+  BOOST_CHECK_CLOSE( m1->throughput, 1024.0 * 1024.0, 1 );
+  BOOST_CHECK_EQUAL( m1->errorRate, 0.0 );
+
+  const auto m2 = stats.find("http://mirror2");
+  BOOST_REQUIRE( m2 );
+  BOOST_CHECK( !m2->isWarm() ); // never measured a latency
+  BOOST_CHECK_CLOSE( m2->errorRate, 1.0, 1 );
+
+  // small transfers do not change the throughput
+  stats.addTransfer( "http://mirror1", true, 10, 1000ms );
+  BOOST_CHECK_CLOSE( stats.find("http://mirror1")->throughput, 1024.0 * 1024.0, 1 );
+}
+
+BOOST_AUTO_TEST_CASE(mirrorstats_merge)
+{
+  zypp::filesystem::TmpDir tmp;
+  const auto file = tmp.path() / "mirrorstats";
+
+  MirrorStats first( file );
+  MirrorStats second( file );
+  first.addLatency( "http://mirror1", 100ms );
+  second.addLatency( "http://mirror2", 300ms );
+  BOOST_REQUIRE( first.save() );
+  BOOST_REQUIRE( second.save() );
+
+  // entries written by the first instance must survive the save of the second one
+  MirrorStats stats( file );
+  BOOST_REQUIRE( stats.find("http://mirror1") );
+  BOOST_REQUIRE( stats.find("http://mirror2") );
+  BOOST_CHECK_CLOSE( stats.find("http://mirror2")->latency, 300.0, 1 );
+}
+
+BOOST_AUTO_TEST_CASE(mirrorstats_decay)
+{
+  MirrorStats::Entry e;
+  e.latency   = 100;
+  e.errorRate = 1;
+  e.weight    = 8;
+  e.lastSeen  = 1000;
+
+  const auto now = MirrorStats::decayed( e, e.lastSeen );
+  BOOST_CHECK_EQUAL( now.weight, 8 );
+  BOOST_CHECK_EQUAL( now.errorRate, 1 );
+
+  // the weight and the error rate halve every 3 days
+  const auto later = MirrorStats::decayed( e, e.lastSeen + 3 * 24 * 60 * 60 );
+  BOOST_CHECK_CLOSE( later.weight, 4.0, 1 );
+  BOOST_CHECK_CLOSE( later.errorRate, 0.5, 1 );
+  BOOST_CHECK_EQUAL( later.latency, 100 );
+  BOOST_CHECK( !later.isWarm( e.lastSeen + 3 * 24 * 60 * 60 ) );
+}
+
+BOOST_AUTO_TEST_CASE(mirrorstats_config)
+{
+  auto &mediaConf = zypp::MediaConfig::instance();
+  zypp::filesystem::TmpDir root;
+
+  // kept in the cache of the target
+  mediaConf.setSystemRoot( root.path() );
+  BOOST_CHECK_EQUAL( mediaConf.download_mirror_stats_file(), root.path() / "/var/cache/zypp/mirrorstats" );
+
+  // can be switched off
+  BOOST_REQUIRE( mediaConf.setConfigValue( "main", "download.mirror_stats", "false" ) );
+  BOOST_CHECK( !mediaConf.download_mirror_stats() );
+  BOOST_CHECK( mediaConf.download_mirror_stats_file().empty() );
+  MirrorStats stats( mediaConf.download_mirror_stats_file() );
+  stats.addTransfer( "http://mirror1", false );
+  BOOST_CHECK( stats.save() );	// nothing to do
+  BOOST_CHECK( !zypp::PathInfo( root.path() / "/var/cache/zypp" ).isExist() );
+
+  mediaConf.setConfigValue( "main", "download.mirror_stats", "true" );
+  mediaConf.setSystemRoot( "/" );
+  BOOST_CHECK_EQUAL( mediaConf.download_mirror_stats_file(), zypp::Pathname("/var/cache/zypp/mirrorstats") );
+}
@@ -12,6 +12,7 @@
 #include <zypp/PathInfo.h>
 
 #include <iostream>
+#include <fstream>
 #include <thread>
 #include <chrono>
 
@@ -438,6 +439,47 @@ BOOST_DATA_TEST_CASE(nwdispatcher_multipart_dl_ftp, bdata::make( withSSL ), with
   nwdispatcher_multipart_dl_impl<FtpServer>(withSSL);
 }
 
+// The full file checksum of a range download is calculated by reading the written file back
+BOOST_DATA_TEST_CASE(nwdispatcher_multipart_dl_file_checksum, bdata::make( withSSL ), withSSL )
+{
+  auto ev = zyppng::EventLoop::create();
+  auto disp = std::make_shared<zyppng::NetworkRequestDispatcher>();
+  disp->sigQueueFinished().connect( [&ev]( const zyppng::NetworkRequestDispatcher& ){
+    ev->quit();
+  });
+
+  disp->run();
+
+  WebServer web((zypp::Pathname(TESTS_SRC_DIR)/"zypp/data/Fetcher/remote-site").c_str(), 10001, withSSL );
+  BOOST_REQUIRE( web.start() );
+
+  auto weburl = web.url();
+  weburl.setPathName("/file-1.txt");
+
+  // larger than the read back buffer, so more than one read is needed
+  auto sourceFile = zypp::Pathname(TESTS_SRC_DIR)/"zypp/data/Fetcher/remote-site/file-1.txt";
+  zypp::PathInfo pi( sourceFile );
+  BOOST_REQUIRE_GT( pi.size(), 4096 );
+  const zypp::CheckSum expected( "sha256", std::ifstream( sourceFile.c_str() ) );
+
+  for ( bool verify : { true, false } ) {
+    zypp::filesystem::TmpFile targetFile;
+
+    auto reqDLFile = std::make_shared<zyppng::NetworkRequest>( weburl, targetFile.path() );
+    reqDLFile->transferSettings() = web.transferSettings();
+    reqDLFile->addRequestRange( 0, pi.size() );
+    if ( verify )
+      BOOST_REQUIRE( reqDLFile->setExpectedFileChecksum( expected ) );
+    else
+      BOOST_REQUIRE( reqDLFile->setFileChecksumType( "sha256" ) );
+
+    disp->enqueue( reqDLFile );
+    if ( disp->count () ) ev->run();
+    BOOST_TEST_REQ_SUCCESS( reqDLFile );
+    BOOST_CHECK_EQUAL( reqDLFile->fileChecksum(), expected );
+  }
+}
+
 // Test that simulates us sending a range request to the server and the server answering with a range header but does not send actual range data
 BOOST_DATA_TEST_CASE(nwdispatcher_rangereq_norangeanswer, bdata::make( withSSL ), withSSL )
 {
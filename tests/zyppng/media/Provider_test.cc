@@ -35,6 +35,10 @@
 
 namespace bdata = boost::unit_test::data;
 
+// the download workers use the mirror statistics file of the test
+using TestTools::ScopedMirrorStats;
+BOOST_GLOBAL_FIXTURE( ScopedMirrorStats );
+
 
 BOOST_AUTO_TEST_CASE( http_prov_time_overflow )
 {
@@ -94,6 +98,47 @@ BOOST_AUTO_TEST_CASE( http_prov )
   BOOST_REQUIRE_EQUAL( sum, std::string("63b4a45ec881d90b83c2e6af7bcbfa78") );
 }
 
+BOOST_AUTO_TEST_CASE( http_prov_downloaded_checksum )
+{
+  auto ev = zyppng::EventLoop::create ();
+
+  const auto &workerPath = zypp::Pathname ( TESTS_BUILD_DIR ).dirname() / "tools" / "workers";
+  const auto &webRoot    = zypp::Pathname ( TESTS_SRC_DIR ) / "zyppng" / "data" / "downloader";
+
+  zypp::filesystem::TmpDir provideRoot;
+
+  auto prov = zyppng::Provide::create ( provideRoot );
+  prov->setWorkerPath ( workerPath );
+  prov->start();
+
+  WebServer web( webRoot.c_str(), 10001, false );
+  BOOST_REQUIRE( web.start() );
+
+  auto fileUrl = web.url();
+  fileUrl.setPathName( "/media.1/media" );
+
+  // the worker calculates a checksum of the requested type while downloading, even a wrong one is just reported
+  const zypp::CheckSum expected = zypp::CheckSum::md5( "63b4a45ec881d90b83c2e6af7bcbfa78" );
+  auto op = prov->provide( fileUrl, zyppng::ProvideFileSpec().setChecksum( zypp::CheckSum::md5( "00000000000000000000000000000000" ) ) );
+
+  std::exception_ptr err;
+  std::optional<zyppng::ProvideRes> resOpt;
+  op->onReady([&]( zyppng::expected<zyppng::ProvideRes> &&res ){
+    ev->quit();
+    if ( !res )
+      err = res.error();
+    else
+      resOpt = *res;
+  });
+
+  if ( !op->isReady() )
+    ev->run();
+
+  BOOST_REQUIRE( !err );
+  BOOST_REQUIRE( resOpt.has_value() );
+  BOOST_CHECK_EQUAL( resOpt->downloadedChecksum(), expected );
+}
+
 BOOST_AUTO_TEST_CASE( http_attach )
 {
   using namespace zyppng::operators;
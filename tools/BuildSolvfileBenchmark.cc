@@ -0,0 +1,133 @@
+#define INCLUDE_TESTSETUP_WITHOUT_BOOST
+#include "../tests/lib/TestSetup.h"
+#undef  INCLUDE_TESTSETUP_WITHOUT_BOOST
+#include "argparse.h"
+
+#include <iostream>
+#include <chrono>
+#include <zypp/ExternalProgram.h>
+#include <zypp/repo/SolvfileBuilder.h>
+
+using std::cout;
+using std::cerr;
+using std::endl;
+
+static std::string appname { "NO_NAME" };
+
+int errexit( const std::string & msg_r = std::string(), int exit_r = 100 )
+{
+  if ( ! msg_r.empty() )
+    cerr << endl << appname << ": ERR: " << msg_r << endl << endl;
+  return exit_r;
+}
+
+int usage( const argparse::Options & options_r, int return_r = 0 )
+{
+  cerr << "USAGE: " << appname << " [OPTION]... REPODIR..." << endl;
+  cerr << "    Compare building the solv file of the raw metadata in REPODIR" << endl;
+  cerr << "    by running repo2solv and by the in-process builder." << endl;
+  cerr << options_r << endl;
+  return return_r;
+}
+
+/** Probe the raw metadata type like RepoManager::probeCache does. */
+repo::RepoType probeType( const Pathname & dir_r )
+{
+  if ( PathInfo( dir_r/"repodata/repomd.xml" ).isFile() )
+    return repo::RepoType::RPMMD;
+  if ( PathInfo( dir_r/"content" ).isFile() || PathInfo( dir_r/"suse/setup/descr" ).isDir() )
+    return repo::RepoType::YAST2;
+  return repo::RepoType::NONE;
+}
+
+void runRepo2solv( const Pathname & dir_r, const Pathname & solvfile_r )
+{
+  ExternalProgram::Arguments cmd;
+#ifdef ZYPP_REPO2SOLV_PATH
+  cmd.push_back( ZYPP_REPO2SOLV_PATH );
+#else
+  cmd.push_back( PathInfo( "/usr/bin/repo2solv" ).isFile() ? "repo2solv" : "repo2solv.sh" );
+#endif
+  cmd.push_back( "-o" );
+  cmd.push_back( solvfile_r.asString() );
+  cmd.push_back( "-X" );
+  cmd.push_back( dir_r.asString() );
+
+  ExternalProgram prog( cmd, ExternalProgram::Stderr_To_Stdout );
+  for ( std::string output( prog.receiveLine() ); output.length(); output = prog.receiveLine() )
+    cerr << "  " << output;
+  if ( prog.close() != 0 )
+    ZYPP_THROW( Exception( "repo2solv failed" ) );
+}
+
+/** Run \a fnc_r \a count_r times and print the mean time and the solv file size. */
+template <class Fnc>
+void measure( const std::string & label_r, unsigned count_r, const Pathname & solvfile_r, Fnc && fnc_r )
+{
+  using Clock = std::chrono::steady_clock;
+  Clock::duration total { Clock::duration::zero() };
+  for ( unsigned i = 0; i < count_r; ++i )
+  {
+    const auto start = Clock::now();
+    fnc_r();
+    total += Clock::now() - start;
+  }
+  cout << "  " << label_r << ": "
+       << std::chrono::duration_cast<std::chrono::milliseconds>( total ).count() / count_r << " ms"
+       << " (" << PathInfo( solvfile_r ).size() << " bytes)" << endl;
+}
+
+int main( int argc, char * argv[] )
+{
+  appname = Pathname::basename( argv[0] );
+
+  unsigned count = 5;
+
+  argparse::Options options;
+  options.add()
+    ( "help,h",	"Print help and exit." )
+    ( "count,n",	"Build each solv file COUNT times (default 5).", argparse::Option::Arg::required )
+    ;
+  auto result = options.parse( argc, argv );
+
+  if ( result.count( "help" ) )
+    return usage( options );
+
+  if ( result.count( "count" ) )
+    count = std::max( str::strtonum<unsigned>( result["count"].arg() ), 1U );
+
+  if ( result.positionals().empty() )
+    return usage( options, 101 );
+
+  filesystem::TmpDir tmp;
+  for ( const std::string & arg : result.positionals() )
+  {
+    const Pathname dir { Pathname(arg).absolutename() };
+    const repo::RepoType type { probeType( dir ) };
+    if ( ! repo::buildSolvfileSupported( type ) )
+      return errexit( dir.asString() + ": unsupported metadata type " + type.asString(), 102 );
+
+    cout << dir << " (" << type << ")" << endl;
+    try
+    {
+      measure( "repo2solv ", count, tmp.path()/"repo2solv.solv", [&]() {
+        runRepo2solv( dir, tmp.path()/"repo2solv.solv" );
+      });
+      measure( "in process", count, tmp.path()/"inprocess.solv", [&]() {
+        repo::buildSolvfile( type, dir, tmp.path()/"inprocess.solv" );
+      });
+    }
+    catch ( const Exception & excpt )
+    {
+      return errexit( excpt.asUserHistory(), 103 );
+    }
+
+    // load both to compare the content
+    sat::Pool satpool( sat::Pool::instance() );
+    Repository r1 { satpool.addRepoSolv( tmp.path()/"repo2solv.solv", "repo2solv" ) };
+    Repository r2 { satpool.addRepoSolv( tmp.path()/"inprocess.solv", "inprocess" ) };
+    cout << "  solvables: " << r1.solvablesSize() << " / " << r2.solvablesSize() << endl;
+    satpool.reposEraseAll();
+  }
+  return 0;
+}
@@ -7,6 +7,7 @@
 #include <zypp-core/base/String.h>
 #include <iostream>
 #include <algorithm>
+#include <chrono>
 
 int main ( int argc, char *argv[] )
 {
@@ -65,16 +66,36 @@ int main ( int argc, char *argv[] )
     return size;
   };
 
+  // run reuseBlocks on a copy of the blocklist and report the throughput
+  const zypp::ByteCount deltaSize( zypp::PathInfo(deltaFile).size() );
+  const auto measureReuse = [&]( const std::string &label, zypp::media::MediaBlockList bl, const zypp::Pathname &out ) {
+    zypp::AutoFILE f( fopen( out.c_str(), "w"));
+    if ( !*f ) {
+      std::cerr << "Unable to open " << out << std::endl;
+      return bl;
+    }
+    const auto start = std::chrono::steady_clock::now();
+    bl.reuseBlocks( *f, deltaFile.asString() );
+    const std::chrono::duration<double> secs = std::chrono::steady_clock::now() - start;
+    std::cout << label << ": " << secs.count() << "s, " << ( deltaSize / ( 1024.0 * 1024.0 ) / secs.count() ) << " MB/s" << std::endl;
+    return bl;
+  };
+
   zypp::filesystem::TmpFile file;
   const auto numBlocksBefore = blocks.numBlocks();
   const zypp::ByteCount sizeBefore = getDownloadSize(blocks);
 
   std::cout << "Blocks parsed from Metalink file: " << numBlocksBefore << std::endl;
   if ( numBlocksBefore ) {
-    zypp::AutoFILE f( fopen( "Out.test.gz", "w"));
-    if ( *f ) {
-      blocks.reuseBlocks( *f, deltaFile.asString() );
-    }
+    zypp::media::MediaBlockList scalar( blocks );
+    scalar.setRsumBatching( false );
+    scalar = measureReuse( "Byte by byte", scalar, file.path() );
+
+    blocks.setRsumBatching( true );
+    blocks = measureReuse( "Batched (" + zypp::media::MediaBlockList::rsumKernelName() + ")", blocks, "Out.test.gz" );
+
+    if ( scalar.asString() != blocks.asString() )
+      std::cerr << "Warning: the batched and the byte by byte search found different blocks!" << std::endl;
   }
 
   const size_t numBlocksAfter = blocks.numBlocks();
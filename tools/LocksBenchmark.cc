@@ -0,0 +1,140 @@
+#include "argparse.h"
+
+#include <iostream>
+#include <zypp/base/String.h>
+#include <zypp/base/Exception.h>
+#include <zypp/base/Measure.h>
+#include <zypp/PathInfo.h>
+#include <zypp/TmpPath.h>
+#include <zypp/PoolQuery.h>
+#include <zypp/PoolQueryUtil.tcc>
+#include <zypp/Locks.h>
+#include <zypp/ResPool.h>
+#include <zypp/sat/Pool.h>
+
+using std::cout;
+using std::cerr;
+using std::endl;
+using namespace zypp;
+
+static std::string appname { "NO_NAME" };
+
+int errexit( const std::string & msg_r = std::string(), int exit_r = 100 )
+{
+  if ( ! msg_r.empty() )
+    cerr << endl << appname << ": ERR: " << msg_r << endl << endl;
+  return exit_r;
+}
+
+int usage( const argparse::Options & options_r, int return_r = 0 )
+{
+  cerr << "USAGE: " << appname << " [OPTION]... SOLVFILE..." << endl;
+  cerr << "    Load the SOLVFILEs and compare applying a synthetic locks file" << endl;
+  cerr << "    query by query and via Locks::readAndApply." << endl;
+  cerr << options_r << endl;
+  return return_r;
+}
+
+/** The currently locked solvables; unlocking them. */
+sat::SolvableSet takeLocked()
+{
+  sat::SolvableSet ret;
+  for ( const PoolItem & pi : ResPool::instance() )
+  {
+    if ( pi.status().isLocked() )
+    {
+      ret.insert( pi );
+      pi.status().setLock( false, ResStatus::USER );
+    }
+  }
+  return ret;
+}
+
+int main( int argc, char * argv[] )
+{
+  appname = Pathname::basename( argv[0] );
+
+  unsigned count = 500;
+  unsigned globs = 10;
+
+  argparse::Options options;
+  options.add()
+    ( "help,h",	"Print help and exit." )
+    ( "locks,n",	"Number of locks by package name (default 500).", argparse::Option::Arg::required )
+    ( "globs,g",	"Percentage of them using a wildcard (default 10).", argparse::Option::Arg::required )
+    ;
+  auto result = options.parse( argc, argv );
+
+  if ( result.count( "help" ) )
+    return usage( options );
+
+  if ( result.count( "locks" ) )
+    count = str::strtonum<unsigned>( result["locks"].arg() );
+
+  if ( result.count( "globs" ) )
+    globs = std::min( str::strtonum<unsigned>( result["globs"].arg() ), 100U );
+
+  std::vector<std::string> args { result.positionals() };
+  if ( args.empty() )
+    return usage( options, 101 );
+
+  sat::Pool satpool( sat::Pool::instance() );
+  try
+  {
+    for ( const std::string & arg : args )
+    {
+      const Pathname file { Pathname(arg).absolutename() };
+      satpool.addRepoSolv( file, file.basename() );
+    }
+    satpool.prepare();
+    cout << "  " << satpool.reposSize() << " repos, " << satpool.solvablesSize() << " solvables" << endl;
+
+    // Locks as zypper writes them, taking the names from the pool.
+    std::vector<PoolQuery> queries;
+    unsigned i = 0;
+    for ( const sat::Solvable & solv : satpool.solvables() )
+    {
+      if ( queries.size() == count )
+        break;
+      if ( ! solv.isKind( ResKind::package ) )
+        continue;
+      PoolQuery q;
+      q.addKind( ResKind::package );
+      q.setMatchGlob();
+      q.setCaseSensitive( true );
+      if ( ++i * globs % 100 < globs )
+        q.addAttribute( sat::SolvAttr::name, solv.name().substr( 0, solv.name().size() / 2 ) + "*" );
+      else
+        q.addAttribute( sat::SolvAttr::name, solv.name() );
+      queries.push_back( q );
+    }
+    filesystem::TmpFile locksfile;
+    writePoolQueriesToFile( locksfile, queries.begin(), queries.end() );
+    cout << "  " << queries.size() << " locks" << endl;
+
+    {
+      debug::Measure m( "per query", cout );
+      for ( const PoolQuery & q : queries )
+      {
+        for ( const PoolItem & pi : q.poolItem() )
+          pi.status().setLock( true, ResStatus::USER );
+      }
+    }
+    sat::SolvableSet perQuery { takeLocked() };
+
+    {
+      debug::Measure m( "combined", cout );
+      Locks::instance().readAndApply( locksfile );
+    }
+    sat::SolvableSet combined { takeLocked() };
+
+    cout << "  " << perQuery.size() << " locked" << endl;
+    if ( perQuery.get() != combined.get() )
+      return errexit( "results differ (" + str::numstring( combined.size() ) + " combined)", 102 );
+  }
+  catch ( const Exception & excpt )
+  {
+    return errexit( excpt.asUserHistory(), 103 );
+  }
+  return 0;
+}
@@ -0,0 +1,116 @@
+#include "argparse.h"
+
+#include <iostream>
+#include <zypp/base/String.h>
+#include <zypp/base/Exception.h>
+#include <zypp/base/Measure.h>
+#include <zypp/PathInfo.h>
+#include <zypp/target/rpm/RpmDb.h>
+
+using std::cout;
+using std::cerr;
+using std::endl;
+using namespace zypp;
+using target::rpm::RpmDb;
+
+static std::string appname { "NO_NAME" };
+
+int errexit( const std::string & msg_r = std::string(), int exit_r = 100 )
+{
+  if ( ! msg_r.empty() )
+    cerr << endl << appname << ": ERR: " << msg_r << endl << endl;
+  return exit_r;
+}
+
+int usage( const argparse::Options & options_r, int return_r = 0 )
+{
+  cerr << "USAGE: " << appname << " [OPTION]... RPMDIR..." << endl;
+  cerr << "    Compare checking the signatures of the rpm files in RPMDIR" << endl;
+  cerr << "    one by one and by several rpm processes at once." << endl;
+  cerr << options_r << endl;
+  return return_r;
+}
+
+int main( int argc, char * argv[] )
+{
+  appname = Pathname::basename( argv[0] );
+
+  Pathname root { "/" };
+  unsigned jobs = 0;
+
+  argparse::Options options;
+  options.add()
+    ( "help,h",	"Print help and exit." )
+    ( "root",	"Use the rpm database (keyring) below ROOT (default /).", argparse::Option::Arg::required )
+    ( "jobs,j",	"Check JOBS files at once (default: one per CPU).", argparse::Option::Arg::required )
+    ;
+  auto result = options.parse( argc, argv );
+
+  if ( result.count( "help" ) )
+    return usage( options );
+
+  if ( result.count( "root" ) )
+    root = Pathname( result["root"].arg() ).absolutename();
+
+  if ( result.count( "jobs" ) )
+    jobs = str::strtonum<unsigned>( result["jobs"].arg() );
+
+  if ( result.positionals().empty() )
+    return usage( options, 101 );
+
+  std::vector<Pathname> files;
+  for ( const std::string & arg : result.positionals() )
+  {
+    const Pathname dir { Pathname(arg).absolutename() };
+    filesystem::dirForEach( dir, [&]( const Pathname & dir_r, const char *const name_r ) {
+      if ( str::hasSuffix( name_r, ".rpm" ) && PathInfo( dir_r/name_r ).isFile() )
+        files.push_back( dir_r/name_r );
+      return true;
+    });
+  }
+  if ( files.empty() )
+    return errexit( "No rpm files found", 102 );
+  cout << files.size() << " rpm files below " << root << endl;
+
+  try
+  {
+    RpmDb rpmdb;
+    rpmdb.initDatabase( root );
+
+    std::vector<RpmDb::CheckPackageResult> serial;
+    {
+      debug::Measure m( "one by one", cout );
+      for ( const Pathname & file : files )
+      {
+        RpmDb::CheckPackageDetail detail;
+        serial.push_back( rpmdb.checkPackageSignature( file, detail ) );
+      }
+    }
+
+    std::vector<RpmDb::CheckPackageResult> parallel;
+    {
+      debug::Measure m( "at once", cout );
+      parallel = rpmdb.checkPackageSignatures( files, jobs );
+    }
+
+    // The results must not differ. The remembered ones are used up by this.
+    unsigned differ = 0;
+    for ( unsigned i = 0; i < files.size(); ++i )
+    {
+      RpmDb::CheckPackageDetail detail;
+      rpmdb.checkPackageSignature( files[i], detail );
+      if ( serial[i] != parallel[i] )
+      {
+        cout << "  " << files[i] << ": " << serial[i] << " / " << parallel[i] << endl;
+        ++differ;
+      }
+    }
+    if ( differ )
+      return errexit( str::numstring( differ ) + " results differ", 103 );
+  }
+  catch ( const Exception & excpt )
+  {
+    return errexit( excpt.asUserHistory(), 104 );
+  }
+  return 0;
+}
@@ -0,0 +1,142 @@
+#include "argparse.h"
+
+#include <iostream>
+#include <zypp/base/String.h>
+#include <zypp/base/Exception.h>
+#include <zypp/base/Measure.h>
+#include <zypp/PathInfo.h>
+#include <zypp/PoolQuery.h>
+#include <zypp/RepoManager.h>
+#include <zypp/sat/Pool.h>
+
+using std::cout;
+using std::cerr;
+using std::endl;
+using namespace zypp;
+
+static std::string appname { "NO_NAME" };
+
+int errexit( const std::string & msg_r = std::string(), int exit_r = 100 )
+{
+  if ( ! msg_r.empty() )
+    cerr << endl << appname << ": ERR: " << msg_r << endl << endl;
+  return exit_r;
+}
+
+int usage( const argparse::Options & options_r, int return_r = 0 )
+{
+  cerr << "USAGE: " << appname << " [OPTION]... STRING [SOLVFILE]..." << endl;
+  cerr << "    Compare searching the pool for STRING serially, on several threads" << endl;
+  cerr << "    at once and via a CompiledPoolQuery. Either the SOLVFILEs are loaded, or with --root" << endl;
+  cerr << "    the cached repos of a system." << endl;
+  cerr << options_r << endl;
+  return return_r;
+}
+
+int main( int argc, char * argv[] )
+{
+  appname = Pathname::basename( argv[0] );
+
+  Pathname root;
+  unsigned copies = 1;
+  unsigned jobs = 0;
+
+  argparse::Options options;
+  options.add()
+    ( "help,h",	"Print help and exit." )
+    ( "root",	"Load the enabled repos cached below ROOT.", argparse::Option::Arg::required )
+    ( "copies,n",	"Load each SOLVFILE COPIES times as different repos (default 1).", argparse::Option::Arg::required )
+    ( "jobs,j",	"Search on JOBS threads at once (default: one per CPU).", argparse::Option::Arg::required )
+    ( "attr",	"Search in ATTR (e.g. solvable:description) instead of all attributes.", argparse::Option::Arg::required )
+    ( "regex",	"STRING is a regex.", argparse::Option::Arg::none )
+    ( "files",	"Match the full path of filelist entries.", argparse::Option::Arg::none )
+    ;
+  auto result = options.parse( argc, argv );
+
+  if ( result.count( "help" ) )
+    return usage( options );
+
+  if ( result.count( "root" ) )
+    root = Pathname( result["root"].arg() ).absolutename();
+
+  if ( result.count( "copies" ) )
+    copies = std::max( str::strtonum<unsigned>( result["copies"].arg() ), 1U );
+
+  if ( result.count( "jobs" ) )
+    jobs = str::strtonum<unsigned>( result["jobs"].arg() );
+
+  std::vector<std::string> args { result.positionals() };
+  if ( args.empty() || root.empty() == ( args.size() == 1 ) )
+    return usage( options, 101 );
+
+  PoolQuery query;
+  if ( result.count( "attr" ) )
+    query.addAttribute( sat::SolvAttr( result["attr"].arg() ), args[0] );
+  else
+    query.addString( args[0] );
+  if ( result.count( "regex" ) )
+    query.setMatchRegex();
+  query.setFilesMatchFullPath( result.count( "files" ) );
+
+  sat::Pool satpool( sat::Pool::instance() );
+  try
+  {
+    if ( root.empty() )
+    {
+      for ( unsigned i = 1; i < args.size(); ++i )
+      {
+        const Pathname file { Pathname(args[i]).absolutename() };
+        for ( unsigned c = 0; c < copies; ++c )
+          satpool.addRepoSolv( file, file.basename() + "-" + str::numstring( c ) );
+      }
+    }
+    else
+    {
+      RepoManager repoManager { RepoManagerOptions( root ) };
+      std::list<RepoInfo> toLoad;
+      for ( const RepoInfo & info : repoManager.knownRepositories() )
+      {
+        if ( info.enabled() && repoManager.isCached( info ) )
+          toLoad.push_back( info );
+      }
+      repoManager.loadFromCache( toLoad );
+    }
+    satpool.prepare();
+    cout << query << endl;
+    cout << "  " << satpool.reposSize() << " repos, " << satpool.solvablesSize() << " solvables" << endl;
+
+    std::vector<sat::Solvable> serial;
+    {
+      debug::Measure m( "serial", cout );
+      serial.assign( query.begin(), query.end() );
+    }
+
+    std::vector<sat::Solvable> parallel;
+    query.setParallelJobs( jobs );
+    {
+      debug::Measure m( "parallel", cout );
+      parallel.assign( query.begin(), query.end() );
+    }
+
+    CompiledPoolQuery compiled( query );
+    {
+      debug::Measure m( "compiled", cout );
+      compiled.result();
+    }
+    {
+      debug::Measure m( "repeated", cout );
+      compiled.result();
+    }
+
+    cout << "  " << serial.size() << " matches" << endl;
+    if ( serial != parallel )
+      return errexit( "results differ (" + str::numstring( parallel.size() ) + " parallel matches)", 102 );
+    if ( compiled.size() != sat::SolvableSet( serial.begin(), serial.end() ).size() )
+      return errexit( "results differ (" + str::numstring( compiled.size() ) + " compiled matches)", 102 );
+  }
+  catch ( const Exception & excpt )
+  {
+    return errexit( excpt.asUserHistory(), 103 );
+  }
+  return 0;
+}
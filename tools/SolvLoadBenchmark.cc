@@ -0,0 +1,177 @@
+#include "argparse.h"
+
+#include <iostream>
+#include <zypp/base/String.h>
+#include <zypp/base/Exception.h>
+#include <zypp/base/Measure.h>
+#include <zypp/ByteCount.h>
+#include <zypp/PathInfo.h>
+#include <zypp/RepoManager.h>
+#include <zypp/ResPool.h>
+#include <zypp/sat/Pool.h>
+
+#include <fcntl.h>
+
+using std::cout;
+using std::cerr;
+using std::endl;
+using namespace zypp;
+
+static std::string appname { "NO_NAME" };
+
+int errexit( const std::string & msg_r = std::string(), int exit_r = 100 )
+{
+  if ( ! msg_r.empty() )
+    cerr << endl << appname << ": ERR: " << msg_r << endl << endl;
+  return exit_r;
+}
+
+int usage( const argparse::Options & options_r, int return_r = 0 )
+{
+  cerr << "USAGE: " << appname << " [OPTION]... [SOLVFILE]..." << endl;
+  cerr << "    Measure the startup hot paths of the pool: loading the solv files," << endl;
+  cerr << "    sat::Pool::prepare (whatprovides), creating the ResPool and its ResObjects." << endl;
+  cerr << "    Either the SOLVFILEs are loaded, or with --root the cached repos" << endl;
+  cerr << "    of a system via RepoManager::loadFromCache." << endl;
+  cerr << options_r << endl;
+  return return_r;
+}
+
+/** Current and peak resident set size of the process. */
+std::string rss()
+{ return str::Str() << "RSS " << debug::residentSetSize() << " (peak " << debug::peakResidentSetSize() << ")"; }
+
+/** Evict \a file_r from the page cache, so it is loaded cold. */
+void evict( const Pathname & file_r )
+{
+  int fd = ::open( file_r.c_str(), O_RDONLY|O_CLOEXEC );
+  if ( fd < 0 )
+    return;
+  ::posix_fadvise( fd, 0, 0, POSIX_FADV_DONTNEED );
+  ::close( fd );
+}
+
+/** Run \a fnc_r as phase \a label_r, printing the times and the RSS afterwards. */
+template <class Fnc>
+void phase( const std::string & label_r, Fnc && fnc_r )
+{
+  {
+    debug::Measure m( label_r, cout );
+    fnc_r();
+  }
+  cout << "  " << rss() << endl;
+}
+
+int main( int argc, char * argv[] )
+{
+  appname = Pathname::basename( argv[0] );
+
+  Pathname root;
+  unsigned copies = 1;
+  bool serial = false;
+  bool cold = false;
+
+  argparse::Options options;
+  options.add()
+    ( "help,h",	"Print help and exit." )
+    ( "root",	"Load the enabled repos cached below ROOT.", argparse::Option::Arg::required )
+    ( "serial",	"With --root, load the repos one by one instead of as a batch.", argparse::Option::Arg::none )
+    ( "cold",	"Evict the solv files from the page cache before loading them.", argparse::Option::Arg::none )
+    ( "copies,n",	"Load each SOLVFILE COPIES times as different repos (default 1), to mimic systems with many repos.", argparse::Option::Arg::required )
+    ;
+  auto result = options.parse( argc, argv );
+
+  if ( result.count( "help" ) )
+    return usage( options );
+
+  if ( result.count( "root" ) )
+    root = Pathname( result["root"].arg() ).absolutename();
+
+  if ( result.count( "serial" ) )
+    serial = true;
+
+  if ( result.count( "cold" ) )
+    cold = true;
+
+  if ( result.count( "copies" ) )
+    copies = std::max( str::strtonum<unsigned>( result["copies"].arg() ), 1U );
+
+  if ( root.empty() == result.positionals().empty() )
+    return usage( options, 101 );
+
+  sat::Pool satpool( sat::Pool::instance() );
+  cout << "start" << endl << "  " << rss() << endl;
+  try
+  {
+    if ( root.empty() )
+    {
+      if ( cold )
+      {
+        for ( const std::string & arg : result.positionals() )
+          evict( Pathname(arg).absolutename() );
+      }
+      phase( "load", [&]() {
+        for ( const std::string & arg : result.positionals() )
+        {
+          const Pathname file { Pathname(arg).absolutename() };
+          for ( unsigned i = 0; i < copies; ++i )
+            satpool.addRepoSolv( file, file.basename() + "-" + str::numstring( i ) );
+        }
+      });
+    }
+    else
+    {
+      RepoManager repoManager { RepoManagerOptions( root ) };
+      std::list<RepoInfo> toLoad;
+      for ( const RepoInfo & info : repoManager.knownRepositories() )
+      {
+        if ( ! info.enabled() )
+          continue;
+        if ( ! repoManager.isCached( info ) )
+        {
+          cerr << "  " << info.alias() << ": not cached" << endl;
+          continue;
+        }
+        toLoad.push_back( info );
+        if ( cold )
+          evict( RepoManagerOptions( root ).repoSolvCachePath / info.escaped_alias() / "solv" );
+      }
+      phase( "load", [&]() {
+        if ( serial )
+        {
+          for ( const RepoInfo & info : toLoad )
+            repoManager.loadFromCache( info );
+        }
+        else
+          repoManager.loadFromCache( toLoad );
+      });
+    }
+    cout << "  " << satpool.reposSize() << " repos, " << satpool.solvablesSize() << " solvables" << endl;
+
+    phase( "prepare", [&]() {
+      satpool.prepare();
+    });
+
+    // The ResObjects are created on demand, the RSS after the 1st phase
+    // is what a pool costs until someone asks for them.
+    unsigned items = 0;
+    phase( "respool", [&]() {
+      for ( const PoolItem & pi : ResPool::instance() )
+      {
+        if ( pi )
+          ++items;
+      }
+    });
+    cout << "  " << items << " pool items" << endl;
+
+    phase( "resobjects", [&]() {
+      for ( const PoolItem & pi : ResPool::instance() )
+        pi.resolvable();
+    });
+  }
+  catch ( const Exception & excpt )
+  {
+    return errexit( excpt.asUserHistory(), 102 );
+  }
+  return 0;
+}
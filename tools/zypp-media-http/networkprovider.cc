@@ -298,6 +298,7 @@ void NetworkProvider::provide()
     const auto &expFilesize = req->_spec.value( zyppng::ProvideMsgFields::ExpectedFilesize );
     const auto &checkExistsOnly = req->_spec.value( zyppng::ProvideMsgFields::CheckExistOnly );
     const auto &deltaFile = req->_spec.value( zyppng::ProvideMsgFields::DeltaFile );
+    const auto &checksumType = req->_spec.value( zyppng::ProvideMsgFields::ChecksumType );
 
     zyppng::DownloadSpec spec(
       url
@@ -307,6 +308,7 @@ void NetworkProvider::provide()
     spec
       .setCheckExistsOnly( checkExistsOnly.valid() ? checkExistsOnly.asBool() : false )
       .setDeltaFile ( deltaFile.valid() ? deltaFile.asString() : zypp::Pathname() )
+      .setFileChecksumType( checksumType.valid() ? checksumType.asString() : std::string() )
       .setMetalinkEnabled ( doMetalink );
 
     req->startDownload( _dlManager->downloadFile ( spec ) );
@@ -415,7 +417,14 @@ void NetworkProvider::itemFinished( NetworkProvideItemRef item )
           , {} );
 
       } else {
-        provideSuccess( item->_spec.requestId(), false, item->_targetFileName );
+        // hand out the checksum calculated while downloading, so the controller does not need to read the file again
+        zyppng::HeaderValueMap extra;
+        const auto &chksum = item->_dl->fileChecksum();
+        if ( !chksum.empty() ) {
+          extra.set( std::string(zyppng::ProvideFinishedMsgFields::ChecksumType), chksum.type() );
+          extra.set( std::string(zyppng::ProvideFinishedMsgFields::Checksum), chksum.checksum() );
+        }
+        provideSuccess( item->_spec.requestId(), false, item->_targetFileName, extra );
       }
     }
   } else {
@@ -109,6 +109,20 @@ namespace zyppng {
     _sigFinishedConn.disconnect();
   }
 
+  double DownloadPrivateBase::Request::throughput() const
+  {
+    auto time  = _transferTime;
+    auto bytes = _transferredBytes;
+    if ( state() == NetworkRequest::Running ) {
+      time  += std::chrono::steady_clock::now() - _transferStart;
+      bytes += downloadedByteCount();
+    }
+    const auto secs = std::chrono::duration<double>( time ).count();
+    if ( secs > 0 )
+      return bytes / secs;
+    return _myMirror ? _myMirror->throughput : 0;
+  }
+
   DownloadPrivate::DownloadPrivate(Downloader &parent, std::shared_ptr<NetworkRequestDispatcher> requestDispatcher, std::shared_ptr<MirrorControl> mirrors, DownloadSpec &&spec, Download &p)
     : DownloadPrivateBase( parent, std::move(requestDispatcher), std::move(mirrors), std::move(spec), p )
   { }
@@ -140,6 +154,7 @@ namespace zyppng {
     _specHasZckInfo    = zypp::indeterminate;
     _emittedSigStart   = false;
     _stoppedOnMetalink = false;
+    _fileChecksum      = zypp::CheckSum();
     _lastTriedAuthTime = 0;
 
     // restart the statemachine
@@ -283,6 +298,13 @@ namespace zyppng {
     return d_func()->_stoppedOnMetalink;
   }
 
+  zypp::CheckSum Download::fileChecksum() const
+  {
+    if ( state() != Finished || hasError() )
+      return zypp::CheckSum();
+    return d_func()->_fileChecksum;
+  }
+
   DownloadSpec &Download::spec()
   {
     return d_func()->_spec;
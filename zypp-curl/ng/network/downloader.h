@@ -9,6 +9,7 @@
 #include <zypp-curl/ng/network/AuthData>
 
 #include <zypp-core/ByteCount.h>
+#include <zypp-core/CheckSum.h>
 
 namespace zypp::media {
   class TransferSettings;
@@ -207,6 +208,13 @@ namespace zyppng {
      */
     bool stoppedOnMetalink () const;
 
+    /*!
+     * Returns the checksum of the downloaded file if the download succeeded and one was requested via
+     * \ref DownloadSpec::setFileChecksumType or verified via \ref DownloadSpec::setExpectedFileChecksum.
+     * Otherwise an empty checksum is returned.
+     */
+    zypp::CheckSum fileChecksum () const;
+
     /*!
      * Returns a reference to the internally used download spec.
      * \sa zyppng::DownloadSpec
@@ -33,6 +33,8 @@ namespace zyppng {
     zypp::ByteCount _headerSize;     //< Optional file header size for things like zchunk
     std::optional<zypp::CheckSum> _headerChecksum; //< Optional file header checksum
     zypp::ByteCount _preferred_chunk_size = 0;
+    std::string _fileChecksumType; //< Optional checksum type to calculate while downloading
+    std::optional<zypp::CheckSum> _expectedFileChecksum; //< Optional checksum the downloaded file must have
   };
 
   ZYPP_IMPL_PRIVATE( DownloadSpec )
@@ -166,4 +168,34 @@ namespace zyppng {
     }
     return *this;
   }
+
+  DownloadSpec &DownloadSpec::setFileChecksumType( const std::string &type )
+  {
+    Z_D();
+    d->_fileChecksumType = type;
+    return *this;
+  }
+
+  const std::string &DownloadSpec::fileChecksumType() const
+  {
+    Z_D();
+    return d->_fileChecksumType;
+  }
+
+  const std::optional<zypp::CheckSum> &DownloadSpec::expectedFileChecksum() const
+  {
+    Z_D();
+    return d->_expectedFileChecksum;
+  }
+
+  DownloadSpec &DownloadSpec::setExpectedFileChecksum( const zypp::CheckSum &sum )
+  {
+    Z_D();
+    if ( sum.empty() )
+      d->_expectedFileChecksum.reset();
+    else {
+      d->_expectedFileChecksum = sum;
+    }
+    return *this;
+  }
 }
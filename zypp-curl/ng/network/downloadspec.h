@@ -107,6 +107,22 @@ namespace zyppng {
     const std::optional<zypp::CheckSum> &headerChecksum () const;
     DownloadSpec &setHeaderChecksum ( const zypp::CheckSum &sum );
 
+    /*!
+     * Calculate a checksum of the given type while the file is downloaded. The downloader does not verify it,
+     * the result is available via \ref Download::fileChecksum once the download succeeded.
+     * \note Only plain downloads calculate the checksum on the fly, metalink and zchunk downloads ignore it.
+     */
+    DownloadSpec &setFileChecksumType ( const std::string &type );
+    const std::string &fileChecksumType () const;
+
+    /*!
+     * The checksum the downloaded file must have. If it does not match, the download fails
+     * with \ref NetworkRequestError::InvalidChecksum and the target file is removed.
+     * Plain downloads calculate it on the fly, for all others the target file is read once it is complete.
+     */
+    const std::optional<zypp::CheckSum> &expectedFileChecksum () const;
+    DownloadSpec &setExpectedFileChecksum ( const zypp::CheckSum &sum );
+
   private:
     zypp::RWCOW_pointer<DownloadSpecPrivate> d_ptr;
   };
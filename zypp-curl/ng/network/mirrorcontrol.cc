@@ -7,17 +7,21 @@
 |                                                                      |
 ----------------------------------------------------------------------*/
 #include "private/mirrorcontrol_p.h"
+#include "private/mirrorstats_p.h"
 #include "private/mediadebug_p.h"
+#include <zypp-media/MediaConfig>
 #include <zypp-core/zyppng/base/EventDispatcher>
 #include <zypp-core/zyppng/base/Signals>
 #include <zypp-core/base/String.h>
 #include <iostream>
+#include <cmath>
 
 namespace zyppng {
 
   constexpr uint penaltyIncrease = 100;
   constexpr uint defaultSampleTime = 2;
   constexpr uint defaultMaxConnections = 5;
+  constexpr uint errorRatePenalty = 10 * penaltyIncrease; //rating added for mirrors that always failed in previous runs
 
   MirrorControl::Mirror::Mirror( MirrorControl &parent ) : _parent( parent )
   {}
@@ -40,6 +44,20 @@ namespace zyppng {
     transferUnref();
   }
 
+  void MirrorControl::Mirror::finishTransfer( const bool success, const NetworkRequest &req )
+  {
+    const auto timings = req.timings();
+    std::chrono::milliseconds time( 0 );
+    if ( timings ) {
+      time = std::chrono::duration_cast<std::chrono::milliseconds>( timings->total - timings->pretransfer );
+      // a reused connection has no connect time
+      if ( timings->connect > timings->namelookup )
+        _parent._stats->addLatency( _key, std::chrono::duration_cast<std::chrono::milliseconds>( timings->connect - timings->namelookup ) );
+    }
+    _parent._stats->addTransfer( _key, success, req.downloadedByteCount(), time );
+    finishTransfer( success );
+  }
+
   void MirrorControl::Mirror::cancelTransfer()
   {
     transferUnref();
@@ -68,6 +86,7 @@ namespace zyppng {
   }
 
   MirrorControl::MirrorControl()
+    : _stats( std::make_unique<MirrorStats>( zypp::MediaConfig::instance().download_mirror_stats_file() ) )
   {
     // set up the single shot timer, that way we can emit a signal after we finished processing all
     // events that have queued up in the event loop instead of constantly firing the signal
@@ -96,6 +115,8 @@ namespace zyppng {
       }
       DBG_MEDIA << "End Mirror probing results." << std::endl;
 
+      _stats->save();
+
       _sigAllMirrorsReady.emit();
     }, *this );
     _dispatcher->run();
@@ -143,22 +164,43 @@ namespace zyppng {
         auto mirrorHandle = std::shared_ptr<Mirror>( new Mirror(*this) );
         mirrorHandle->rating          = mirror.priority;
         mirrorHandle->_maxConnections = mirror.maxConnections;
+        mirrorHandle->_key            = urlKey;
         mirrorHandle->mirrorUrl       = mirror.url;
         mirrorHandle->mirrorUrl.setPathName("/");
 
+        if ( const auto stats = _stats->find( urlKey ) ) {
+          // mirrors that failed in previous runs are less attractive
+          mirrorHandle->rating += std::lround( stats->errorRate * errorRatePenalty );
+          if ( stats->throughput > 0 )
+            mirrorHandle->throughput = stats->throughput;
+
+          // we have recent measurements, no need to probe the mirror again
+          if ( stats->isWarm() ) {
+            mirrorHandle->rating += std::lround( stats->latency );
+            DBG_MEDIA << "Using known rating for mirror: " << mirrorHandle->mirrorUrl << ", rating is " << mirrorHandle->rating << std::endl;
+            _handles.insert( std::make_pair(urlKey, mirrorHandle ) );
+            doesKnowSomeMirrors = true;
+            continue;
+          }
+        }
+
         mirrorHandle->_request = std::make_shared<NetworkRequest>( mirrorHandle->mirrorUrl, "/dev/null", NetworkRequest::WriteShared );
         mirrorHandle->_request->setOptions( NetworkRequest::ConnectionTest );
         mirrorHandle->_request->transferSettings().setTimeout( defaultSampleTime );
         mirrorHandle->_request->transferSettings().setConnectTimeout( defaultSampleTime );
         mirrorHandle->_finishedConn = mirrorHandle->_request->connectFunc( &NetworkRequest::sigFinished, [ mirrorHandle, &someReadyDelay = _newMirrSigDelay ](  NetworkRequest &req, const NetworkRequestError & ){
 
-          if ( req.hasError() )
+          if ( req.hasError() ) {
             ERR << "Mirror request failed: " << req.error().toString() << " ; " << req.extendedErrorString() << "; for url: "<<req.url()<<std::endl;
+            mirrorHandle->_parent._stats->addTransfer( mirrorHandle->_key, false );
+          }
 
           const auto timings = req.timings();
           std::chrono::milliseconds connTime;
           if ( timings ) {
             connTime = std::chrono::duration_cast<std::chrono::milliseconds>(timings->connect - timings->namelookup);
+            if ( !req.hasError() )
+              mirrorHandle->_parent._stats->addLatency( mirrorHandle->_key, connTime );
           } else {
             // we can not get any measurements, maximum penalty
             connTime = std::chrono::seconds( defaultSampleTime );
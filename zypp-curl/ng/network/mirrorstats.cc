@@ -0,0 +1,223 @@
+/*---------------------------------------------------------------------\
+|                          ____ _   __ __ ___                          |
+|                         |__  / \ / / . \ . \                         |
+|                           / / \ V /|  _/  _/                         |
+|                          / /__ | | | | | |                           |
+|                         /_____||_| |_| |_|                           |
+|                                                                      |
+----------------------------------------------------------------------*/
+#include "private/mirrorstats_p.h"
+#include <zypp-core/base/Logger.h>
+#include <zypp-core/base/String.h>
+#include <zypp-core/fs/PathInfo.h>
+#include <zypp-core/AutoDispose.h>
+
+#include <algorithm>
+#include <cmath>
+#include <sstream>
+
+#include <fcntl.h>
+#include <sys/file.h>
+#include <unistd.h>
+
+namespace zyppng {
+
+  namespace {
+    constexpr time_t decayHalfLife = 3 * 24 * 60 * 60; //< the weight of an entry halves every 3 days
+    constexpr time_t maxEntryAge   = 30 * 24 * 60 * 60; //< entries not seen for 30 days are dropped
+    constexpr time_t maxWarmAge    = 24 * 60 * 60;      //< entries younger than a day are trusted without probing
+    constexpr double maxWeight     = 8;                 //< upper bound for the weight of the old value in the moving average
+    constexpr zypp::ByteCount::SizeType minThroughputBytes = 64 * 1024; //< smaller transfers are dominated by the latency
+
+    using Entries = std::unordered_map<std::string, MirrorStats::Entry>;
+
+    /*! Moving average of \a old_r and \a sample_r, if \a old_r is unknown \a sample_r is taken as is */
+    double average ( double old_r, double weight_r, double sample_r )
+    {
+      if ( old_r < 0 || weight_r <= 0 )
+        return sample_r;
+      const auto w = std::min( weight_r, maxWeight );
+      return ( old_r * w + sample_r ) / ( w + 1 );
+    }
+
+    Entries parse ( const std::string &content_r )
+    {
+      Entries res;
+      std::istringstream str( content_r );
+      for ( std::string line; std::getline( str, line ); ) {
+        if ( line.empty() || line[0] == '#' )
+          continue;
+
+        std::istringstream lstr( line );
+        std::string key;
+        MirrorStats::Entry e;
+        if ( !( lstr >> key >> e.latency >> e.throughput >> e.errorRate >> e.weight >> e.lastSeen ) ) {
+          WAR << "Ignoring malformed mirror statistics line: " << line << std::endl;
+          continue;
+        }
+        res[key] = e;
+      }
+      return res;
+    }
+
+    std::string readAll ( int fd_r )
+    {
+      std::string res;
+      char buf[4096];
+      for ( ssize_t r = 0; ( r = ::read( fd_r, buf, sizeof(buf) ) ) != 0; ) {
+        if ( r < 0 ) {
+          if ( errno == EINTR )
+            continue;
+          break;
+        }
+        res.append( buf, r );
+      }
+      return res;
+    }
+
+    bool writeAll ( int fd_r, const std::string &data_r )
+    {
+      const char *d = data_r.data();
+      size_t left = data_r.size();
+      while ( left ) {
+        const auto w = ::write( fd_r, d, left );
+        if ( w < 0 ) {
+          if ( errno == EINTR )
+            continue;
+          return false;
+        }
+        d += w;
+        left -= w;
+      }
+      return true;
+    }
+  }
+
+  bool MirrorStats::Entry::isWarm( time_t now ) const
+  {
+    return ( latency >= 0 && now - lastSeen < maxWarmAge );
+  }
+
+  MirrorStats::MirrorStats( zypp::Pathname file_r )
+    : _file( std::move(file_r) )
+  {
+    if ( _file.empty() )
+      return;
+
+    zypp::AutoFD fd( ::open( _file.c_str(), O_RDONLY | O_CLOEXEC ) );
+    if ( fd == -1 ) {
+      if ( errno != ENOENT )
+        WAR << "Unable to read mirror statistics from " << _file << ": " << zypp::str::strerror( errno ) << std::endl;
+      return;
+    }
+    if ( ::flock( fd, LOCK_SH ) != 0 ) {
+      WAR << "Unable to lock mirror statistics " << _file << ": " << zypp::str::strerror( errno ) << std::endl;
+      return;
+    }
+    _entries = parse( readAll( fd ) );
+    ::flock( fd, LOCK_UN );
+
+    MIL << "Loaded statistics of " << _entries.size() << " mirrors from " << _file << std::endl;
+  }
+
+  MirrorStats::~MirrorStats()
+  {
+    save();
+  }
+
+  std::optional<MirrorStats::Entry> MirrorStats::find( const std::string &key_r ) const
+  {
+    const auto i = _entries.find( key_r );
+    if ( i == _entries.end() )
+      return {};
+
+    const auto now = std::time(nullptr);
+    if ( now - i->second.lastSeen > maxEntryAge )
+      return {};
+    return decayed( i->second, now );
+  }
+
+  void MirrorStats::addLatency( const std::string &key_r, std::chrono::milliseconds latency_r )
+  {
+    auto &e = touch( key_r );
+    e.latency = average( e.latency, e.weight, latency_r.count() );
+    e.weight  = std::min( e.weight, maxWeight ) + 1;
+  }
+
+  void MirrorStats::addTransfer( const std::string &key_r, bool success_r, zypp::ByteCount bytes_r, std::chrono::milliseconds time_r )
+  {
+    auto &e = touch( key_r );
+    e.errorRate = average( e.errorRate, e.weight, success_r ? 0.0 : 1.0 );
+    if ( success_r && bytes_r >= minThroughputBytes && time_r.count() > 0 )
+      e.throughput = average( e.throughput, e.weight, bytes_r / std::chrono::duration<double>( time_r ).count() );
+    e.weight = std::min( e.weight, maxWeight ) + 1;
+  }
+
+  bool MirrorStats::save()
+  {
+    if ( _file.empty() || _dirty.empty() )
+      return true;
+
+    if ( zypp::filesystem::assert_dir( _file.dirname() ) != 0 ) {
+      WAR << "Unable to create the directory for the mirror statistics " << _file << std::endl;
+      return false;
+    }
+
+    zypp::AutoFD fd( ::open( _file.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644 ) );
+    if ( fd == -1 ) {
+      WAR << "Unable to write mirror statistics to " << _file << ": " << zypp::str::strerror( errno ) << std::endl;
+      return false;
+    }
+    if ( ::flock( fd, LOCK_EX ) != 0 ) {
+      WAR << "Unable to lock mirror statistics " << _file << ": " << zypp::str::strerror( errno ) << std::endl;
+      return false;
+    }
+
+    // merge with what other processes wrote in the meantime, our own updates win
+    auto merged = parse( readAll( fd ) );
+    for ( const auto &key : _dirty )
+      merged[key] = _entries[key];
+
+    const auto now = std::time(nullptr);
+    std::ostringstream out;
+    out << "# zypp mirror statistics: key latency(ms) throughput(B/s) errorrate weight lastseen\n";
+    for ( const auto &[ key, e ] : merged ) {
+      if ( now - e.lastSeen > maxEntryAge )
+        continue;
+      out << key << ' ' << e.latency << ' ' << e.throughput << ' ' << e.errorRate << ' ' << e.weight << ' ' << e.lastSeen << '\n';
+    }
+
+    const auto &data = out.str();
+    const bool ok = ( ::lseek( fd, 0, SEEK_SET ) == 0 && ::ftruncate( fd, 0 ) == 0 && writeAll( fd, data ) );
+    const int err = errno;
+    ::flock( fd, LOCK_UN );
+    if ( !ok ) {
+      WAR << "Failed to write mirror statistics to " << _file << ": " << zypp::str::strerror( err ) << std::endl;
+      return false;
+    }
+
+    _entries = std::move(merged);
+    _dirty.clear();
+    return true;
+  }
+
+  MirrorStats::Entry MirrorStats::decayed( Entry entry_r, time_t now_r )
+  {
+    const auto age = std::max<time_t>( now_r - entry_r.lastSeen, 0 );
+    const auto factor = std::exp2( -double(age) / decayHalfLife );
+    entry_r.weight    *= factor;
+    entry_r.errorRate *= factor; // failures are forgiven over time
+    return entry_r;
+  }
+
+  MirrorStats::Entry &MirrorStats::touch( const std::string &key_r )
+  {
+    const auto now = std::time(nullptr);
+    auto &e = _entries[key_r];
+    e = decayed( e, now );
+    e.lastSeen = now;
+    _dirty.insert( key_r );
+    return e;
+  }
+
+}
@@ -26,6 +26,8 @@
 #include <zypp-curl/ng/network/networkrequesterror.h>
 #include <zypp-media/auth/CredentialManager>
 
+#include <chrono>
+
 namespace zyppng {
 
   class NetworkRequestDispatcher;
@@ -75,6 +77,19 @@ namespace zyppng {
       Url _originalUrl;  //< The unstripped URL as it was passed to Download , before transfer settings are removed
       MirrorControl::MirrorHandle _myMirror;
 
+      /*!
+       * The throughput of the mirror used by this request in bytes per second,
+       * measured over all transfers of this request. If nothing was downloaded yet, the throughput
+       * of the mirror known from previous runs is returned, or 0 if there is none.
+       */
+      double throughput () const;
+
+      std::chrono::steady_clock::time_point _transferStart;          //< when the current transfer was started
+      std::chrono::steady_clock::duration   _transferTime { 0 };      //< time spent in the finished transfers of this request
+      zypp::ByteCount                       _transferredBytes = 0;  //< bytes downloaded in the finished transfers of this request
+      std::weak_ptr<Request> _raceWith; //< the request downloading the same blocks, the first one to finish wins
+      bool _isRacer = false;            //< this request was started to race \ref _raceWith for its blocks
+
       connection _sigStartedConn;
       connection _sigProgressConn;
       connection _sigFinishedConn;
@@ -103,6 +118,7 @@ namespace zyppng {
     time_t _lastTriedAuthTime = 0; //< if initialized this shows the last timestamp that got from user code for a auth request
     bool _stopOnMetalink     = false; //< Stop the download if a metalink was received for external parsing
     bool _stoppedOnMetalink  = false; //< Statemachine was stopped after receiving a metalink file
+    zypp::CheckSum _fileChecksum;     //< Checksum of the downloaded file, calculated while downloading or when verifying it
     NetworkRequest::Priority _defaultSubRequestPriority = NetworkRequest::High;
 
     Signal< void ( Download &req )> _sigStarted;
@@ -117,6 +117,14 @@ namespace zyppng {
 
     if ( sm._spec.checkExistsOnly() )
       _request->setOptions( _request->options() | Request::HeadRequest );
+    else {
+      // The expected checksum is verified when the download is finished, the request just calculates it.
+      // This way a metalink file received instead of the data does not fail the request.
+      const auto &expSum = sm._spec.expectedFileChecksum();
+      const std::string &sumType = expSum ? expSum->type() : sm._spec.fileChecksumType();
+      if ( !sumType.empty() && !_request->setFileChecksumType( sumType ) )
+        WAR << "Unable to calculate a " << sumType << " checksum while downloading " << sm._spec.url() << std::endl;
+    }
 
     if ( !initializeRequest( _request ) ) {
       return failed( "Failed to initialize request" );
@@ -187,7 +195,7 @@ namespace zyppng {
     auto &sm = stateMachine();
 
     if ( _request->_myMirror )
-      _request->_myMirror->finishTransfer( !err.isError() );
+      _request->_myMirror->finishTransfer( !err.isError(), req );
 
     if ( req.hasError() ) {
       // if we get authentication failure we try to recover
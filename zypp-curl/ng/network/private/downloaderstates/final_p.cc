@@ -9,8 +9,13 @@
 
 #include <zypp-curl/ng/network/private/downloader_p.h>
 #include <zypp-curl/ng/network/private/mediadebug_p.h>
+#include <zypp-curl/ng/network/private/networkrequesterror_p.h>
+#include <zypp-core/base/String.h>
+#include <zypp-core/fs/PathInfo.h>
 #include "final_p.h"
 
+#include <fstream>
+
 namespace zyppng {
 
   FinishedState::FinishedState(NetworkRequestError &&error, DownloadPrivate &parent)
@@ -18,6 +23,32 @@ namespace zyppng {
     , _error( std::move(error) )
   {
     MIL << "About to enter FinishedState for url " << parent._spec.url() << std::endl;
+    if ( !_error.isError() )
+      verifyFileChecksum();
+  }
+
+  void FinishedState::verifyFileChecksum()
+  {
+    auto &sm = stateMachine();
+    const auto &expected = sm._spec.expectedFileChecksum();
+    if ( !expected || sm._spec.checkExistsOnly() || sm._stoppedOnMetalink )
+      return;
+
+    if ( sm._fileChecksum.type() != expected->type() ) {
+      // not calculated while downloading, e.g. for metalink and zchunk downloads
+      std::ifstream istr( sm._spec.targetPath().c_str() );
+      sm._fileChecksum = zypp::CheckSum( expected->type(), istr );
+    }
+
+    if ( sm._fileChecksum != *expected ) {
+      _error = NetworkRequestErrorPrivate::customError(
+            NetworkRequestError::InvalidChecksum
+            , (zypp::str::Format("Invalid file checksum %1%, expected checksum %2%")
+               % sm._fileChecksum.checksum()
+               % expected->checksum() ) );
+      sm._fileChecksum = zypp::CheckSum();
+      zypp::filesystem::unlink( sm._spec.targetPath() );
+    }
   }
 
 }
@@ -31,6 +31,12 @@ namespace zyppng {
     void exit (){}
 
     NetworkRequestError _error;
+
+  private:
+    /*!
+     * Fails the download if the target file does not match \ref DownloadSpec::expectedFileChecksum
+     */
+    void verifyFileChecksum ();
   };
 
 }
@@ -34,6 +34,9 @@ namespace zyppng {
   std::shared_ptr<FinishedState> DlMetaLinkInfoState::transitionToFinished()
   {
     MIL << "Downloading on " << stateMachine()._spec.url() << " transition to final state. " << std::endl;
+    // no metalink received, so the request downloaded the file itself
+    if ( _request && !_error.isError() && !stateMachine()._stoppedOnMetalink )
+      stateMachine()._fileChecksum = _request->fileChecksum();
     return std::make_shared<FinishedState>( std::move(_error), stateMachine() );
   }
 
@@ -28,6 +28,8 @@ namespace zyppng {
 
   std::shared_ptr<FinishedState> DlNormalFileState::transitionToFinished()
   {
+    if ( _request && !_error.isError() )
+      stateMachine()._fileChecksum = _request->fileChecksum();
     return std::make_shared<FinishedState>( std::move(_error), stateMachine() );
   }
 
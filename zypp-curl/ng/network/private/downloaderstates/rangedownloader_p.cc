@@ -16,15 +16,41 @@
 
 #include "rangedownloader_p.h"
 
+#include <limits>
+#include <set>
+
 namespace zyppng {
 
-  void RangeDownloaderBaseState::onRequestStarted( NetworkRequest & )
-  { }
+  namespace {
+    // a mirror should get about as much work as it can do in that time, so slow mirrors
+    // do not hold on to big parts of the file while the fast ones run out of work
+    constexpr double CHUNK_TARGET_SECONDS = 4.0;
+
+    // only race a request for its blocks if we expect to be that much faster, otherwise
+    // we just waste bandwidth
+    constexpr double RACE_MIN_SPEEDUP = 2.0;
+
+    // how long the current transfer of a request needs to run before we judge its speed
+    // and possibly race it, younger ones did not have the chance to show what they can do
+    constexpr std::chrono::seconds RACE_MIN_RUNTIME { 1 };
+  }
+
+  void RangeDownloaderBaseState::onRequestStarted( NetworkRequest &req )
+  {
+    auto it = std::find_if( _runningRequests.begin(), _runningRequests.end(), [ &req ]( const std::shared_ptr<Request> &r ) {
+      return ( r.get() == &req );
+    });
+    if ( it != _runningRequests.end() )
+      (*it)->_transferStart = std::chrono::steady_clock::now();
+  }
 
   void RangeDownloaderBaseState::onRequestProgress( NetworkRequest &, off_t , off_t, off_t , off_t  )
   {
     off_t dlnowMulti = _downloadedMultiByteCount;
     for( const auto &req : _runningRequests ) {
+      // a racer downloads blocks that are already accounted for in the request it competes with
+      if ( req->_isRacer )
+        continue;
       dlnowMulti += req->downloadedByteCount();
     }
 
@@ -48,16 +74,20 @@ namespace zyppng {
     //remove from running
     _runningRequests.erase( it );
 
+    reqLocked->_transferTime += std::chrono::steady_clock::now() - reqLocked->_transferStart;
+    reqLocked->_transferredBytes += req.downloadedByteCount();
+
     //feed the working URL back into the mirrors in case there are still running requests that might fail
     // @TODO , finishing the transfer might never be called in case of cancelling the request, need a better way to track running transfers
     if ( reqLocked->_myMirror )
-      reqLocked->_myMirror->finishTransfer( !err.isError() );
+      reqLocked->_myMirror->finishTransfer( !err.isError(), req );
 
     if ( err.isError() ) {
       return handleRequestError( reqLocked, err );
     }
 
-    _downloadedMultiByteCount += req.downloadedByteCount();
+    // if we raced another request for the same blocks we won, the other one can be cancelled
+    _downloadedMultiByteCount += finishRace( reqLocked );
     if ( !assertExpectedFilesize( _downloadedMultiByteCount ) ) {
       return;
     }
@@ -79,7 +109,7 @@ namespace zyppng {
     //check if we already have enqueued all blocks if not reuse the request
     if ( _ranges.size() ) {
       MIL  << req.nativeHandle() << " " << "Reusing to download blocks: "<<std::endl;
-      if ( !restartReqWithBlock( reqLocked, getNextBlocks( reqLocked->url().getScheme() ) ) ) {
+      if ( !restartReqWithBlock( reqLocked, getNextBlocks( reqLocked->url().getScheme(), reqLocked->throughput() ) ) ) {
         return setFailed( "Failed to restart request with new blocks." );
       }
       return;
@@ -88,7 +118,7 @@ namespace zyppng {
       //if we have failed blocks, try to download them with this mirror
       if ( !_failedRanges.empty() ) {
 
-        auto fblks = getNextFailedBlocks( reqLocked->url().getScheme() );
+        auto fblks = getNextFailedBlocks( reqLocked->url().getScheme(), reqLocked->throughput() );
         MIL  << req.nativeHandle() << " " << "Reusing to download failed blocks: "<<std::endl;
         if ( !restartReqWithBlock( reqLocked, std::move(fblks) ) ) {
           return setFailed( "Failed to restart request with previously failed blocks." );
@@ -97,6 +127,10 @@ namespace zyppng {
       }
     }
 
+    // all blocks are handed out, help the request that will take longest to finish
+    if ( raceSlowestRequest( reqLocked ) )
+      return;
+
     //feed the working URL back into the mirrors in case there are still running requests that might fail
     _fileMirrors.push_back( reqLocked->_originalUrl );
 
@@ -123,15 +157,26 @@ namespace zyppng {
 
       NetworkRequestError dummyErr;
 
+      // if we raced another request, it still downloads the blocks it did not finish yet
+      const auto partner = req->_raceWith.lock();
+      req->_raceWith.reset();
+      req->_isRacer = false;
+      if ( partner ) {
+        partner->_raceWith.reset();
+        partner->_isRacer = false;
+      }
+
       const auto &fRanges = req->failedRanges();
       try {
-        std::transform( fRanges.begin(), fRanges.end(), std::back_inserter(_failedRanges), [ &req ]( const auto &r ){
+        for ( const auto &r : fRanges ) {
+          if ( partner && willDownloadBlock( partner, r.start ) )
+            continue;
           Block b = std::any_cast<Block>(r.userData);;
           b._failedWithErr = req->error();
           if ( zypp::env::ZYPP_MEDIA_CURL_DEBUG() > 3 )
             DBG_MEDIA << "Adding failed block to failed blocklist: " << b.start << " " << b.len << " (" << req->error().toString() << " [" << req->error().nativeErrorString()<< "])" << std::endl;
-          return b;
-        });
+          _failedRanges.push_back( std::move(b) );
+        }
 
         // try to fill the open spot right away
         ensureDownloadsRunning();
@@ -195,6 +240,7 @@ namespace zyppng {
 
     // check if we are done at this point
     if ( _runningRequests.empty() ) {
+      dropIdleRequests();
 
       if ( _failedRanges.size() || _ranges.size() ) {
         setFailed( NetworkRequestErrorPrivate::customError( NetworkRequestError::InternalError, "Unable to download all blocks." ) );
@@ -354,6 +400,7 @@ namespace zyppng {
 
   void RangeDownloaderBaseState::cancelAll(const NetworkRequestError &err)
   {
+    dropIdleRequests();
     while( _runningRequests.size() ) {
       auto req = _runningRequests.back();
       req->disconnectSignals();
@@ -364,10 +411,23 @@ namespace zyppng {
     }
   }
 
-  std::vector<RangeDownloaderBaseState::Block> RangeDownloaderBaseState::getNextBlocks( const std::string &urlScheme )
+  /**
+   * The amount of data to hand out to a mirror at once. Mirrors we know the \a throughput of
+   * get about as much as they can download in \ref CHUNK_TARGET_SECONDS.
+   */
+  zypp::ByteCount RangeDownloaderBaseState::chunkSizeFor( double throughput ) const
   {
-    std::vector<Block> blocks;
     const auto prefSize = std::max<zypp::ByteCount>( _preferredChunkSize, zypp::ByteCount(4, zypp::ByteCount::K) );
+    if ( throughput <= 0 )
+      return prefSize;
+    const auto minSize = zypp::ByteCount(4, zypp::ByteCount::K);
+    return zypp::ByteCount( std::clamp<zypp::ByteCount::SizeType>( throughput * CHUNK_TARGET_SECONDS, minSize, prefSize * 4 ) );
+  }
+
+  std::vector<RangeDownloaderBaseState::Block> RangeDownloaderBaseState::getNextBlocks( const std::string &urlScheme, double throughput )
+  {
+    std::vector<Block> blocks;
+    const auto prefSize = chunkSizeFor( throughput );
     size_t accumulatedSize = 0;
 
     bool canDoRandomBlocks = ( zypp::str::hasPrefixCI( urlScheme, "http") );
@@ -392,9 +452,9 @@ namespace zyppng {
     return blocks;
   }
 
-  std::vector<RangeDownloaderBaseState::Block> RangeDownloaderBaseState::getNextFailedBlocks( const std::string &urlScheme )
+  std::vector<RangeDownloaderBaseState::Block> RangeDownloaderBaseState::getNextFailedBlocks( const std::string &urlScheme, double throughput )
   {
-    const auto prefSize = std::max<zypp::ByteCount>( _preferredChunkSize, zypp::ByteCount(4, zypp::ByteCount::K) );
+    const auto prefSize = chunkSizeFor( throughput );
     // sort the failed requests by block number, this should make sure get them in offset order as well
     _failedRanges.sort( []( const auto &a , const auto &b ){ return a.start < b.start; } );
 
@@ -428,6 +488,198 @@ namespace zyppng {
     return fblks;
   }
 
+  /**
+   * Called when \a req finished and there are no more blocks to hand out. Like \ref multifetchworker::stealjob
+   * in the legacy backend, we look for the running request that needs most time to finish its blocks and,
+   * if the mirror of \a req is clearly faster, download the unfinished blocks with \a req as well.
+   * The first one to finish wins and cancels the other, see \ref finishRace.
+   * Only requests whose current transfer runs for at least \ref RACE_MIN_RUNTIME are raced. If there are
+   * younger ones, \a req waits until they are old enough, see \ref waitForRace. Returns whether \a req
+   * races or waits.
+   */
+  bool RangeDownloaderBaseState::raceSlowestRequest( const std::shared_ptr<Request> &req )
+  {
+    const auto myThroughput = req->throughput();
+    if ( myThroughput <= 0 )
+      return false;
+
+    const auto now = std::chrono::steady_clock::now();
+    std::shared_ptr<Request> victim;
+    double victimEta = 0;
+    auto waitFor = std::chrono::steady_clock::duration::max();
+    for ( const auto &other : _runningRequests ) {
+      if ( other == req || other->_raceWith.lock() )
+        continue; // already racing
+
+      // still waiting for a connection, racing it would just queue up another one
+      if ( other->state() != NetworkRequest::Running )
+        continue;
+
+      size_t remaining = 0;
+      for ( const auto &r : other->requestedRanges() ) {
+        if ( r._rangeState != CurlMultiPartHandler::Finished )
+          remaining += r.len - std::min( r.len, r.bytesWritten );
+      }
+      if ( !remaining )
+        continue;
+
+      // just started, give it a chance but look again once it ran long enough
+      const auto runtime = now - other->_transferStart;
+      if ( runtime < RACE_MIN_RUNTIME ) {
+        waitFor = std::min<std::chrono::steady_clock::duration>( waitFor, RACE_MIN_RUNTIME - runtime );
+        continue;
+      }
+
+      const auto otherThroughput = other->throughput();
+      const double eta = otherThroughput > 0 ? remaining / otherThroughput : std::numeric_limits<double>::max(); // stalled
+
+      if ( !victim || eta > victimEta ) {
+        victim = other;
+        victimEta = eta;
+      }
+    }
+    if ( !victim ) {
+      if ( waitFor == std::chrono::steady_clock::duration::max() )
+        return false;
+      waitForRace( req, waitFor );
+      return true;
+    }
+
+    // we need to download the unfinished blocks completely
+    std::vector<Block> blocks;
+    size_t blocksLen = 0;
+    for ( const auto &r : victim->requestedRanges() ) {
+      if ( r._rangeState == CurlMultiPartHandler::Finished )
+        continue;
+      blocks.push_back( std::any_cast<Block>( r.userData ) );
+      blocksLen += r.len;
+    }
+
+    // only http mirrors support random request ranges
+    if ( !zypp::str::hasPrefixCI( req->url().getScheme(), "http" ) ) {
+      for ( size_t i = 1; i < blocks.size(); i++ ) {
+        if ( blocks[i].start != blocks[i-1].start + off_t(blocks[i-1].len) )
+          return false;
+      }
+    }
+
+    const double myEta = blocksLen / myThroughput;
+    if ( myEta * RACE_MIN_SPEEDUP > victimEta ) {
+      if ( waitFor == std::chrono::steady_clock::duration::max() )
+        return false;
+      // not worth it, but one of the younger requests might be
+      waitForRace( req, waitFor );
+      return true;
+    }
+
+    MIL << req->nativeHandle() << " " << "Racing " << victim->nativeHandle() << " for " << blocks.size() << " blocks (" << zypp::ByteCount(blocksLen)
+        << "), expected to finish in " << myEta << "s instead of " << victimEta << "s." << std::endl;
+
+    if ( !addBlockRanges( req, blocks ) )
+      return false;
+
+    req->_raceWith = victim;
+    req->_isRacer  = true;
+    victim->_raceWith = req;
+
+    //this is not a new request, only add to queues but do not connect signals again
+    addNewRequest( req, false );
+    return true;
+  }
+
+  /**
+   * Keeps the finished request \a req around and calls \ref raceSlowestRequest for it again after \a delay,
+   * when the running requests that were too young to be raced ran long enough.
+   */
+  void RangeDownloaderBaseState::waitForRace( const std::shared_ptr<Request> &req, std::chrono::steady_clock::duration delay )
+  {
+    if ( !_raceTimer ) {
+      _raceTimer = Timer::create();
+      _raceTimer->setSingleShot( true );
+      _raceTimer->connectFunc( &Timer::sigExpired, [this]( Timer &t ){ onRaceTimerExpired( t ); } );
+    }
+
+    MIL << req->nativeHandle() << " " << "Waiting for running requests to be raced." << std::endl;
+    _idleRequests.push_back( req );
+
+    const uint64_t ms = std::chrono::ceil<std::chrono::milliseconds>( delay ).count();
+    if ( !_raceTimer->isRunning() || _raceTimer->remaining() > ms )
+      _raceTimer->start( ms );
+  }
+
+  void RangeDownloaderBaseState::onRaceTimerExpired( Timer & )
+  {
+    auto idle = std::move( _idleRequests );
+    _idleRequests.clear();
+    for ( const auto &req : idle ) {
+      if ( raceSlowestRequest( req ) )
+        continue;
+      //feed the working URL back into the mirrors in case there are still running requests that might fail
+      _fileMirrors.push_back( req->_originalUrl );
+    }
+    ensureDownloadsRunning();
+  }
+
+  void RangeDownloaderBaseState::dropIdleRequests()
+  {
+    if ( _raceTimer )
+      _raceTimer->stop();
+    _idleRequests.clear();
+  }
+
+  /**
+   * Called when \a winner finished successfully. If it raced another request for the same blocks
+   * the other one is cancelled. Returns the number of bytes the download advanced by.
+   */
+  zypp::ByteCount RangeDownloaderBaseState::finishRace( const std::shared_ptr<Request> &winner )
+  {
+    zypp::ByteCount bytes = winner->downloadedByteCount();
+
+    const auto loser = winner->_raceWith.lock();
+    if ( loser ) {
+      auto it = std::find( _runningRequests.begin(), _runningRequests.end(), loser );
+      if ( it != _runningRequests.end() ) {
+        MIL << winner->nativeHandle() << " " << "Won the race against " << loser->nativeHandle() << ", cancelling it." << std::endl;
+
+        if ( winner->_isRacer ) {
+          // the blocks the loser finished before the race started are not part of the winner's bytes
+          std::set<size_t> won;
+          for ( const auto &r : winner->requestedRanges() )
+            won.insert( r.start );
+          for ( const auto &r : loser->requestedRanges() ) {
+            if ( r._rangeState == CurlMultiPartHandler::Finished && !won.count( r.start ) )
+              bytes += r.len;
+          }
+        }
+
+        _runningRequests.erase( it );
+        loser->disconnectSignals();
+        stateMachine()._requestDispatcher->cancel( *loser, NetworkRequestErrorPrivate::customError( NetworkRequestError::Cancelled, "Another mirror was faster." ) );
+        if ( loser->_myMirror )
+          loser->_myMirror->cancelTransfer();
+      }
+      loser->_raceWith.reset();
+      loser->_isRacer = false;
+    }
+    winner->_raceWith.reset();
+    winner->_isRacer = false;
+    return bytes;
+  }
+
+  /**
+   * Whether the running request \a req has the block starting at \a start still to download,
+   * so it will (re)write its data.
+   */
+  bool RangeDownloaderBaseState::willDownloadBlock( const std::shared_ptr<Request> &req, size_t start ) const
+  {
+    if ( std::find( _runningRequests.begin(), _runningRequests.end(), req ) == _runningRequests.end() )
+      return false;
+    const auto &rngs = req->requestedRanges();
+    return std::any_of( rngs.begin(), rngs.end(), [&]( const auto &r ) {
+      return r.start == start && ( r._rangeState == CurlMultiPartHandler::Pending || r._rangeState == CurlMultiPartHandler::Running );
+    });
+  }
+
   zypp::ByteCount RangeDownloaderBaseState::makeBlksize ( size_t filesize )
   {
     // this case should never happen because we never start a multi download if we do not know the filesize beforehand
@@ -17,6 +17,7 @@
 #include "base_p.h"
 #include "mirrorhandling_p.h"
 #include <zypp-core/zyppng/base/statemachine.h>
+#include <zypp-core/zyppng/base/Timer>
 
 namespace zyppng {
 
@@ -72,6 +73,10 @@ namespace zyppng {
 
     std::vector< std::shared_ptr<Request> > _runningRequests;
 
+    //finished requests waiting for a running request to be old enough to be raced, see \ref raceSlowestRequest
+    std::vector< std::shared_ptr<Request> > _idleRequests;
+    Timer::Ptr _raceTimer;
+
     // we only define the signals here and add the accessor functions in the subclasses, static casting of
     // the class type is not allowed at compile time, so they would not be useable in the transition table otherwise
     Signal< void () > _sigFinished;
@@ -83,8 +88,16 @@ namespace zyppng {
     void addNewRequest     (const std::shared_ptr<Request>& req, const bool connectSignals = true );
     bool assertExpectedFilesize ( off_t currentFilesize );
 
-    std::vector<Block> getNextBlocks ( const std::string &urlScheme );
-    std::vector<Block> getNextFailedBlocks( const std::string &urlScheme );
+    zypp::ByteCount chunkSizeFor ( double throughput ) const;
+    std::vector<Block> getNextBlocks ( const std::string &urlScheme, double throughput = 0 );
+    std::vector<Block> getNextFailedBlocks( const std::string &urlScheme, double throughput = 0 );
+
+    bool raceSlowestRequest ( const std::shared_ptr<Request> &req );
+    void waitForRace ( const std::shared_ptr<Request> &req, std::chrono::steady_clock::duration delay );
+    void onRaceTimerExpired ( Timer & );
+    void dropIdleRequests ();
+    zypp::ByteCount finishRace ( const std::shared_ptr<Request> &winner );
+    bool willDownloadBlock ( const std::shared_ptr<Request> &req, size_t start ) const;
   };
 
 
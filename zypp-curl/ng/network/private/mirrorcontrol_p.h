@@ -21,11 +21,14 @@
 #include <zypp-curl/ng/network/networkrequestdispatcher.h>
 #include <zypp-curl/ng/network/request.h>
 #include <zypp-curl/parser/MetaLinkParser>
+#include <memory>
 #include <vector>
 #include <unordered_map>
 
 namespace zyppng {
 
+  class MirrorStats;
+
   class MirrorControl : public Base {
 
   public:
@@ -40,9 +43,15 @@ namespace zyppng {
       uint runningTransfers    = 0; //currently running transfers
       uint failedTransfers     = 0; //how many transfers have failed in a row using this mirror
       uint successfulTransfers = 0; //how many transfers were successful
+      double throughput        = 0; //transfer speed in bytes per second seen in previous runs, 0 if unknown
 
       void startTransfer();
       void finishTransfer( const bool success );
+      /*!
+       * Same as \ref finishTransfer( const bool ), additionally feeds the
+       * timings and transferred bytes of \a req into the mirror statistics.
+       */
+      void finishTransfer( const bool success, const NetworkRequest &req );
       void cancelTransfer();
       uint maxConnections () const;
       bool hasFreeConnections () const;
@@ -54,6 +63,7 @@ namespace zyppng {
     private:
       friend class MirrorControl;
       MirrorControl &_parent;
+      std::string _key;
       NetworkRequest::Ptr _request;
       sigc::connection _finishedConn;
 
@@ -90,6 +100,7 @@ namespace zyppng {
     MirrorControl();
     std::string makeKey ( const zypp::Url &url ) const;
     sigc::connection _queueEmptyConn;
+    std::unique_ptr<MirrorStats> _stats; //persistent statistics, used to rank mirrors we have seen in previous runs without probing them
     NetworkRequestDispatcher::Ptr _dispatcher; //Mirror Control using its own NetworkRequestDispatcher, to avoid waiting for other downloads
     std::unordered_map<std::string, MirrorHandle> _handles;
 
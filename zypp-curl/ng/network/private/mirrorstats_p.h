@@ -0,0 +1,105 @@
+/*---------------------------------------------------------------------\
+|                          ____ _   __ __ ___                          |
+|                         |__  / \ / / . \ . \                         |
+|                           / / \ V /|  _/  _/                         |
+|                          / /__ | | | | | |                           |
+|                         /_____||_| |_| |_|                           |
+|                                                                      |
+----------------------------------------------------------------------/
+*
+* This file contains private API, this might break at any time between releases.
+* You have been warned!
+*
+*/
+#ifndef ZYPP_CURL_NG_NETWORK_PRIVATE_MIRRORSTATS_P_H
+#define ZYPP_CURL_NG_NETWORK_PRIVATE_MIRRORSTATS_P_H
+
+#include <zypp-core/Pathname.h>
+#include <zypp-core/ByteCount.h>
+#include <chrono>
+#include <ctime>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace zyppng {
+
+  /*!
+   * Persistent per mirror performance statistics, used by \ref MirrorControl
+   * to rank mirrors without having to probe all of them again in every process.
+   *
+   * The statistics are kept in a simple text file, one mirror per line:
+   * \code
+   * <key> <latency ms> <throughput bytes/s> <error rate> <weight> <last seen>
+   * \endcode
+   *
+   * All values are moving averages. Their weight decays with the age of the
+   * entry, so old measurements are quickly replaced by new ones and mirrors
+   * that were not seen for a long time are dropped.
+   *
+   * The file is locked while it is read or written, values of mirrors that were
+   * not touched by this process are merged in on \ref save, so several processes
+   * can share the file.
+   */
+  class MirrorStats
+  {
+  public:
+    struct Entry {
+      double latency    = -1;  //< connect time in ms, negative if unknown
+      double throughput = -1;  //< transfer speed in bytes per second, negative if unknown
+      double errorRate  = 0;   //< ratio of failed transfers, 0 ... 1
+      double weight     = 0;   //< number of samples the values are based on, decays with age
+      time_t lastSeen   = 0;   //< when the mirror was used the last time
+
+      /*!
+       * Returns true if the entry is recent enough to rank the mirror
+       * without probing it again.
+       */
+      bool isWarm ( time_t now = std::time(nullptr) ) const;
+    };
+
+    /*!
+     * Creates the store and loads \a file_r if it exists. An empty
+     * \a file_r creates a store that is not persisted.
+     */
+    MirrorStats( zypp::Pathname file_r );
+    ~MirrorStats();
+
+    MirrorStats( const MirrorStats & ) = delete;
+    MirrorStats &operator= ( const MirrorStats & ) = delete;
+
+    const zypp::Pathname &file () const { return _file; }
+
+    std::optional<Entry> find ( const std::string &key_r ) const;
+
+    /*! Remember a connect time measurement for the mirror \a key_r */
+    void addLatency ( const std::string &key_r, std::chrono::milliseconds latency_r );
+
+    /*!
+     * Remember the outcome of a transfer from mirror \a key_r. The throughput is only
+     * updated for successful transfers with a reasonable amount of data.
+     */
+    void addTransfer ( const std::string &key_r, bool success_r, zypp::ByteCount bytes_r = 0, std::chrono::milliseconds time_r = std::chrono::milliseconds(0) );
+
+    /*!
+     * Writes all entries changed by this process back to \ref file.
+     * Does nothing if there are no changes.
+     */
+    bool save ();
+
+    /*! Returns \a entry_r with the decay for its age applied */
+    static Entry decayed ( Entry entry_r, time_t now_r );
+
+  private:
+    Entry &touch ( const std::string &key_r );
+
+  private:
+    zypp::Pathname _file;
+    std::unordered_map<std::string, Entry> _entries;
+    std::unordered_set<std::string> _dirty;
+  };
+
+}
+
+#endif // ZYPP_CURL_NG_NETWORK_PRIVATE_MIRRORSTATS_P_H
@@ -112,7 +112,7 @@ namespace zyppng {
 
     struct FileVerifyInfo {
       zypp::Digest _fileDigest;
-      zypp::CheckSum _fileChecksum;
+      zypp::CheckSum _fileChecksum; ///< The expected checksum, if empty the checksum is just calculated
     };
     std::optional<FileVerifyInfo>       _fileVerification; ///< The digest for the full file
 
@@ -183,6 +183,7 @@ namespace zyppng {
       off_t               _downloaded = 0; //downloaded bytes
       zypp::ByteCount     _contentLenght = 0; // the content length as reported by the server
       NetworkRequestError _result; // the overall result of the download
+      zypp::CheckSum      _fileChecksum; // the checksum calculated for the full file
     };
 
     std::variant< pending_t, running_t, prepareNextRangeBatch_t, finished_t > _runningMode = pending_t();
@@ -510,7 +510,7 @@ namespace zyppng {
             } else {
               constexpr size_t bufSize = 4096;
               char buf[bufSize];
-              while( auto cnt = fread(buf, 1, bufSize, rmode._outFile ) > 0 ) {
+              for ( size_t cnt = 0; ( cnt = fread(buf, 1, bufSize, rmode._outFile ) ) > 0; ) {
                 _fileVerification->_fileDigest.update(buf, cnt);
               }
             }
@@ -521,13 +521,19 @@ namespace zyppng {
       // finally check the file digest if we have one
       if ( _fileVerification && resState._result.type() == NetworkRequestError::NoError ) {
         const UByteArray &calcSum = _fileVerification->_fileDigest.digestVector ();
-        const UByteArray &expSum  = zypp::Digest::hexStringToUByteArray( _fileVerification->_fileChecksum.checksum () );
-        if ( calcSum != expSum  ) {
-             resState._result = NetworkRequestErrorPrivate::customError(
-                   NetworkRequestError::InvalidChecksum
-                   , (zypp::str::Format("Invalid file checksum %1%, expected checksum %2%")
-                      % _fileVerification->_fileDigest.digest()
-                      % _fileVerification->_fileChecksum.checksum () ) );
+        if ( _fileVerification->_fileChecksum.empty() ) {
+          resState._fileChecksum = zypp::CheckSum( _fileVerification->_fileDigest.name(), zypp::Digest::digestVectorToString( calcSum ) );
+        } else {
+          const UByteArray &expSum  = zypp::Digest::hexStringToUByteArray( _fileVerification->_fileChecksum.checksum () );
+          if ( calcSum != expSum  ) {
+               resState._result = NetworkRequestErrorPrivate::customError(
+                     NetworkRequestError::InvalidChecksum
+                     , (zypp::str::Format("Invalid file checksum %1%, expected checksum %2%")
+                        % _fileVerification->_fileDigest.digest()
+                        % _fileVerification->_fileChecksum.checksum () ) );
+          } else {
+            resState._fileChecksum = _fileVerification->_fileChecksum;
+          }
         }
       }
 
@@ -818,6 +824,35 @@ namespace zyppng {
     return true;
   }
 
+  bool NetworkRequest::setFileChecksumType( const std::string &type )
+  {
+    Z_D();
+    if ( state() == Running )
+      return false;
+
+    // an expected checksum of the same type gets us the checksum as well
+    if ( d->_fileVerification && d->_fileVerification->_fileChecksum.type() == zypp::str::toLower( type ) )
+      return true;
+
+    zypp::Digest fDig;
+    if ( !fDig.create( type ) )
+      return false;
+
+    d->_fileVerification = NetworkRequestPrivate::FileVerifyInfo{
+        ._fileDigest   = std::move(fDig),
+        ._fileChecksum = zypp::CheckSum()
+    };
+    return true;
+  }
+
+  zypp::CheckSum NetworkRequest::fileChecksum() const
+  {
+    const auto s = std::get_if<NetworkRequestPrivate::finished_t>( &d_func()->_runningMode );
+    if ( !s || s->_result.isError() )
+      return zypp::CheckSum();
+    return s->_fileChecksum;
+  }
+
   void NetworkRequest::resetRequestRanges()
   {
     Z_D();
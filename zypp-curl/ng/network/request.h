@@ -137,6 +137,20 @@ namespace zyppng {
      */
     bool setExpectedFileChecksum( const zypp::CheckSum &expected );
 
+    /*!
+     * Calculate a checksum of type \a type for the full file while the data
+     * arrives, without verifying it. The result is available via \ref fileChecksum.
+     * \note This will not change a running download
+     */
+    bool setFileChecksumType( const std::string &type );
+
+    /*!
+     * Returns the checksum of the downloaded file calculated while downloading,
+     * if one was requested via \ref setExpectedFileChecksum or \ref setFileChecksumType.
+     * The checksum is only available if the request finished successfully.
+     */
+    zypp::CheckSum fileChecksum() const;
+
     /*!
      * Clears all requested ranges, the next download will get the complete file
      * \note This will not change a running download
@@ -109,11 +109,20 @@
 #include <vector>
 #include <iostream>
 #include <fstream>
+#include <algorithm>
+#include <limits>
+#include <thread>
+
+#if defined(__GNUC__) && ( defined(__x86_64__) || defined(__i386__) )
+#define RSUM_SIMD_X86 1
+#include <immintrin.h>
+#endif
 
 #include <zypp-core/base/Logger.h>
 #include <zypp-core/base/String.h>
 #include <zypp-core/AutoDispose.h>
 #include <zypp-core/base/Exception.h>
+#include <zypp-core/fs/PathInfo.h>
 
 using namespace zypp::base;
 
@@ -167,6 +176,151 @@ namespace zypp {
         }
       }
 
+      static_assert( sizeof(rsum) == 4, "rsum is stored as two interleaved 16bit values" );
+
+      /**
+       * Calculate the rsums of the \a n windows of \a blksize bytes starting at \a data + 0 ... \a data + n-1
+       * by rolling \a start ( the rsum of the window at \a data ) forward byte by byte. The results are stored
+       * in \a out. \a data must provide at least n-1 + blksize bytes.
+       */
+      void rollRsumsScalar( const unsigned char *data, size_t blksize, int bshift, rsum start, size_t n, rsum *out )
+      {
+        if ( !n )
+          return;
+        out[0] = start;
+        for ( size_t j = 1; j < n; j++ ) {
+          u_char oldC = data[j-1];
+          u_char newC = data[j-1+blksize];
+          UPDATE_RSUM( start.a, start.b, oldC, newC, bshift );
+          out[j] = start;
+        }
+      }
+
+#ifdef RSUM_SIMD_X86
+      /*
+       * The vectorized kernels roll the checksum forward over 8 ( SSE2 ) or 16 ( AVX2 ) bytes at once.
+       * Written out for the window at offset j+t+1, UPDATE_RSUM gives:
+       *   a(j+t+1) = a(j) + sum_{s=0..t} ( new_s - old_s )
+       *   b(j+t+1) = b(j) + sum_{s=0..t} ( a(j+s+1) - (old_s << bshift) )
+       * so both parts are an inclusive prefix sum over the 16bit lanes. Since all arithmetic
+       * is modulo 2^16 the results are bit identical to the scalar version.
+       */
+
+      __attribute__((target("sse2")))
+      inline __m128i prefixSumSSE2( __m128i x )
+      {
+        x = _mm_add_epi16( x, _mm_slli_si128( x, 2 ) );
+        x = _mm_add_epi16( x, _mm_slli_si128( x, 4 ) );
+        x = _mm_add_epi16( x, _mm_slli_si128( x, 8 ) );
+        return x;
+      }
+
+      /** Broadcast the last 16bit lane. */
+      __attribute__((target("sse2")))
+      inline __m128i broadcastLastSSE2( __m128i x )
+      { return _mm_shuffle_epi32( _mm_shufflehi_epi16( x, 0xFF ), 0xFF ); }
+
+      __attribute__((target("sse2")))
+      void rollRsumsSSE2( const unsigned char *data, size_t blksize, int bshift, rsum start, size_t n, rsum *out )
+      {
+        if ( !n )
+          return;
+        out[0] = start;
+
+        const __m128i zero  = _mm_setzero_si128();
+        const __m128i shift = _mm_cvtsi32_si128( bshift );
+        __m128i a = _mm_set1_epi16( start.a );
+        __m128i b = _mm_set1_epi16( start.b );
+
+        size_t j = 0; // offset of the last window we have the rsum for
+        for ( ; j + 8 < n; j += 8 ) {
+          const __m128i oldC = _mm_unpacklo_epi8( _mm_loadl_epi64( reinterpret_cast<const __m128i *>( data + j ) ), zero );
+          const __m128i newC = _mm_unpacklo_epi8( _mm_loadl_epi64( reinterpret_cast<const __m128i *>( data + j + blksize ) ), zero );
+          a = _mm_add_epi16( a, prefixSumSSE2( _mm_sub_epi16( newC, oldC ) ) );
+          b = _mm_add_epi16( b, prefixSumSSE2( _mm_sub_epi16( a, _mm_sll_epi16( oldC, shift ) ) ) );
+          _mm_storeu_si128( reinterpret_cast<__m128i *>( out + j + 1 ), _mm_unpacklo_epi16( a, b ) );
+          _mm_storeu_si128( reinterpret_cast<__m128i *>( out + j + 5 ), _mm_unpackhi_epi16( a, b ) );
+          a = broadcastLastSSE2( a );
+          b = broadcastLastSSE2( b );
+        }
+        rollRsumsScalar( data + j, blksize, bshift, out[j], n - j, out + j );
+      }
+
+      __attribute__((target("avx2")))
+      inline __m256i prefixSumAVX2( __m256i x )
+      {
+        // the byte shifts work on each 128bit half...
+        x = _mm256_add_epi16( x, _mm256_slli_si256( x, 2 ) );
+        x = _mm256_add_epi16( x, _mm256_slli_si256( x, 4 ) );
+        x = _mm256_add_epi16( x, _mm256_slli_si256( x, 8 ) );
+        // ...so the sum of the lower half needs to be carried into the upper one
+        const __m256i carry = _mm256_shuffle_epi32( _mm256_shufflehi_epi16( x, 0xFF ), 0xFF );
+        return _mm256_add_epi16( x, _mm256_permute2x128_si256( carry, carry, 0x08 ) );
+      }
+
+      /** Broadcast the last 16bit lane. */
+      __attribute__((target("avx2")))
+      inline __m256i broadcastLastAVX2( __m256i x )
+      {
+        const __m256i last = _mm256_shuffle_epi32( _mm256_shufflehi_epi16( x, 0xFF ), 0xFF );
+        return _mm256_permute2x128_si256( last, last, 0x11 );
+      }
+
+      __attribute__((target("avx2")))
+      void rollRsumsAVX2( const unsigned char *data, size_t blksize, int bshift, rsum start, size_t n, rsum *out )
+      {
+        if ( !n )
+          return;
+        out[0] = start;
+
+        const __m128i shift = _mm_cvtsi32_si128( bshift );
+        __m256i a = _mm256_set1_epi16( start.a );
+        __m256i b = _mm256_set1_epi16( start.b );
+
+        size_t j = 0; // offset of the last window we have the rsum for
+        for ( ; j + 16 < n; j += 16 ) {
+          const __m256i oldC = _mm256_cvtepu8_epi16( _mm_loadu_si128( reinterpret_cast<const __m128i *>( data + j ) ) );
+          const __m256i newC = _mm256_cvtepu8_epi16( _mm_loadu_si128( reinterpret_cast<const __m128i *>( data + j + blksize ) ) );
+          a = _mm256_add_epi16( a, prefixSumAVX2( _mm256_sub_epi16( newC, oldC ) ) );
+          b = _mm256_add_epi16( b, prefixSumAVX2( _mm256_sub_epi16( a, _mm256_sll_epi16( oldC, shift ) ) ) );
+          // unpack works on each 128bit half, so lo holds the rsums 0-3,8-11 and hi 4-7,12-15
+          const __m256i lo = _mm256_unpacklo_epi16( a, b );
+          const __m256i hi = _mm256_unpackhi_epi16( a, b );
+          _mm256_storeu_si256( reinterpret_cast<__m256i *>( out + j + 1 ), _mm256_permute2x128_si256( lo, hi, 0x20 ) );
+          _mm256_storeu_si256( reinterpret_cast<__m256i *>( out + j + 9 ), _mm256_permute2x128_si256( lo, hi, 0x31 ) );
+          a = broadcastLastAVX2( a );
+          b = broadcastLastAVX2( b );
+        }
+        rollRsumsScalar( data + j, blksize, bshift, out[j], n - j, out + j );
+      }
+#endif
+
+      using RollRsumsFnc = void (*)( const unsigned char *, size_t, int, rsum, size_t, rsum * );
+
+      using RollRsumsKernel = std::pair<RollRsumsFnc, const char *>;
+
+      /** The rsum kernels supported by the CPU we are running on, the best one first, detected once. */
+      const std::vector<RollRsumsKernel> & rollRsumsKernels()
+      {
+        static const std::vector<RollRsumsKernel> kernels = []() {
+          std::vector<RollRsumsKernel> ret;
+#ifdef RSUM_SIMD_X86
+          __builtin_cpu_init();
+          if ( __builtin_cpu_supports( "avx2" ) )
+            ret.push_back( { &rollRsumsAVX2, "avx2" } );
+          if ( __builtin_cpu_supports( "sse2" ) )
+            ret.push_back( { &rollRsumsSSE2, "sse2" } );
+#endif
+          ret.push_back( { &rollRsumsScalar, "scalar" } );
+          return ret;
+        }();
+        return kernels;
+      }
+
+      /** The best rsum kernel supported by the CPU we are running on. */
+      inline const RollRsumsKernel & rollRsumsKernel()
+      { return rollRsumsKernels().front(); }
+
     }
 
 MediaBlockList::MediaBlockList(off_t size)
@@ -176,7 +330,9 @@ MediaBlockList::MediaBlockList(off_t size)
   chksumpad(0),
   rsumlen(0),
   rsumseq(0),
-  rsumpad(0)
+  rsumpad(0),
+  rsumbatching(true),
+  reusethreads(0)
 { }
 
 size_t
@@ -339,6 +495,56 @@ MediaBlockList::checkRsum(size_t blkno, const unsigned char *buf, size_t bufl) c
   return verifyRsum(blkno, rs);
 }
 
+unsigned
+MediaBlockList::reuseThreadsFor(off_t deltasize) const
+{
+  if ( reusethreads )
+    return reusethreads;
+  // scanning a small file is faster than starting threads
+  constexpr off_t MIN_THREAD_SCAN_SIZE = 16 * 1024 * 1024;
+  const off_t maxThreads = std::min( std::max( std::thread::hardware_concurrency(), 1U ), 8U );
+  return std::max<off_t>( std::min( maxThreads, deltasize / MIN_THREAD_SCAN_SIZE ), 1 );
+}
+
+std::string
+MediaBlockList::rsumKernelName()
+{
+  return rollRsumsKernel().second;
+}
+
+std::vector<std::string>
+MediaBlockList::rsumKernelNames()
+{
+  std::vector<std::string> ret;
+  for ( const auto &kernel : rollRsumsKernels() )
+    ret.push_back( kernel.second );
+  return ret;
+}
+
+std::vector<unsigned int>
+MediaBlockList::rollRsums(const std::string &kernel, const unsigned char *data, size_t blksize, size_t n)
+{
+  const auto &kernels = rollRsumsKernels();
+  const auto it = std::find_if( kernels.begin(), kernels.end(), [&]( const auto &k ) { return kernel == k.second; } );
+  if ( it == kernels.end() || !n )
+    return {};
+
+  // same as reuseBlocks: shift only if the blksize is a power of 2
+  int bshift = 0;
+  if ((blksize & (blksize - 1)) == 0)
+    for (bshift = 0; size_t(1 << bshift) != blksize; bshift++)
+      ;
+
+  std::vector<rsum> rsums( n );
+  it->first( data, blksize, bshift, rcksum_calc_rsum_block( data, blksize ), n, rsums.data() );
+
+  std::vector<unsigned int> ret;
+  ret.reserve( n );
+  for ( const auto &rs : rsums )
+    ret.push_back( (rs.a & 65535) << 16 | (rs.b & 65535) );
+  return ret;
+}
+
 bool
 MediaBlockList::checkChecksum(size_t blkno, const unsigned char *buf, size_t bufl) const
 {
@@ -453,8 +659,37 @@ void MediaBlockList::reuseBlocks(FILE *wfp, const std::string& filename)
 
   size_t nblks = blocks.size();
   std::vector<bool> found( nblks + 1 );
+  const auto threads = reuseThreadsFor( PathInfo( filename ).size() );
+  if ( threads > 1 ) {
+    // make sure the digest backend is initialized before we spawn threads
+    Digest dig;
+    createDigest( dig );
+  }
+
+  // merges the blocks found by the worker threads, the first match of each block in the file wins
+  struct DeltaMatch {
+    size_t blkno;
+    off_t  off; //< offset of the block data in the delta file
+  };
+  const auto &writeDeltaMatches = [&]( const std::vector<std::vector<DeltaMatch>> &matches, size_t bufl ) {
+    auto buf = std::make_unique<unsigned char[]>( bufl );
+    for ( const auto &threadMatches : matches ) {
+      for ( const auto &m : threadMatches ) {
+        if ( found[m.blkno] || fseeko( fp, m.off, SEEK_SET ) )
+          continue;
+        // the last block may have matched the zero padded end of the file
+        const size_t l = fread( buf.get(), 1, bufl, fp );
+        memset( buf.get() + l, 0, bufl - l );
+        writeBlock( m.blkno, wfp, buf.get(), bufl, 0, found );
+      }
+    }
+  };
+
   if (rsumlen && !rsums.empty()) {
 
+      if (!rsumseq)
+        rsumseq = nblks > 1 && chksumlen < 16 ? 2 : 1;
+
       const auto rsumAMask = rsumlen < 3 ? 0 : rsumlen == 3 ? 0xff : 0xffff;
 
       // we are building a array of rsum structs to directly access a and b parts of the checksum
@@ -472,11 +707,12 @@ void MediaBlockList::reuseBlocks(FILE *wfp, const std::string& filename)
       }
 
       // we use the same code as zsync to calc the hash
-      const auto & calc_rhash = [&]( const rsum* e ) -> unsigned {
+      // ( the rsums of a sequence are stored \a stride entries apart )
+      const auto & calc_rhash = [&]( const rsum* e, size_t stride = 1 ) -> unsigned {
         unsigned h = e[0].b;
         if ( this->rsumseq > 1 ) {
           for ( uint i = 1; i < rsumseq; i++ ) {
-            h ^= e[i].b << 3;
+            h ^= e[i*stride].b << 3;
           }
         } else {
           h ^= ( e[0].a & rsumAMask ) << 3;
@@ -513,24 +749,6 @@ void MediaBlockList::reuseBlocks(FILE *wfp, const std::string& filename)
         hashList.push_back(id);
       }
 
-      // we read in 16 sequences at once to speed up processing
-      constexpr auto BLOCKCNT = 16;
-
-      // we allocate the buffer so that we always have the data to verify 16 blocks, if we need to do
-      // sequence matching we grow the buffer accordingly
-      const auto readBufSize = blksize * rsumseq * BLOCKCNT;
-
-      // buffer thats going to hold our cached data
-      auto readBufData = std::make_unique<unsigned char[]>( readBufSize );
-      memset(readBufData.get(), 0, blksize);
-
-      // avoid using .get() all the time
-      auto readBuf = readBufData.get();
-
-      // our running checksums for the blocks we need to match in sequence
-      auto seqRsumsData = std::make_unique<rsum[]> ( rsumseq );
-      auto seqRsums = seqRsumsData.get();
-
       // use byteshift instead of multiplication if the blksize is a power of 2
       // a value is a power of 2 if  ( N & N-1 ) == 0
       int bshift = 0; // how many bytes do we need to shift
@@ -538,165 +756,330 @@ void MediaBlockList::reuseBlocks(FILE *wfp, const std::string& filename)
         for (bshift = 0; size_t(1 << bshift) != blksize; bshift++)
           ;
 
-      bool init = true;
-      // when we are in a run of matches, we remember which block ID would need to match next in order
-      // to continue writing
-      std::optional<size_t> nextReqMatchInSequence;
-      off_t dataOffset = 0; //< Our current read offset in the buffer
-      off_t dataLen = 0;    //< The length of our read buffer
+      // in batch mode we calculate the rsums for RSUM_BATCH window offsets at once using the
+      // vectorized kernel, then look them up in the hashtable and verify the candidates in order
+      constexpr size_t RSUM_BATCH = 256;
+      const auto rollRsums = rollRsumsKernel().first;
+      // bitmaps of the b parts of the block rsums and of the non empty hash buckets, they are small enough
+      // to stay in the cache and filter out most window offsets before we need to touch the hashtable
+      std::vector<uint64_t> usedRsumBBits;
+      std::vector<uint64_t> usedHashBits;
+      const auto &testBit = []( const std::vector<uint64_t> &bits, size_t bit ) {
+        return ( bits[ bit / 64 ] & ( uint64_t(1) << ( bit % 64 ) ) ) != 0;
+      };
+      if ( rsumbatching ) {
+        usedRsumBBits.resize( 65536 / 64 );
+        for ( size_t id = 0; id < nblks; id++ )
+          usedRsumBBits[ zsyncRsums[id].b / 64 ] |= uint64_t(1) << ( zsyncRsums[id].b % 64 );
+        usedHashBits.resize( rsumHashMask / 64 + 1 );
+        for ( uint h = 0; h <= rsumHashMask; h++ ) {
+          if ( rsumHashTable[h].size() )
+            usedHashBits[ h / 64 ] |= uint64_t(1) << ( h % 64 );
+        }
+      }
+      const off_t seqMatchLen = ( blksize * rsumseq ); //< how many bytes do we need to match when searching a block
 
-      // helper lambda that follows a list of hashmap entries and tries to write those that match
-      const auto &tryWriteMatchingBlocks  = [&]( const std::vector<size_t> &list, const u_char *currBuf, uint reqMatches ){
-        // the number of blocks we have transferred to the target file
-        int targetBlocksWritten = 0;
+      // Scans the windows starting in [begin, end) of the delta file dfp for matching blocks and passes them to
+      // writeMatch. The scan state is local, so several scans of different ranges can run in parallel.
+      const auto &scanDeltaFile = [&]( FILE *dfp, off_t begin, off_t end, std::vector<bool> &found, const auto &writeMatch ) {
 
-        // reset the next match hint
-        nextReqMatchInSequence.reset();
+        // we read in 16 sequences at once to speed up processing
+        constexpr auto BLOCKCNT = 16;
 
-        for ( const auto blkno : list ) {
+        // we allocate the buffer so that we always have the data to verify 16 blocks, if we need to do
+        // sequence matching we grow the buffer accordingly
+        const auto readBufSize = blksize * rsumseq * BLOCKCNT;
 
-          if ( found[blkno] )
-              continue;
+        // buffer thats going to hold our cached data
+        auto readBufData = std::make_unique<unsigned char[]>( readBufSize );
+        memset(readBufData.get(), 0, blksize);
 
-          const auto blockRsum = &zsyncRsums[blkno];
+        // avoid using .get() all the time
+        auto readBuf = readBufData.get();
 
-          uint weakMatches = 0;
+        // our running checksums for the blocks we need to match in sequence
+        auto seqRsumsData = std::make_unique<rsum[]> ( rsumseq );
+        auto seqRsums = seqRsumsData.get();
 
-          // first check only the current block, we maybe can skip checking the others
-          // if we are in a run of matches
-          if ( (seqRsums[0].a & rsumAMask) != blockRsum[0].a ||
-               seqRsums[0].b != blockRsum[0].b )
-            continue;
+        std::unique_ptr<rsum[]> batchRsumsData;
+        std::vector<std::pair<size_t, unsigned>> batchCandidates; //< window offset and hash
+        if ( rsumbatching ) {
+          batchRsumsData = std::make_unique<rsum[]>( RSUM_BATCH * rsumseq );
+          batchCandidates.reserve( RSUM_BATCH );
+        }
+        auto batchRsums = batchRsumsData.get();
+
+        bool init = true;
+        // when we are in a run of matches, we remember which block ID would need to match next in order
+        // to continue writing
+        std::optional<size_t> nextReqMatchInSequence;
+        off_t bufOffset = begin; //< The file offset of our read buffer
+        off_t dataOffset = 0; //< Our current read offset in the buffer
+        off_t dataLen = 0;    //< The length of our read buffer
+
+        // helper lambda that follows a list of hashmap entries and tries to write those that match
+        const auto &tryWriteMatchingBlocks  = [&]( const std::vector<size_t> &list, const u_char *currBuf, uint reqMatches ){
+          // the number of blocks we have transferred to the target file
+          int targetBlocksWritten = 0;
+
+          // reset the next match hint
+          nextReqMatchInSequence.reset();
+
+          for ( const auto blkno : list ) {
+
+            if ( found[blkno] )
+                continue;
+
+            const auto blockRsum = &zsyncRsums[blkno];
 
-          weakMatches++;
+            uint weakMatches = 0;
+
+            // first check only the current block, we maybe can skip checking the others
+            // if we are in a run of matches
+            if ( (seqRsums[0].a & rsumAMask) != blockRsum[0].a ||
+                 seqRsums[0].b != blockRsum[0].b )
+              continue;
 
-          for ( uint i = 1; i < reqMatches; i++ ) {
-            if ( (seqRsums[i].a & rsumAMask) != blockRsum[i].a ||
-                 seqRsums[i].b != blockRsum[i].b )
-              break;
             weakMatches++;
-          }
 
-          if ( weakMatches < reqMatches )
-            continue;
+            for ( uint i = 1; i < reqMatches; i++ ) {
+              if ( (seqRsums[i].a & rsumAMask) != blockRsum[i].a ||
+                   seqRsums[i].b != blockRsum[i].b )
+                break;
+              weakMatches++;
+            }
+
+            if ( weakMatches < reqMatches )
+              continue;
 
-          // we have a weak match, now we need to calc the checksums for the blocks
-          uint realMatches = 0;
-          for( uint i = 0; i < reqMatches; i++ ) {
-            if ( !checkChecksum(blkno + i, currBuf + ( i * blksize ), blksize ) ) {
-              break;
+            // we have a weak match, now we need to calc the checksums for the blocks
+            uint realMatches = 0;
+            for( uint i = 0; i < reqMatches; i++ ) {
+              if ( !checkChecksum(blkno + i, currBuf + ( i * blksize ), blksize ) ) {
+                break;
+              }
+              realMatches++;
             }
-            realMatches++;
-          }
 
-          // check if we have the amount of matches we need ( only 1 if we are in a block sequence )
-          if( realMatches < reqMatches )
-            continue;
+            // check if we have the amount of matches we need ( only 1 if we are in a block sequence )
+            if( realMatches < reqMatches )
+              continue;
 
-          // we found blocks that match , write them to target but keep searching the hashmap
-          // in case we have redundancies
-          const auto nextPossibleMatch = blkno + realMatches;
-          if ( !found[nextPossibleMatch] )
-            nextReqMatchInSequence = nextPossibleMatch; // remember that we are currently in a run of matches, next iteration we just need to look at one block
+            // we found blocks that match , write them to target but keep searching the hashmap
+            // in case we have redundancies
+            const auto nextPossibleMatch = blkno + realMatches;
+            if ( !found[nextPossibleMatch] )
+              nextReqMatchInSequence = nextPossibleMatch; // remember that we are currently in a run of matches, next iteration we just need to look at one block
 
-          for( uint i = 0; i < realMatches; i++ ) {
-            writeBlock( blkno + i, wfp, currBuf + ( i * blksize ), blksize, 0, found );
-            targetBlocksWritten++;
+            for( uint i = 0; i < realMatches; i++ ) {
+              writeMatch( blkno + i, currBuf + ( i * blksize ), bufOffset + ( currBuf - readBuf ) + off_t( i * blksize ) );
+              targetBlocksWritten++;
+            }
           }
-        }
-        return targetBlocksWritten;
-      };
+          return targetBlocksWritten;
+        };
 
-      if (!rsumseq)
-        rsumseq = nblks > 1 && chksumlen < 16 ? 2 : 1;
+        if ( fseeko( dfp, begin, SEEK_SET ) )
+          return;
 
-      const off_t seqMatchLen = ( blksize * rsumseq ); //< how many bytes do we need to match when searching a block
+        while (! feof(dfp) ) {
+            if ( init ) {
+              // fill the buffer for the first time
+              dataLen = fread( readBuf, 1, readBufSize, dfp );
+              init = false;
+            } else {
+              // move the remaining data to the begin and read from the file to fill up the buffer again
+              const auto remainLen = dataLen-dataOffset;
+              if ( remainLen )
+                memmove( readBuf, readBuf+dataOffset, remainLen );
+
+              dataLen = fread( readBuf+remainLen, 1, readBufSize-remainLen, dfp );
+              dataLen += remainLen;
+              bufOffset += dataOffset;
+              dataOffset = 0;
+            }
 
-      while (! feof(fp) ) {
-          if ( init ) {
-            // fill the buffer for the first time
-            dataLen = fread( readBuf, 1, readBufSize, fp );
-            init = false;
-          } else {
-            // move the remaining data to the begin and read from the file to fill up the buffer again
-            const auto remainLen = dataLen-dataOffset;
-            if ( remainLen )
-              memmove( readBuf, readBuf+dataOffset, remainLen );
-
-            dataLen = fread( readBuf+remainLen, 1, readBufSize-remainLen, fp );
-            dataLen += remainLen;
-            dataOffset = 0;
-          }
+            // if we hit eof, pad with zeros
+            if ( feof(dfp) ) {
+              memset( readBuf + dataLen, 0, readBufSize - dataLen );
+              dataLen = readBufSize;
+            }
 
-          // if we hit eof, pad with zeros
-          if ( feof(fp) ) {
-            memset( readBuf + dataLen, 0, readBufSize - dataLen );
-            dataLen = readBufSize;
-          }
+            if ( dataLen < seqMatchLen )
+              return;
 
-          if ( dataLen < seqMatchLen )
-            return;
+            // intialize our first set of checksums
+            for( uint i = 0; i < rsumseq; i++ )
+              seqRsums[i] = rcksum_calc_rsum_block( readBuf + ( i * blksize ), blksize );
 
-          // intialize our first set of checksums
-          for( uint i = 0; i < rsumseq; i++ )
-            seqRsums[i] = rcksum_calc_rsum_block( readBuf + ( i * blksize ), blksize );
+            //read over the buffer we have allocated so far
+            while ( true ) {
 
-          //read over the buffer we have allocated so far
-          while ( true ) {
+              if ( dataOffset + seqMatchLen > dataLen )
+                break;
 
-            if ( dataOffset + seqMatchLen > dataLen )
-              break;
+              // the remaining windows belong to the next range, but we follow a run of matches to its end
+              // since the next range can not continue it
+              if ( bufOffset + dataOffset >= end && !nextReqMatchInSequence )
+                return;
 
-            u_char *currBuf = readBuf + dataOffset;
+              u_char *currBuf = readBuf + dataOffset;
 
-            // the number of deltafile blocks we have matched, e.g. how much blocks
-            // can we skip forward
-            uint deltaBlocksMatched = 0;
+              // the number of deltafile blocks we have matched, e.g. how much blocks
+              // can we skip forward
+              uint deltaBlocksMatched = 0;
 
-            if ( nextReqMatchInSequence.has_value() ) {
-              if ( tryWriteMatchingBlocks( { *nextReqMatchInSequence }, currBuf, 1 ) > 0 )
-                deltaBlocksMatched = 1;
+              if ( nextReqMatchInSequence.has_value() ) {
+                if ( tryWriteMatchingBlocks( { *nextReqMatchInSequence }, currBuf, 1 ) > 0 )
+                  deltaBlocksMatched = 1;
 
-            } else {
-              const auto hash = calc_rhash( seqRsums );
+              } else if ( rsumbatching ) {
+                // the number of window offsets we can look at without running out of data
+                const size_t batchLen = std::min<off_t>( { off_t(RSUM_BATCH), dataLen - seqMatchLen - dataOffset + 1, end - bufOffset - dataOffset } );
+                for ( uint i = 0; i < rsumseq; i++ )
+                  rollRsums( currBuf + ( i * blksize ), blksize, bshift, seqRsums[i], batchLen, batchRsums + ( i * RSUM_BATCH ) );
+
+                batchCandidates.clear();
+                for ( size_t j = 0; j < batchLen; j++ ) {
+                  if ( !testBit( usedRsumBBits, batchRsums[j].b ) )
+                    continue;
+                  const auto hash = calc_rhash( batchRsums + j, RSUM_BATCH );
+                  if ( testBit( usedHashBits, hash & rsumHashMask ) )
+                    batchCandidates.push_back( { j, hash } );
+                }
 
-              // reference to the list of blocks that share our calculated hash
-              auto &blockListForHash = rsumHashTable[ hash & rsumHashMask ];
-              if ( blockListForHash.size() ) {
-                if ( tryWriteMatchingBlocks( blockListForHash, currBuf, rsumseq ) > 0 )
+                // the first candidate we can write ends the batch, we jump forward behind the matched blocks
+                std::optional<size_t> matchOffset;
+                for ( const auto &cand : batchCandidates ) {
+                  for ( uint i = 0; i < rsumseq; i++ )
+                    seqRsums[i] = batchRsums[ i * RSUM_BATCH + cand.first ];
+                  if ( tryWriteMatchingBlocks( rsumHashTable[ cand.second & rsumHashMask ], currBuf + cand.first, rsumseq ) > 0 ) {
+                    matchOffset = cand.first;
+                    break;
+                  }
+                }
+
+                if ( matchOffset ) {
+                  dataOffset += *matchOffset;
                   deltaBlocksMatched = rsumseq;
+                } else {
+                  // continue with the last window of the batch, it's advanced by one byte below
+                  dataOffset += batchLen - 1;
+                  for ( uint i = 0; i < rsumseq; i++ )
+                    seqRsums[i] = batchRsums[ i * RSUM_BATCH + batchLen - 1 ];
+                }
+                currBuf = readBuf + dataOffset;
+
+              } else {
+                const auto hash = calc_rhash( seqRsums );
+
+                // reference to the list of blocks that share our calculated hash
+                auto &blockListForHash = rsumHashTable[ hash & rsumHashMask ];
+                if ( blockListForHash.size() ) {
+                  if ( tryWriteMatchingBlocks( blockListForHash, currBuf, rsumseq ) > 0 )
+                    deltaBlocksMatched = rsumseq;
+                }
               }
-            }
 
-            if ( deltaBlocksMatched > 0 ) {
-              // we jump forward in the buffer to after what we matched
-              dataOffset += ( deltaBlocksMatched * blksize );
+              if ( deltaBlocksMatched > 0 ) {
+                // we jump forward in the buffer to after what we matched
+                dataOffset += ( deltaBlocksMatched * blksize );
 
-              if ( dataOffset + seqMatchLen > dataLen )
-                break;
+                if ( dataOffset + seqMatchLen > dataLen )
+                  break;
 
-              if ( deltaBlocksMatched < rsumseq ) {
-                //@TODO move the rsums we already have
-              }
+                if ( deltaBlocksMatched < rsumseq ) {
+                  //@TODO move the rsums we already have
+                }
 
-              for( uint i = 0; i < rsumseq; i++ )
-                seqRsums[i] = rcksum_calc_rsum_block( readBuf + dataOffset + ( i * blksize ), blksize );
+                for( uint i = 0; i < rsumseq; i++ )
+                  seqRsums[i] = rcksum_calc_rsum_block( readBuf + dataOffset + ( i * blksize ), blksize );
 
 
-            } else {
-              // we found nothing advance the window by one byte and update the rsums
-              dataOffset++;
-              if ( dataOffset + seqMatchLen > dataLen )
-                break;
-              for ( uint i = 0; i < rsumseq; i++ ) {
-                const auto blkOff = ( i*blksize );
-                u_char oldC = (currBuf + blkOff)[0];
-                u_char newC = (currBuf + blkOff)[blksize];
-                UPDATE_RSUM( seqRsums[i].a, seqRsums[i].b, oldC, newC, bshift );
+              } else {
+                // we found nothing advance the window by one byte and update the rsums
+                dataOffset++;
+                if ( dataOffset + seqMatchLen > dataLen )
+                  break;
+                for ( uint i = 0; i < rsumseq; i++ ) {
+                  const auto blkOff = ( i*blksize );
+                  u_char oldC = (currBuf + blkOff)[0];
+                  u_char newC = (currBuf + blkOff)[blksize];
+                  UPDATE_RSUM( seqRsums[i].a, seqRsums[i].b, oldC, newC, bshift );
+                }
               }
             }
           }
+      };
+
+      if ( threads > 1 ) {
+        // every thread scans a part of the file, reading over its end as far as needed for the last windows
+        const off_t chunkSize = PathInfo( filename ).size() / threads;
+        std::vector<std::vector<DeltaMatch>> matches( threads );
+        std::vector<std::thread> workers;
+        for ( unsigned t = 0; t < threads; t++ ) {
+          workers.emplace_back( [&, t]() {
+            try {
+              zypp::AutoFILE dfp( fopen( filename.c_str(), "re" ) );
+              if ( !dfp )
+                return;
+              std::vector<bool> threadFound( nblks + 1 );
+              const off_t end = t + 1 < threads ? ( t + 1 ) * chunkSize : std::numeric_limits<off_t>::max();
+              scanDeltaFile( dfp, t * chunkSize, end, threadFound, [&]( size_t blkno, const u_char *, off_t off ) {
+                matches[t].push_back( DeltaMatch{ blkno, off } );
+                threadFound[blkno] = true;
+                threadFound[nblks] = true;
+              });
+            } catch ( ... ) {
+              // just lose the matches of this part
+            }
+          });
         }
+        for ( auto &worker : workers )
+          worker.join();
+        writeDeltaMatches( matches, blksize );
+
+      } else {
+        scanDeltaFile( fp, 0, std::numeric_limits<off_t>::max(), found, [&]( size_t blkno, const u_char *buf, off_t ) {
+          writeBlock( blkno, wfp, buf, blksize, 0, found );
+        });
+      }
+    }
+  else if (chksumlen >= 16 && threads > 1)
+    {
+      // dummy variant, just check the checksums of consecutive ranges of blocks in parallel
+      const off_t fileSize = PathInfo( filename ).size();
+      const size_t blocksPerThread = ( nblks + threads - 1 ) / threads;
+      size_t maxBlksize = 0;
+      for ( const auto &blk : blocks )
+        maxBlksize = std::max( maxBlksize, blk.size );
+
+      std::vector<std::vector<DeltaMatch>> matches( threads );
+      std::vector<std::thread> workers;
+      for ( unsigned t = 0; t < threads; t++ ) {
+        workers.emplace_back( [&, t]() {
+          try {
+            zypp::AutoFILE dfp( fopen( filename.c_str(), "re" ) );
+            if ( !dfp )
+              return;
+            auto buf = std::make_unique<unsigned char[]>( maxBlksize );
+            for ( size_t blkno = t * blocksPerThread; blkno < std::min( nblks, ( t + 1 ) * blocksPerThread ); ++blkno ) {
+              const auto &blk = blocks[blkno];
+              if ( blk.off + off_t(blk.size) > fileSize )
+                break;
+              if ( fseeko( dfp, blk.off, SEEK_SET ) || fread( buf.get(), blk.size, 1, dfp ) != 1 )
+                break;
+              if ( checkChecksum( blkno, buf.get(), blk.size ) )
+                matches[t].push_back( DeltaMatch{ blkno, blk.off } );
+            }
+          } catch ( ... ) {
+            // just lose the matches of this part
+          }
+        });
+      }
+      for ( auto &worker : workers )
+        worker.join();
+      writeDeltaMatches( matches, maxBlksize );
     }
   else if (chksumlen >= 16)
     {
@@ -121,6 +121,49 @@ public:
     return rsumlen && rsums.size() >= blkno + 1;
   }
 
+  /**
+   * whether reuseBlocks() calculates the rolling checksums in batches using
+   * the vectorized kernel supported by the CPU ( the default ), or byte by byte.
+   * mainly useful for testing and benchmarks
+   **/
+  inline void setRsumBatching( bool enable ) {
+    rsumbatching = enable;
+  }
+  inline bool rsumBatching() const {
+    return rsumbatching;
+  }
+
+  /**
+   * how many threads reuseBlocks() may use to scan the delta file. each thread
+   * scans a part of the file, the found blocks are merged afterwards. 0 ( the default )
+   * picks a number based on the CPUs and the file size, 1 scans on the calling thread only
+   **/
+  inline void setReuseThreads( unsigned threads ) {
+    reusethreads = threads;
+  }
+  inline unsigned reuseThreads() const {
+    return reusethreads;
+  }
+
+  /**
+   * name of the rolling checksum kernel used in batch mode ( "avx2", "sse2" or "scalar" )
+   **/
+  static std::string rsumKernelName();
+
+  /**
+   * names of the rsum kernels supported by the CPU we are running on, the one
+   * reuseBlocks() uses first. "scalar" is always available
+   **/
+  static std::vector<std::string> rsumKernelNames();
+
+  /**
+   * calculate the rsums of the \a n windows of \a blksize bytes starting at \a data + 0
+   * ... \a data + n-1 using the rsum kernel named \a kernel, in the format updateRsum()
+   * returns. \a data must provide at least n-1 + blksize bytes. returns an empty vector
+   * if the kernel is not supported. mainly useful for testing
+   **/
+  static std::vector<unsigned int> rollRsums(const std::string &kernel, const unsigned char *data, size_t blksize, size_t n);
+
   /**
    * scan a file for blocks from our blocklist. if we find a suitable block,
    * it is removed from the list
@@ -136,6 +179,7 @@ public:
 private:
   void writeBlock(size_t blkno, FILE *fp, const unsigned char *buf, size_t bufl, size_t start, std::vector<bool> &found) const;
   bool checkChecksumRotated(size_t blkno, const unsigned char *buf, size_t bufl, size_t start) const;
+  unsigned reuseThreadsFor(off_t deltasize) const;
 
   off_t filesize;
   std::string fsumtype;
@@ -153,6 +197,8 @@ private:
   uint rsumseq; // < how many consecutive matches are required
   size_t rsumpad;
   std::vector<unsigned int> rsums;
+  bool rsumbatching;
+  unsigned reusethreads;
 };
 
 inline std::ostream & operator<<(std::ostream &str, const MediaBlockList &bl)
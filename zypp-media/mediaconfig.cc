@@ -14,6 +14,8 @@
 #include <zypp-core/Pathname.h>
 #include <zypp-core/base/String.h>
 
+#include <optional>
+
 namespace zypp {
 
   class MediaConfigPrivate {
@@ -26,10 +28,14 @@ namespace zypp {
       , download_max_silent_tries	( 5 )
       , download_transfer_timeout	( 180 )
       , download_connect_timeout        ( 60 )
+      , download_mirror_stats           ( true )
     { }
 
     Pathname credentials_global_dir_path;
     Pathname credentials_global_file_path;
+    Pathname cache_path;
+    Pathname system_root;
+    std::optional<Pathname> download_mirror_stats_file;
 
     int download_max_concurrent_connections;
     int download_min_download_speed;
@@ -37,6 +43,7 @@ namespace zypp {
     int download_max_silent_tries;
     int download_transfer_timeout;
     int download_connect_timeout;
+    bool download_mirror_stats;
 
   };
 
@@ -53,7 +60,12 @@ namespace zypp {
   {
     Z_D();
     if ( section == "main" ) {
-      if ( entry == "credentials.global.dir" ) {
+      if ( entry == "cachedir" ) {
+        // shared with ZConfig, so remember it but do not consume it
+        d->cache_path = Pathname(value);
+        return false;
+
+      } else if ( entry == "credentials.global.dir" ) {
         d->credentials_global_dir_path = Pathname(value);
         return true;
       } else if ( entry == "credentials.global.file" ) {
@@ -87,6 +99,10 @@ namespace zypp {
         if ( d->download_transfer_timeout < 0 )		d->download_transfer_timeout = 0;
         else if ( d->download_transfer_timeout > 3600 )	d->download_transfer_timeout = 3600;
         return true;
+
+      } else if ( entry == "download.mirror_stats" ) {
+        d->download_mirror_stats = str::strToBool( value, d->download_mirror_stats );
+        return true;
       }
     }
     return false;
@@ -124,6 +140,25 @@ namespace zypp {
   long MediaConfig::download_connect_timeout() const
   { return d_func()->download_connect_timeout; }
 
+  bool MediaConfig::download_mirror_stats() const
+  { return d_func()->download_mirror_stats; }
+
+  Pathname MediaConfig::download_mirror_stats_file() const
+  {
+    Z_D();
+    if ( d->download_mirror_stats_file )
+      return *d->download_mirror_stats_file;
+    if ( ! d->download_mirror_stats )
+      return Pathname();
+    return Pathname::assertprefix( d->system_root, ( d->cache_path.empty() ? Pathname("/var/cache/zypp") : d->cache_path ) / "mirrorstats" );
+  }
+
+  void MediaConfig::setDownloadMirrorStatsFile( const Pathname &file_r )
+  { d_func()->download_mirror_stats_file = file_r; }
+
+  void MediaConfig::setSystemRoot( const Pathname &root_r )
+  { d_func()->system_root = root_r; }
+
   ZYPP_IMPL_PRIVATE(MediaConfig)
 }
 
@@ -90,6 +90,31 @@ namespace zypp {
      */
     long download_connect_timeout() const;
 
+    /*!
+     * Whether to keep per mirror download statistics across runs.
+     */
+    bool download_mirror_stats() const;
+
+    /*!
+     * File the per mirror download statistics are kept in.
+     * Defaults to {cachedir}/mirrorstats (/var/cache/zypp/mirrorstats) below
+     * the \ref setSystemRoot. Empty if \ref download_mirror_stats is off.
+     */
+    Pathname download_mirror_stats_file() const;
+
+    /*!
+     * Use \a file_r instead of the default \ref download_mirror_stats_file.
+     * An empty path disables the statistics. Used to pass the file on to the
+     * download workers, and by tests.
+     */
+    void setDownloadMirrorStatsFile( const Pathname &file_r );
+
+    /*!
+     * The root of the target whose cache keeps the \ref download_mirror_stats_file.
+     * Set by ZConfig whenever the target changes.
+     */
+    void setSystemRoot( const Pathname &root_r );
+
   private:
     MediaConfig();
     std::unique_ptr<MediaConfigPrivate> d_ptr;
@@ -133,6 +133,8 @@
     Fields:
       required string local_filename  -> The path where the worker has placed the file
       required bool   cacheHit        -> Set to true if the file was found in a worker cache
+      optional string checksum_type   -> The type of the checksum calculated while downloading the file
+      optional string checksum        -> The checksum calculated while downloading the file, sent for a requested checksum_type only
 
 
   - Code: 201 - Attach Finished
@@ -228,6 +230,7 @@
       int64  expected_filesize    -> The expected download filesize, workers should fail if a server does not reports the exact same filesize
       bool   check_existance_only -> this will NOT download the file but only query the server if its existant
       bool   metalink_enabled     -> enables/disables metalink handling
+      string checksum_type        -> Downloading workers calculate a checksum of this type while downloading the file and return it in the Provide Finished message
 
   - Code: 601 - Cancel
     Desc: Sent by the controller if a request should be cancelled. The worker should stop the given request and return a
@@ -438,6 +441,8 @@ namespace zyppng {
   {
     constexpr std::string_view LocalFilename ("local_filename");
     constexpr std::string_view CacheHit ("cacheHit");
+    constexpr std::string_view ChecksumType ("checksum_type");
+    constexpr std::string_view Checksum ("checksum");
   }
 
   namespace AuthInfoMsgFields
@@ -473,6 +478,7 @@ namespace zyppng {
     constexpr std::string_view ExpectedFilesize ("expected_filesize");
     constexpr std::string_view CheckExistOnly ("check_existance_only");
     constexpr std::string_view MetalinkEnabled ("metalink_enabled");
+    constexpr std::string_view ChecksumType ("checksum_type");
   }
 
   namespace AttachMsgFields
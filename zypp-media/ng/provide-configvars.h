@@ -18,6 +18,7 @@ namespace zyppng {
   constexpr std::string_view ANON_ID_CONF("zconfig://media/AnonymousId");
   constexpr std::string_view ATTACH_POINT("zconfig://media/AttachPoint");
   constexpr std::string_view PROVIDER_ROOT("zconfig://media/ProviderRoot");
+  constexpr std::string_view MIRROR_STATS_FILE("zconfig://media/MirrorStatsFile");	//< empty if disabled
 
 
   // request related settings:
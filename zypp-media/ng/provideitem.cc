@@ -61,6 +61,8 @@ namespace zyppng {
       m.setValue( ProvideMsgFields::DeltaFile, deltaFile.asString() );
     if ( fSize )
       m.setValue( ProvideMsgFields::ExpectedFilesize, fSize );
+    if ( !spec.checksum().empty() )
+      m.setValue( ProvideMsgFields::ChecksumType, spec.checksum().type() );
     m.setValue( ProvideMsgFields::CheckExistOnly, spec.checkExistsOnly() );
 
     const auto &cHeaders = spec.customHeaders();
@@ -16,6 +16,7 @@
 #include <zypp-core/zyppng/rpc/stompframestream.h>
 #include <zypp-core/base/StringV.h>
 #include <zypp-media/ng/provide-configvars.h>
+#include <zypp-media/MediaConfig>
 #include <zypp-media/MediaException>
 #include <zypp-media/auth/CredentialManager>
 
@@ -340,6 +341,7 @@ namespace zyppng {
     conf.insert ( { AGENT_STRING_CONF.data (), "ZYpp " LIBZYPP_VERSION_STRING } );
     conf.insert ( { ATTACH_POINT.data (), _workerProc->workingDirectory().asString() } );
     conf.insert ( { PROVIDER_ROOT.data (), _parent.z_func()->providerWorkdir().asString() } );
+    conf.insert ( { MIRROR_STATS_FILE.data (), zypp::MediaConfig::instance().download_mirror_stats_file().asString() } );
 
     const auto &cleanupOnErr = [&](){
       readAllStderr();
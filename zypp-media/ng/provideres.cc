@@ -9,6 +9,7 @@
 
 #include "provideres.h"
 #include "private/provideres_p.h"
+#include "private/providemessage_p.h"
 
 namespace zyppng {
 
@@ -43,4 +44,12 @@ namespace zyppng {
     return _data->_responseHeaders;
   }
 
+  zypp::CheckSum ProvideRes::downloadedChecksum() const
+  {
+    const auto &hdrs = _data->_responseHeaders;
+    if ( !hdrs.contains( ProvideFinishedMsgFields::ChecksumType ) || !hdrs.contains( ProvideFinishedMsgFields::Checksum ) )
+      return zypp::CheckSum();
+    return zypp::CheckSum( hdrs.value( ProvideFinishedMsgFields::ChecksumType ).asString(), hdrs.value( ProvideFinishedMsgFields::Checksum ).asString() );
+  }
+
 }
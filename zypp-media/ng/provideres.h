@@ -14,6 +14,7 @@
 #include <zypp-media/ng/ProvideFwd>
 #include <zypp-core/Pathname.h>
 #include <zypp-core/ManagedFile.h>
+#include <zypp-core/CheckSum.h>
 #include <memory>
 
 
@@ -65,6 +66,12 @@ namespace zyppng
      */
     const HeaderValueMap &headers () const;
 
+    /*!
+     * The checksum a downloading worker calculated while writing the file, if the request
+     * asked for one (its \ref ProvideFileSpec::checksum is not empty). Otherwise an empty checksum.
+     */
+    zypp::CheckSum downloadedChecksum () const;
+
     private:
       std::shared_ptr<ProvideResourceData> _data;
   };
@@ -20,6 +20,7 @@
 #include <zypp-core/zyppng/base/AutoDisconnect>
 #include <zypp-core/zyppng/base/EventDispatcher>
 #include <zypp-media/MediaConfig>
+#include <zypp-media/ng/provide-configvars.h>
 #include <ostream>
 
 #include <zypp-media/ng/private/providedbg_p.h>
@@ -309,6 +310,8 @@ namespace zyppng::worker {
         zypp::Url keyUrl( key );
         if ( keyUrl.getScheme() == "zconfig" && keyUrl.getAuthority() == "main" ) {
           mediaConf.setConfigValue( keyUrl.getAuthority(), zypp::Pathname(keyUrl.getPathName()).basename(), value );
+        } else if ( key == MIRROR_STATS_FILE ) {
+          mediaConf.setDownloadMirrorStatsFile( zypp::Pathname(value) );
         }
       }
 
@@ -8,6 +8,9 @@
 \---------------------------------------------------------------------*/
 
 #include <set>
+#include <map>
+#include <tuple>
+#include <vector>
 #include <fstream>
 #include <algorithm>
 
@@ -17,6 +20,7 @@
 #include <zypp/base/IOStream.h>
 #include <zypp/base/Iterator.h>
 #include <zypp/PoolItem.h>
+#include <zypp/ResPool.h>
 #include <zypp/PoolQueryUtil.tcc>
 #include <zypp/ZYppCallbacks.h>
 #include <zypp/sat/SolvAttr.h>
@@ -123,26 +127,162 @@ struct ApplyLock
   }
 };
 
-/**
- * iterator that takes lock, lock all solvables from query
- * and send query to output iterator
- */
-template <class OutputIterator>
-struct LockingOutputIterator
+///////////////////////////////////////////////////////////////////
+namespace
 {
-  LockingOutputIterator(OutputIterator& out_)
-    : out(out_)
-    {}
-
-  void operator()(const PoolQuery& query) const
+  /** Whether \a query_r selects solvables just by kind and exact name.
+   * If so, the idents to look up in the pool are appended to \a idents_r.
+   */
+  bool identLock( const PoolQuery & query_r, std::vector<pool::ByIdent> & idents_r )
   {
-    ApplyLock a;a(query);
-    *out++ = query;
+    if ( ! query_r.strings().empty() || query_r.hasPredicates() || query_r.kinds().empty()
+         || ! query_r.repos().empty() || query_r.statusFilterFlags() != PoolQuery::ALL
+         || query_r.editionRel() != Rel::ANY || ! query_r.caseSensitive()
+         || ! query_r.flags().test( Match::SKIP_KIND ) )
+      return false;
+
+    const PoolQuery::AttrRawStrMap & attrs { query_r.attributes() };
+    if ( attrs.size() != 1 || attrs.begin()->first != sat::SolvAttr::name || attrs.begin()->second.size() != 1 )
+      return false;
+
+    // zypper writes glob locks, but mostly without wildcards
+    const std::string & name { *attrs.begin()->second.begin() };
+    if ( name.empty() || name.find( ':' ) != std::string::npos
+         || ! ( query_r.matchExact() || ( query_r.matchGlob() && name.find_first_of( "*?[\\" ) == std::string::npos ) ) )
+      return false;
+
+    for ( const ResKind & kind : query_r.kinds() )
+      idents_r.push_back( pool::ByIdent( kind, name ) );
+    return true;
   }
 
-  private:
-  OutputIterator& out;
-};
+  /** Queries differing in their attribute values only.
+   * Those can be evaluated together by a single query matching
+   * any of the values.
+   */
+  struct MergeKey
+  {
+    sat::SolvAttr _attr;
+    int _flags;
+    bool _matchWord;
+    PoolQuery::Kinds _kinds;
+    PoolQuery::StrContainer _repos;
+    PoolQuery::StatusFilter _status;
+    Edition _edition;
+    Rel _op;
+
+    /** Whether \a query_r can be merged with others; if so, remember its key. */
+    bool assign( const PoolQuery & query_r )
+    {
+      // Joining REGEXes would renumber their backreferences.
+      if ( ! query_r.strings().empty() || query_r.hasPredicates() || query_r.matchRegex()
+           || query_r.attributes().size() != 1 || query_r.attributes().begin()->second.empty() )
+        return false;
+      for ( const std::string & value : query_r.attributes().begin()->second )
+      {
+        if ( value.empty() )	// matches all unless it's the only one
+          return false;
+      }
+      _attr = query_r.attributes().begin()->first;
+      _flags = query_r.flags().get();
+      _matchWord = query_r.matchWord();
+      _kinds = query_r.kinds();
+      _repos = query_r.repos();
+      _status = query_r.statusFilterFlags();
+      _edition = query_r.edition();
+      _op = query_r.editionRel();
+      return true;
+    }
+
+    /** A query matching the values of all \a queries_r. */
+    PoolQuery merged( const std::vector<const PoolQuery *> & queries_r ) const
+    {
+      PoolQuery ret;
+      for ( const PoolQuery * query : queries_r )
+      {
+        for ( const std::string & value : query->attributes().begin()->second )
+          ret.addAttribute( _attr, value );
+      }
+      ret.setFlags( Match( _flags ) );
+      if ( _matchWord )
+        ret.setMatchWord();
+      for ( const ResKind & kind : _kinds )
+        ret.addKind( kind );
+      for ( const std::string & repo : _repos )
+        ret.addRepo( repo );
+      ret.setStatusFilterFlags( _status );
+      if ( _op != Rel::ANY )
+        ret.setEdition( _edition, _op );
+      return ret;
+    }
+
+    bool operator<( const MergeKey & rhs ) const
+    {
+      if ( _op != rhs._op )
+        return _op.inSwitch() < rhs._op.inSwitch();
+      return std::tie( _attr, _flags, _matchWord, _kinds, _repos, _status, _edition )
+           < std::tie( rhs._attr, rhs._flags, rhs._matchWord, rhs._kinds, rhs._repos, rhs._status, rhs._edition );
+    }
+  };
+
+  /** Apply the locks in [\a begin_r,\a end_r).
+   *
+   * Instead of searching the pool once per lock, locks by kind and name are
+   * looked up in the pools ident index, and the remaining locks differing in
+   * their attribute values only are joined into a single query.
+   */
+  template <class TIterator>
+  void applyLocks( TIterator begin_r, TIterator end_r )
+  {
+    std::vector<pool::ByIdent> idents;
+    std::map<MergeKey,std::vector<const PoolQuery *>> toMerge;
+    std::vector<const PoolQuery *> single;
+
+    for_( it, begin_r, end_r )
+    {
+      MergeKey key;
+      if ( identLock( *it, idents ) )
+        continue;
+      else if ( key.assign( *it ) )
+        toMerge[key].push_back( &*it );
+      else
+        single.push_back( &*it );
+    }
+
+    ResPool pool { ResPool::instance() };
+    for ( const pool::ByIdent & ident : idents )
+    {
+      for ( const PoolItem & item : pool.byIdent( ident ) )
+        item.status().setLock( true, ResStatus::USER );
+    }
+
+    for ( const auto & el : toMerge )
+    {
+      if ( el.second.size() == 1 )
+      {
+        single.push_back( el.second.front() );
+        continue;
+      }
+      try
+      {
+        ApplyLock()( el.first.merged( el.second ) );
+      }
+      catch ( const Exception & excpt )
+      {
+        // e.g. a broken regex in one of them
+        ZYPP_CAUGHT( excpt );
+        single.insert( single.end(), el.second.begin(), el.second.end() );
+      }
+    }
+
+    for ( const PoolQuery * query : single )
+      ApplyLock()( *query );
+
+    DBG << "applied " << idents.size() << " ident locks, " << toMerge.size() << " merged and "
+        << single.size() << " single queries" << endl;
+  }
+} // namespace
+///////////////////////////////////////////////////////////////////
 
 void Locks::readAndApply( const Pathname& file )
 {
@@ -150,9 +290,10 @@ void Locks::readAndApply( const Pathname& file )
   PathInfo pinfo(file);
   if ( pinfo.isExist() )
   {
-    std::insert_iterator<LockSet> ii( _pimpl->MANIPlocks(), _pimpl->MANIPlocks().end() );
-    LockingOutputIterator<std::insert_iterator<LockSet> > lout(ii);
-    readPoolQueriesFromFile( file, boost::make_function_output_iterator(lout) );
+    LockList read;
+    readPoolQueriesFromFile( file, std::back_inserter( read ) );
+    applyLocks( read.begin(), read.end() );
+    _pimpl->MANIPlocks().insert( read.begin(), read.end() );
   }
   else
     MIL << "file does not exist(or cannot be stat), no lock added." << endl;
@@ -173,7 +314,7 @@ void Locks::read( const Pathname& file )
 void Locks::apply() const
 {
   DBG << "apply locks" << endl;
-  for_each(_pimpl->locks().begin(), _pimpl->locks().end(), ApplyLock());
+  applyLocks( _pimpl->locks().begin(), _pimpl->locks().end() );
 }
 
 
@@ -34,20 +34,25 @@ namespace zypp
    * \li \c ==0 no buddy
    * \li \c >0 this uses \c _buddy status
    * \li \c <0 this status used by \c -_buddy
+   *
+   * The Impls are not allocated one by one, but in chunks (\ref Chunk)
+   * created by \ref PoolItem::makePoolItems. The \ref ResStatus is kept in
+   * a dense array parallel to the Impls, and the \ref ResObject is created
+   * on demand, when it is requested for the first time.
    */
   struct PoolItem::Impl
   {
     public:
-      Impl() {}
+      struct Chunk;
 
-      Impl( ResObject::constPtr &&res_r,
-            ResStatus &&status_r )
-      : _status( std::move(status_r) )
-      , _resolvable( std::move(res_r) )
+      Impl( Chunk & chunk_r, unsigned idx_r, const sat::Solvable & solvable_r )
+      : _chunk( &chunk_r )
+      , _idx( idx_r )
+      , _solvable( solvable_r )
       {}
 
       ResStatus & status() const
-      { return _buddy > 0 ? PoolItem(buddy()).status() : _status; }
+      { return _buddy > 0 ? PoolItem(buddy()).status() : myStatus(); }
 
       sat::Solvable buddy() const
       {
@@ -60,21 +65,31 @@ namespace zypp
 
       void setBuddy( const sat::Solvable & solv_r );
 
+      sat::Solvable satSolvable() const
+      { return _solvable; }
+
+      /** Created on demand, not thread safe (see \ref PoolItem::resolvable). */
       ResObject::constPtr resolvable() const
-      { return _resolvable; }
+      {
+        if ( ! _resolvable && _solvable )
+          _resolvable = makeResObject( _solvable );
+        return _resolvable;
+      }
 
       ResStatus & statusReset() const
       {
-        _status.setLock( false, zypp::ResStatus::USER );
-        _status.resetTransact( zypp::ResStatus::USER );
-        return _status;
+        ResStatus & mystatus( myStatus() );
+        mystatus.setLock( false, zypp::ResStatus::USER );
+        mystatus.resetTransact( zypp::ResStatus::USER );
+        return mystatus;
       }
 
       ResStatus & statusReinit() const
       {
-        _status.setLock( _status.isUserLockQueryMatch(), zypp::ResStatus::USER );
-        _status.resetTransact( zypp::ResStatus::USER );
-        return _status;
+        ResStatus & mystatus( myStatus() );
+        mystatus.setLock( mystatus.isUserLockQueryMatch(), zypp::ResStatus::USER );
+        mystatus.resetTransact( zypp::ResStatus::USER );
+        return mystatus;
       }
 
     public:
@@ -109,8 +124,14 @@ namespace zypp
       }
 
     private:
-      mutable ResStatus     _status;
-      ResObject::constPtr   _resolvable;
+      inline ResStatus & myStatus() const;
+      inline ResStatus & mySavedStatus() const;
+
+    private:
+      Chunk *                             _chunk;		///< the chunk we live in
+      unsigned                            _idx;		///< our index in the chunk
+      sat::Solvable                       _solvable;
+      mutable ResObject::constPtr         _resolvable;	///< created on demand
       DefaultIntegral<sat::detail::IdType,sat::detail::noId> _buddy;
 
     /** \name Poor man's save/restore state.
@@ -119,35 +140,79 @@ namespace zypp
     //@{
     public:
       void saveState() const
-      { _savedStatus = status(); }
+      { mySavedStatus() = status(); }
       void restoreState() const
-      { status() = _savedStatus; }
+      { status() = mySavedStatus(); }
       bool sameState() const
       {
-        if ( status() == _savedStatus )
+        const ResStatus & savedStatus( mySavedStatus() );
+        if ( status() == savedStatus )
           return true;
         // some bits changed...
-        if ( status().getTransactValue() != _savedStatus.getTransactValue()
+        if ( status().getTransactValue() != savedStatus.getTransactValue()
              && ( ! status().isBySolver() // ignore solver state changes
                   // removing a user lock also goes to bySolver
-                  || _savedStatus.getTransactValue() == ResStatus::LOCKED ) )
+                  || savedStatus.getTransactValue() == ResStatus::LOCKED ) )
           return false;
-        if ( status().isLicenceConfirmed() != _savedStatus.isLicenceConfirmed() )
+        if ( status().isLicenceConfirmed() != savedStatus.isLicenceConfirmed() )
           return false;
         return true;
       }
-    private:
-      mutable ResStatus _savedStatus;
     //@}
 
     public:
       /** Offer default Impl. */
-      static shared_ptr<Impl> nullimpl()
+      static shared_ptr<Impl> nullimpl();
+  };
+  ///////////////////////////////////////////////////////////////////
+
+  ///////////////////////////////////////////////////////////////////
+  /// \class PoolItem::Impl::Chunk
+  /// \brief A bunch of \ref PoolItem::Impl allocated in one go.
+  ///
+  /// The PoolItems handed out refer to their Impl via a shared_ptr
+  /// aliasing the chunk. So there is just a single allocation and
+  /// reference count per chunk, and the chunk stays alive as long as
+  /// at least one of its PoolItems is referenced.
+  ///
+  /// The \ref ResStatus (and the saved status) is kept in dense arrays
+  /// parallel to the Impls.
+  ///////////////////////////////////////////////////////////////////
+  struct PoolItem::Impl::Chunk
+  {
+    Chunk( const std::vector<sat::detail::SolvableIdType> & ids_r )
+    {
+      _status.reserve( ids_r.size() );
+      _items.reserve( ids_r.size() );	// no reallocation: Impls remember their Chunk
+      for ( sat::detail::SolvableIdType id : ids_r )
       {
-        static shared_ptr<Impl> _nullimpl( new Impl );
-        return _nullimpl;
+        sat::Solvable solv( id );
+        _status.push_back( solv ? ResStatus( solv.isSystem() ) : ResStatus() );
+        _items.push_back( Impl( *this, _items.size(), solv ) );
       }
+      _savedStatus.resize( ids_r.size() );
+    }
+
+    Chunk( const Chunk & ) = delete;
+    Chunk & operator=( const Chunk & ) = delete;
+
+    std::vector<ResStatus> _status;
+    std::vector<ResStatus> _savedStatus;
+    std::vector<Impl>      _items;
   };
+
+  inline ResStatus & PoolItem::Impl::myStatus() const
+  { return _chunk->_status[_idx]; }
+
+  inline ResStatus & PoolItem::Impl::mySavedStatus() const
+  { return _chunk->_savedStatus[_idx]; }
+
+  shared_ptr<PoolItem::Impl> PoolItem::Impl::nullimpl()
+  {
+    static shared_ptr<Impl::Chunk> _nullchunk( new Impl::Chunk( { sat::Solvable::noSolvable.id() } ) );
+    static shared_ptr<Impl> _nullimpl( _nullchunk, &_nullchunk->_items[0] );
+    return _nullimpl;
+  }
   ///////////////////////////////////////////////////////////////////
 
   /** \relates PoolItem::Impl Stream output */
@@ -171,7 +236,7 @@ namespace zypp
         ERR <<  *this << " would be buddy2 in " << myBuddy << endl;
         return;
       }
-      myBuddy._pimpl->_buddy = -resolvable()->satSolvable().id();
+      myBuddy._pimpl->_buddy = -_solvable.id();
       _buddy = myBuddy.satSolvable().id();
       DBG << *this << " has buddy " << myBuddy << endl;
     }
@@ -193,13 +258,26 @@ namespace zypp
   : _pimpl( ResPool::instance().find( resolvable_r )._pimpl )
   {}
 
-  PoolItem::PoolItem( Impl * implptr_r )
-  : _pimpl( implptr_r )
+  PoolItem::PoolItem( shared_ptr<Impl> implptr_r )
+  : _pimpl( std::move(implptr_r) )
   {}
 
   PoolItem PoolItem::makePoolItem( const sat::Solvable & solvable_r )
   {
-    return PoolItem( new Impl( makeResObject( solvable_r ), solvable_r.isSystem() ) );
+    shared_ptr<Impl::Chunk> chunk( new Impl::Chunk( { solvable_r.id() } ) );
+    return PoolItem( shared_ptr<Impl>( chunk, &chunk->_items[0] ) );
+  }
+
+  void PoolItem::makePoolItems( std::vector<PoolItem> & store_r, const std::vector<sat::detail::SolvableIdType> & ids_r )
+  {
+    if ( ids_r.empty() )
+      return;
+
+    shared_ptr<Impl::Chunk> chunk( new Impl::Chunk( ids_r ) );
+    for ( unsigned i = 0; i < ids_r.size(); ++i )
+    {
+      store_r[ids_r[i]] = PoolItem( shared_ptr<Impl>( chunk, &chunk->_items[i] ) );
+    }
   }
 
   PoolItem::~PoolItem()
@@ -208,6 +286,9 @@ namespace zypp
   ResPool PoolItem::pool() const
   { return ResPool::instance(); }
 
+  PoolItem::operator sat::Solvable() const
+  { return _pimpl->satSolvable(); }
+
 
   ResStatus & PoolItem::status() const			{ return _pimpl->status(); }
   ResStatus & PoolItem::statusReset() const		{ return _pimpl->statusReset(); }
@@ -14,6 +14,7 @@
 
 #include <iosfwd>
 #include <functional>
+#include <vector>
 
 #include <zypp/base/PtrTypes.h>
 #include <zypp/ResObject.h>
@@ -50,6 +51,7 @@ namespace zypp
   class ZYPP_API PoolItem : public sat::SolvableType<PoolItem>
   {
     friend std::ostream & operator<<( std::ostream & str, const PoolItem & obj );
+    friend bool operator==( const PoolItem & lhs, const PoolItem & rhs );
     public:
       /** Default ctor for use in std::container. */
       PoolItem();
@@ -117,9 +119,10 @@ namespace zypp
       /** Return the \ref ResPool the item belongs to. */
       ResPool pool() const;
 
-      /** This is a \ref sat::SolvableType. */
-      explicit operator sat::Solvable() const
-      { return resolvable() ? resolvable()->satSolvable() : sat::Solvable::noSolvable; }
+      /** This is a \ref sat::SolvableType.
+       * \note Does not require the \ref ResObject to be created.
+       */
+      explicit operator sat::Solvable() const;
 
       /** Return the buddy we share our status object with.
        * A \ref Product e.g. may share its status with an associated reference \ref Package.
@@ -128,6 +131,10 @@ namespace zypp
 
     public:
       /** Returns the ResObject::constPtr.
+       * The \ref ResObject is created on the first request.
+       * \note Like the rest of the \ref ResPool this is not thread safe:
+       * Don't ask for the ResObject of a PoolItem from several threads at
+       * once, unless it was already created.
        * \see \ref operator->
        */
       ResObject::constPtr resolvable() const;
@@ -146,13 +153,19 @@ namespace zypp
       friend class pool::PoolImpl;
       /** \ref PoolItem generator for \ref pool::PoolImpl. */
       static PoolItem makePoolItem( const sat::Solvable & solvable_r );
+      /** Bulk \ref PoolItem generator for \ref pool::PoolImpl.
+       * Creates the PoolItems for all solvable \a ids_r in a single chunk
+       * of memory and stores them at \c store_r[id]. The \ref ResObject
+       * is not created until it is actually requested.
+       */
+      static void makePoolItems( std::vector<PoolItem> & store_r, const std::vector<sat::detail::SolvableIdType> & ids_r );
       /** Buddies are set by \ref pool::PoolImpl.*/
       void setBuddy( const sat::Solvable & solv_r );
       /** internal ctor */
     public:
       struct Impl;	///< Expose type only
     private:
-      explicit PoolItem( Impl * implptr_r );
+      explicit PoolItem( shared_ptr<Impl> implptr_r );
       /** Pointer to implementation */
       RW_pointer<Impl> _pimpl;
 
@@ -171,9 +184,12 @@ namespace zypp
   /** \relates PoolItem Stream output */
   std::ostream & operator<<( std::ostream & str, const PoolItem & obj ) ZYPP_API;
 
-  /** \relates PoolItem Required to disambiguate vs. (PoolItem,ResObject::constPtr) due to implicit PoolItem::operator ResObject::constPtr  */
+  /** \relates PoolItem Required to disambiguate vs. (PoolItem,ResObject::constPtr) due to implicit PoolItem::operator ResObject::constPtr
+   * \note PoolItems referring to the same item share the same implementation,
+   * so there's no need to create the \ref ResObject just to compare them.
+   */
   inline bool operator==( const PoolItem & lhs, const PoolItem & rhs )
-  { return lhs.resolvable() == rhs.resolvable(); }
+  { return lhs._pimpl.get() == rhs._pimpl.get(); }
 
   /** \relates PoolItem Convenience compare */
   inline bool operator==( const PoolItem & lhs, const ResObject::constPtr & rhs )
@@ -12,14 +12,21 @@
 #include <iostream>
 #include <sstream>
 #include <utility>
+#include <atomic>
+#include <exception>
+#include <thread>
+#include <unordered_map>
 
 #include <zypp/base/Gettext.h>
 #include <zypp/base/LogTools.h>
 #include <zypp/base/Algorithm.h>
 #include <zypp/base/String.h>
+#include <zypp/base/SerialNumber.h>
 #include <zypp/repo/RepoException.h>
 #include <zypp/RelCompare.h>
+#include <zypp/ZConfig.h>
 
+#include <zypp/sat/detail/PoolImpl.h>
 #include <zypp/sat/Pool.h>
 #include <zypp/sat/Solvable.h>
 #include <zypp/base/StrMatcher.h>
@@ -462,6 +469,11 @@ namespace zypp
 
     /** Optional comment string for serialization. */
     mutable std::string _comment;
+
+    /** Threads searching the repositories (not serialized). */
+    unsigned _parallelJobs = 1;
+    /** Threads the last search started (not serialized). */
+    mutable unsigned _usedParallelJobs = 0;
     //@}
 
   public:
@@ -979,6 +991,9 @@ namespace zypp
   void PoolQuery::setStatusFilterFlags( PoolQuery::StatusFilter flags )
   { _pimpl->_status_flags = flags; }
 
+  void PoolQuery::setParallelJobs( unsigned jobs_r )
+  { _pimpl->_parallelJobs = jobs_r; }
+
 
   const PoolQuery::StrContainer &
   PoolQuery::strings() const
@@ -996,6 +1011,9 @@ namespace zypp
     return it != _pimpl->_attrs.end() ? it->second : nocontainer;
   }
 
+  bool PoolQuery::hasPredicates() const
+  { return !_pimpl->_uncompiledPredicated.empty(); }
+
   const Edition PoolQuery::edition() const
   { return _pimpl->_edition; }
   const Rel PoolQuery::editionRel() const
@@ -1033,6 +1051,12 @@ namespace zypp
   PoolQuery::StatusFilter PoolQuery::statusFilterFlags() const
   { return _pimpl->_status_flags; }
 
+  unsigned PoolQuery::parallelJobs() const
+  { return _pimpl->_parallelJobs; }
+
+  unsigned PoolQuery::usedParallelJobs() const
+  { return _pimpl->_usedParallelJobs; }
+
   bool PoolQuery::empty() const
   {
     try { return begin() == end(); }
@@ -1525,10 +1549,15 @@ namespace zypp
      * to the first match. Otherwise advance moves to the next match, or
      * to the \ref end, if there is no more match.
      *
+     * The ctor may collect the candidate Solvables in advance, either from
+     * the repos \ref sat::detail::TrigramIndex (\ref ZConfig::repo_search_index),
+     * or by worker threads (\ref PoolQuery::setParallelJobs). \ref advance
+     * then just checks the candidates.
+     *
      * \note The original implementation treated an empty search string as
      * <it>"match always"</it>. We stay compatible.
      */
-    class PoolQueryMatcher
+    class PoolQueryMatcher : private sat::detail::PoolMember
     {
       public:
         using base_iterator = sat::LookupAttr::iterator;
@@ -1542,6 +1571,9 @@ namespace zypp
 
         bool advance( base_iterator & base_r ) const
         {
+          if ( _useCandidates )
+            return advanceCandidate( base_r );
+
           if ( base_r == end() )
             base_r = startNewQyery(); // first candidate
           else
@@ -1617,11 +1649,13 @@ namespace zypp
         PoolQueryMatcher &operator=(PoolQueryMatcher &&) = default;
 
         /** Ctor stores the \ref PoolQuery settings.
+         * Unless \a compiled_r, the query is compiled first.
          * \throw MatchException Any of the exceptions thrown by \ref PoolQuery::Impl::compile.
          */
-        PoolQueryMatcher( const shared_ptr<const PoolQuery::Impl> & query_r )
+        PoolQueryMatcher( const shared_ptr<const PoolQuery::Impl> & query_r, bool compiled_r = false )
         {
-          query_r->compile();
+          if ( ! compiled_r )
+            query_r->compile();
 
           // Repo restriction:
           sat::Pool satpool( sat::Pool::instance() );
@@ -1648,14 +1682,23 @@ namespace zypp
           _status_flags = query_r->_status_flags;
           // StrMatcher
           _attrMatchList = query_r->_attrMatchList;
+
+          if ( ZConfig::instance().repo_search_index() )
+            _useCandidates = findIndexedCandidates();
+          query_r->_usedParallelJobs = 0;
+          if ( ! _useCandidates && query_r->_parallelJobs != 1 )
+          {
+            query_r->_usedParallelJobs = collectCandidates( query_r->_parallelJobs );
+            _useCandidates = query_r->_usedParallelJobs;
+          }
         }
 
         ~PoolQueryMatcher()
         {}
 
       private:
-        /** Initialize a new base query. */
-        base_iterator startNewQyery() const
+        /** Initialize a new base query (optionally restricted to \a solv_r). */
+        base_iterator startNewQyery( sat::Solvable solv_r = sat::Solvable() ) const
         {
           sat::LookupAttr q;
 
@@ -1663,7 +1706,9 @@ namespace zypp
             return q.end();
 
           // Repo restriction:
-          if ( _repos.size() == 1 )
+          if ( solv_r )
+            q.setSolvable( solv_r );
+          else if ( _repos.size() == 1 )
             q.setRepo( *_repos.begin() );
           // else: handled in isAMatch.
 
@@ -1789,6 +1834,244 @@ namespace zypp
           return false;
         }
 
+        /** \ref advance to the next candidate Solvable which is a match. */
+        bool advanceCandidate( base_iterator & base_r ) const
+        {
+          unsigned idx = 0;
+          if ( base_r != end() )
+            idx = _candidateIndex.at( base_r.inSolvable().id() ) + 1;
+
+          for ( ; idx < _candidates.size(); ++idx )
+          {
+            for ( base_r = startNewQyery( _candidates[idx] ); base_r != end(); ++base_r )
+            {
+              if ( isAMatch( base_r ) )
+                return true;
+            }
+          }
+          base_r = end();
+          return false;
+        }
+
+        /** Let up to \a jobs_r threads collect the candidate Solvables of the repos to search.
+         *
+         * A candidate has a string match in at least one attribute. All other
+         * conditions are checked by \ref advanceCandidate. The candidates are
+         * ordered as a serial search would visit them.
+         *
+         * Libsolv uses the pools tmpspace to stringify checksums and full filelist
+         * paths. A worker builds the paths on its own, but if it can't, the query is
+         * performed serially.
+         *
+         * An exception thrown by a worker is rethrown on the calling thread,
+         * after all workers have finished.
+         *
+         * \return The number of threads that collected the candidates, \c 0 if they were not collected.
+         */
+        unsigned collectCandidates( unsigned jobs_r )
+        {
+          if ( _neverMatchRepo )
+            return 0;
+
+          for ( const AttrMatchData & matchData : _attrMatchList )
+          {
+            if ( matchData.strMatcher
+                 && ( matchData.strMatcher.flags().test( Match::CHECKSUMS )
+                      || ( matchData.strMatcher.flags().test( Match::FILES ) && matchData.attr == sat::SolvAttr::allAttr ) ) )
+              return 0;
+          }
+
+          std::vector<Repository> repos { reposToSearch() };
+          if ( repos.size() < 2 )
+            return 0;	// nothing to share
+
+          if ( ! jobs_r )
+            jobs_r = std::max( std::thread::hardware_concurrency(), 1U );
+          jobs_r = std::min<unsigned>( jobs_r, repos.size() );
+          MIL << "Searching " << repos.size() << " repos (" << jobs_r << " parallel)" << endl;
+
+          // Each worker uses its own StrMatchers, as a regex is locked while it is executed.
+          std::vector<AttrMatchList> matchLists( jobs_r, _attrMatchList );
+          for ( AttrMatchList & matchList : matchLists )
+          {
+            for ( AttrMatchData & matchData : matchList )
+            {
+              matchData.strMatcher = StrMatcher( matchData.strMatcher.searchstring(), matchData.strMatcher.flags() );
+              matchData.strMatcher.compile();
+            }
+          }
+
+          std::vector<std::vector<sat::detail::SolvableIdType>> found( repos.size() );
+          std::atomic<unsigned> next { 0 };
+          // An exception must not leave a worker. It is passed to the calling thread
+          // and the remaining workers stop picking up repos.
+          std::vector<std::exception_ptr> errors( jobs_r );
+          std::vector<std::thread> threads;
+          try
+          {
+            for ( unsigned job = 0; job < jobs_r; ++job )
+            {
+              threads.emplace_back( [&,job]() {
+                try
+                {
+                  for ( unsigned idx = next++; idx < repos.size(); idx = next++ )
+                    collectCandidates( repos[idx], matchLists[job], found[idx] );
+                }
+                catch ( ... )
+                {
+                  errors[job] = std::current_exception();
+                  next = repos.size();
+                }
+              });
+            }
+          }
+          catch ( ... )
+          {
+            // failed to start a thread: stop and join the running ones
+            next = repos.size();
+            for ( std::thread & thread : threads )
+              thread.join();
+            throw;
+          }
+          for ( std::thread & thread : threads )
+            thread.join();
+
+          for ( const std::exception_ptr & error : errors )
+          {
+            if ( error )
+              std::rethrow_exception( error );
+          }
+
+          for ( const auto & ids : found )
+            addCandidates( ids );
+          return jobs_r;
+        }
+
+        /** Let the repos \ref sat::detail::TrigramIndex tell the candidate Solvables.
+         * Only name and summary are indexed, and only search strings
+         * containing some trigrams can be looked up.
+         * \return Whether the candidates were found.
+         */
+        bool findIndexedCandidates()
+        {
+          if ( _neverMatchRepo )
+            return false;
+
+          std::vector<std::pair<sat::detail::IdType,std::vector<sat::detail::TrigramIndex::Trigram>>> lookups;
+          for ( const AttrMatchData & matchData : _attrMatchList )
+          {
+            if ( ! ( matchData.attr == sat::SolvAttr::name || matchData.attr == sat::SolvAttr::summary ) )
+              return false;
+            std::vector<sat::detail::TrigramIndex::Trigram> trigrams;
+            if ( ! ( matchData.strMatcher && sat::detail::TrigramIndex::trigrams( matchData.strMatcher, trigrams ) ) )
+              return false;
+            lookups.push_back( { matchData.attr.id(), std::move(trigrams) } );
+          }
+
+          for ( const Repository & repo : reposToSearch() )
+          {
+            std::vector<sat::detail::SolvableIdType> ids;
+            for ( const auto & [ attr, trigrams ] : lookups )
+              myPool().trigramIndex( repo.get(), attr ).find( trigrams, ids );
+            if ( lookups.size() > 1 )
+            {
+              std::sort( ids.begin(), ids.end() );
+              ids.erase( std::unique( ids.begin(), ids.end() ), ids.end() );
+            }
+            addCandidates( ids );
+          }
+          return true;
+        }
+
+        /** The repos passing the status and repo restriction (in pool order). */
+        std::vector<Repository> reposToSearch() const
+        {
+          std::vector<Repository> ret;
+          for ( const Repository & repo : sat::Pool::instance().repos() )
+          {
+            if ( _status_flags && ( (_status_flags == PoolQuery::INSTALLED_ONLY) != repo.isSystemRepo() ) )
+              continue;
+            if ( ! _repos.empty() && _repos.find( repo ) == _repos.end() )
+              continue;
+            ret.push_back( repo );
+          }
+          return ret;
+        }
+
+        /** Append the next repos candidates. */
+        void addCandidates( const std::vector<sat::detail::SolvableIdType> & ids_r )
+        {
+          for ( sat::detail::SolvableIdType id : ids_r )
+          {
+            _candidateIndex[id] = _candidates.size();
+            _candidates.push_back( sat::Solvable( id ) );
+          }
+        }
+
+        /** Collect the ids of the Solvables in \a repo_r with a string match (sorted). */
+        static void collectCandidates( Repository repo_r, const AttrMatchList & matchList_r, std::vector<sat::detail::SolvableIdType> & ids_r )
+        {
+          std::string path;
+          for ( const AttrMatchData & matchData : matchList_r )
+          {
+            sat::LookupAttr q( matchData.attr, repo_r );
+            if ( matchData.strMatcher && matchData.strMatcher.flags().test( Match::FILES ) && matchData.attr == sat::SolvAttr::filelist )
+            {
+              for ( base_iterator it = q.begin(); it != q.end(); ++it )
+              {
+                if ( matchData.strMatcher.doMatch( filelistPath( it, path ) ) )
+                {
+                  ids_r.push_back( it.inSolvable().id() );
+                  it.nextSkipSolvable();
+                }
+              }
+            }
+            else
+            {
+              if ( matchData.strMatcher ) // an empty searchstring matches always
+                q.setStrMatcher( matchData.strMatcher );
+              for ( base_iterator it = q.begin(); it != q.end(); ++it )
+              {
+                ids_r.push_back( it.inSolvable().id() );
+                it.nextSkipSolvable();
+              }
+            }
+          }
+          if ( matchList_r.size() > 1 )
+          {
+            std::sort( ids_r.begin(), ids_r.end() );
+            ids_r.erase( std::unique( ids_r.begin(), ids_r.end() ), ids_r.end() );
+          }
+        }
+
+        /** The full path of the filelist entry \a it_r points to.
+         * Like \c ::repodata_dir2str, but \a path_r is used instead of the pools tmpspace.
+         */
+        static const char * filelistPath( const base_iterator & it_r, std::string & path_r )
+        {
+          const sat::detail::CDataiterator * dip { it_r.get() };
+          ::Repodata * data { dip->data };
+          sat::detail::IdType did { dip->kv.id };
+
+          path_r.clear();
+          if ( did )
+          {
+            std::vector<const char *> comps;
+            for ( ; did; did = ::dirpool_parent( &data->dirpool, did ) )
+            {
+              sat::detail::IdType comp { ::dirpool_compid( &data->dirpool, did ) };
+              comps.push_back( data->localpool ? ::stringpool_id2str( &data->spool, comp ) : ::pool_id2str( data->repo->pool, comp ) );
+            }
+            for ( auto it = comps.rbegin(); it != comps.rend(); ++it )
+            {
+              path_r += *it;
+              path_r += '/';
+            }
+          }
+          path_r += dip->kv.str;
+          return path_r.c_str();
+        }
+
       private:
         /** Repositories include in the search. */
         std::set<Repository> _repos;
@@ -1802,6 +2085,10 @@ namespace zypp
         int _status_flags;
         /** StrMatcher per attribtue. */
         AttrMatchList _attrMatchList;
+        /** Candidates collected in advance. */
+        DefaultIntegral<bool,false> _useCandidates;
+        std::vector<sat::Solvable> _candidates;
+        std::unordered_map<sat::detail::SolvableIdType,unsigned> _candidateIndex;
     };
     ///////////////////////////////////////////////////////////////////
 
@@ -1857,6 +2144,57 @@ namespace zypp
     return shared_ptr<detail::PoolQueryMatcher>( new detail::PoolQueryMatcher( _pimpl.getPtr() ) );
   }
 
+  ///////////////////////////////////////////////////////////////////
+  //
+  //  CLASS NAME : CompiledPoolQuery::Impl
+  //
+  /** */
+  class CompiledPoolQuery::Impl
+  {
+  public:
+    Impl( const PoolQuery::Impl & query_r )
+    : _query( new PoolQuery::Impl( query_r ) )
+    { _query->compile(); }
+
+    /** The result, searched again if the pool changed. */
+    const sat::SolvableSet & result() const
+    {
+      sat::Pool satpool( sat::Pool::instance() );
+      if ( _watcher.isDirty( satpool.serial() ) )
+      {
+        sat::SolvableSet result;
+        detail::PoolQueryIterator it { shared_ptr<detail::PoolQueryMatcher>( new detail::PoolQueryMatcher( _query, /*compiled*/true ) ) };
+        result.insert( it, detail::PoolQueryIterator() );
+        _result = result;
+        _watcher.remember( satpool.serial() );
+        DBG << "Searched " << _result.size() << " matches at pool serial " << satpool.serial() << endl;
+      }
+      return _result;
+    }
+
+  public:
+    /** Snapshot of the query settings (compiled, never changed). */
+    shared_ptr<const PoolQuery::Impl> _query;
+    /** The pool serial \ref _result belongs to. */
+    mutable SerialNumberWatcher _watcher;
+    /** The remembered result. */
+    mutable sat::SolvableSet _result;
+  };
+  ///////////////////////////////////////////////////////////////////
+
+  CompiledPoolQuery::CompiledPoolQuery( const PoolQuery & query_r )
+  : _pimpl( new Impl( *query_r._pimpl ) )
+  {}
+
+  CompiledPoolQuery::~CompiledPoolQuery()
+  {}
+
+  const sat::SolvableSet & CompiledPoolQuery::result() const
+  { return _pimpl->result(); }
+
+  std::ostream & operator<<( std::ostream & str, const CompiledPoolQuery & obj )
+  { return str << obj._pimpl->_query->asString() << obj._pimpl->_watcher; }
+
   /////////////////////////////////////////////////////////////////
 } // namespace zypp
 ///////////////////////////////////////////////////////////////////
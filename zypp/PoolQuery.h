@@ -24,6 +24,7 @@
 #include <zypp/sat/LookupAttr.h>
 #include <zypp/base/StrMatcher.h>
 #include <zypp/sat/Pool.h>
+#include <zypp/sat/SolvableSet.h>
 
 ///////////////////////////////////////////////////////////////////
 namespace zypp
@@ -381,6 +382,22 @@ namespace zypp
     //void setLocale(const Locale & locale);
     //@}
 
+    /**
+     * Search the repositories on up to \a jobs_r threads at once
+     * (\c 0: one per CPU). The default \c 1 searches serially.
+     *
+     * Each repository is searched by a single thread, so this pays off
+     * if the matches are spread across several repositories. The result
+     * and its order are the same as in a serial search, but \ref begin
+     * returns after the whole pool was searched.
+     *
+     * Queries matching checksums, or full filelist paths in \ref sat::SolvAttr::allAttr,
+     * are always searched serially.
+     *
+     * \note This is not part of the serialized query.
+     */
+    void setParallelJobs( unsigned jobs_r = 0 );
+
     /** \name getters */
     //@{
 
@@ -393,6 +410,11 @@ namespace zypp
 
     const StrContainer & attribute(const sat::SolvAttr & attr) const;
 
+    /** Whether dependencies with edition, arch or kind constraints were added
+     * via addDependency. They are not part of \ref attributes.
+     */
+    bool hasPredicates() const;
+
     const Kinds & kinds() const;
 
     const StrContainer & repos() const;
@@ -426,6 +448,17 @@ namespace zypp
     { return flags().mode(); }
 
     StatusFilter statusFilterFlags() const;
+
+    /** Number of threads searching the repositories (\c 0: one per CPU).
+     * \see \ref setParallelJobs
+     */
+    unsigned parallelJobs() const;
+
+    /** Number of threads the last search of this query started to search the
+     * repositories in parallel, \c 0 if it searched serially.
+     * \see \ref setParallelJobs
+     */
+    unsigned usedParallelJobs() const;
     //@}
 
     /**
@@ -485,6 +518,7 @@ namespace zypp
   public:
     class Impl;
   private:
+    friend class CompiledPoolQuery;
     /** Pointer to implementation */
     RW_pointer<Impl> _pimpl;
   };
@@ -496,6 +530,81 @@ namespace zypp
   /** \relates PoolQuery Detailed stream output. */
   std::ostream & dumpOn( std::ostream & str, const PoolQuery & obj ) ZYPP_API;
 
+  ///////////////////////////////////////////////////////////////////
+  //
+  //  CLASS NAME : CompiledPoolQuery
+  //
+  /** A \ref PoolQuery compiled once, remembering its result until the pool changes.
+   *
+   * A \ref PoolQuery compiles its search strings and searches the whole
+   * pool on each \ref PoolQuery::begin. A \ref CompiledPoolQuery takes
+   * a snapshot of the query settings and compiles them in the ctor. The
+   * result is searched on the first call to \ref result and kept as long
+   * as \ref sat::Pool::serial is unchanged. So asking the same query again
+   * is just a lookup, as long as no repo was added, removed or modified.
+   *
+   * Changing the \ref PoolQuery afterwards does not affect the snapshot.
+   * Copies share the snapshot and the remembered result.
+   *
+   * \code
+   *   PoolQuery q;
+   *   q.addAttribute( sat::SolvAttr::name, "kernel-default" );
+   *   q.setMatchExact();
+   *
+   *   CompiledPoolQuery cq( q );
+   *   for ( const sat::Solvable & solv : cq.result() )   // searches the pool
+   *     ...;
+   *   cq.size();                                          // the remembered result
+   * \endcode
+   *
+   * \note Unlike \ref PoolQuery::begin, the result does not tell the
+   * attributes that matched, and it is not ordered.
+   */
+  class ZYPP_API CompiledPoolQuery
+  {
+    friend std::ostream & operator<<( std::ostream & str, const CompiledPoolQuery & obj );
+
+  public:
+    using size_type = sat::SolvableSet::size_type;
+
+  public:
+    /** Compile a snapshot of \a query_r.
+     * \throws MatchException if the query was about to use a regex which failed to compile.
+     */
+    explicit CompiledPoolQuery( const PoolQuery & query_r );
+
+    ~CompiledPoolQuery();
+
+  public:
+    /** The \ref sat::Solvable matching the query.
+     * The pool is searched again if it changed since the last call.
+     */
+    const sat::SolvableSet & result() const;
+
+    /** Whether the result is empty. */
+    bool empty() const
+    { return result().empty(); }
+
+    /** Number of solvables in the result. */
+    size_type size() const
+    { return result().size(); }
+
+    /** Whether \a solv_r is in the result. */
+    template<class TSolv>
+    bool contains( const TSolv & solv_r ) const
+    { return result().contains( solv_r ); }
+
+  public:
+    class Impl;
+  private:
+    /** Pointer to implementation */
+    RW_pointer<Impl> _pimpl;
+  };
+  ///////////////////////////////////////////////////////////////////
+
+  /** \relates CompiledPoolQuery Stream output. */
+  std::ostream & operator<<( std::ostream & str, const CompiledPoolQuery & obj ) ZYPP_API;
+
   ///////////////////////////////////////////////////////////////////
   namespace detail
   { /////////////////////////////////////////////////////////////////
@@ -166,6 +166,15 @@ namespace zypp
   void RepoManager::loadFromCache( const RepoInfo &info, const ProgressData::ReceiverFnc & progressrcv )
   { return _pimpl->ngMgr().loadFromCache( info, nullptr ).unwrap(); }
 
+  void RepoManager::loadFromCache( const std::list<RepoInfo> &infos, const ProgressData::ReceiverFnc & progressrcv )
+  {
+    auto results = _pimpl->ngMgr().loadFromCache( std::vector<RepoInfo>( infos.begin(), infos.end() ), nullptr );
+    if ( results.empty() || results.back().second )
+      return;
+    ERR << "Failed to load " << results.back().first.alias() << " from cache" << endl;
+    results.back().second.unwrap();
+  }
+
   void RepoManager::cleanCacheDirGarbage( const ProgressData::ReceiverFnc & progressrcv )
   { return _pimpl->ngMgr().cleanCacheDirGarbage( nullptr ).unwrap(); }
 
@@ -330,6 +330,19 @@ namespace zypp
    void loadFromCache( const RepoInfo &info,
                        const ProgressData::ReceiverFnc & progressrcv = ProgressData::ReceiverFnc() );
 
+   /**
+    * \short Load the resolvables of several repos into the pool
+    *
+    * Like \ref loadFromCache for each repo in \a infos, but the solv files
+    * are read ahead in the background while the repos are added to the pool.
+    *
+    * Loading stops at the first repo which fails to load, the remaining
+    * repos are not loaded.
+    * \throws Exception The exception of the repo which failed to load.
+    */
+   void loadFromCache( const std::list<RepoInfo> &infos,
+                       const ProgressData::ReceiverFnc & progressrcv = ProgressData::ReceiverFnc() );
+
    /**
     * Remove any subdirectories of cache directories which no longer belong
     * to any of known repositories.
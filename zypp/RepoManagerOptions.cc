@@ -31,6 +31,8 @@ namespace zypp
     knownServicesPath     = Pathname::assertprefix( root_r, ZConfig::instance().knownServicesPath() );
     pluginsPath           = Pathname::assertprefix( root_r, ZConfig::instance().pluginsPath() );
     probe                 = ZConfig::instance().repo_add_probe();
+    buildCacheMaxConcurrentJobs = ZConfig::instance().repo_buildcache_max_concurrent_jobs();
+    buildCacheInProcess   = ZConfig::instance().repo_buildcache_inprocess();
 
     rootDir = root_r;
   }
@@ -59,6 +61,8 @@ namespace zypp
     OUTS( knownReposPath );
     OUTS( knownServicesPath );
     OUTS( pluginsPath );
+    OUTS( buildCacheMaxConcurrentJobs );
+    OUTS( buildCacheInProcess );
     str << "}" << std::endl;
 #undef OUTS
     return str;
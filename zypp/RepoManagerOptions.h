@@ -56,6 +56,21 @@ namespace zypp
     Pathname knownServicesPath;
     Pathname pluginsPath;
     bool probe;
+    /**
+     * Maximum number of repo2solv processes to run in parallel when
+     * building the caches of several repos at once. \c 0 means the
+     * number of online CPUs.
+     */
+    unsigned buildCacheMaxConcurrentJobs;
+    /**
+     * Build \c rpm-md and \c yast2 solv caches in process using the
+     * libsolvext parsers, instead of running \c repo2solv.
+     * Other repo types are always built by \c repo2solv, and so are
+     * repos failing to build in process. Like \c repo2solv, in-process
+     * builds are subject to \ref buildCacheMaxConcurrentJobs.
+     * Defaults to \ref ZConfig::repo_buildcache_inprocess.
+     */
+    bool buildCacheInProcess;
     /**
      * Target distro ID to be used when refreshing repo index services.
      * Repositories not maching this ID will be skipped/removed.
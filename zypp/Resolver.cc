@@ -108,6 +108,9 @@ namespace zypp
   void Resolver::setRemoveUnneeded( bool yesno_r )      { return _pimpl->setRemoveUnneeded( yesno_r ); }
   bool Resolver::removeUnneeded() const                 { return _pimpl->removeUnneeded(); }
 
+  void Resolver::setReuseSolverResult( bool yesno_r )   { return _pimpl->setReuseSolverResult( yesno_r ); }
+  bool Resolver::reuseSolverResult() const              { return _pimpl->reuseSolverResult(); }
+
   void Resolver::setSystemVerification( bool yesno_r )	{ _pimpl->setVerifyingMode( yesno_r ); }
   void Resolver::setDefaultSystemVerification()		{ _pimpl->setVerifyingMode( indeterminate ); }
   bool Resolver::systemVerification() const		{ return _pimpl->isVerifyingMode(); }
@@ -256,6 +256,21 @@ namespace zypp
     void setRemoveUnneeded( bool yesno_r );
     bool removeUnneeded() const;
 
+    /**
+     * Reuse the result of the previous solver run if nothing changed.
+     *
+     * Frontends may resolve the pool again and again without any change
+     * in between (e.g. on each UI refresh). With this option the previous
+     * run is kept and taken as result, if the solver jobs (derived from
+     * the selections, locks and requests in the pool), the solver flags
+     * and the pool content (\ref sat::Pool::serial) are unchanged.
+     * The result is copied back to the pool as usual.
+     *
+     * Off per default, as the previous solver run is kept in memory.
+     */
+    void setReuseSolverResult( bool yesno_r );
+    bool reuseSolverResult() const;
+
     /** \name  Solver flags (non DUP modes)
      * Default for all flags is \c false unless overwritten by zypp.conf.
      */
@@ -494,9 +494,16 @@ namespace zypp
         , updateMessagesNotify		( "" )
         , repo_add_probe          	( false )
         , repo_refresh_delay      	( 10 )
+        , repo_buildcache_max_concurrent_jobs ( 0 )
+        , repo_buildcache_inprocess     ( false )
+        , repo_whatprovides_snapshot    ( false )
+        , repo_search_index             ( false )
         , repoLabelIsAlias              ( false )
         , download_use_deltarpm   	( true )
         , download_use_deltarpm_always  ( false )
+        , download_max_parallel_packages( 8 )
+        , download_max_parallel_packages_per_repo( 4 )
+        , download_max_heap_size( 0 )
         , download_media_prefer_download( true )
         , download_mediaMountdir	( "/var/adm/mount" )
         , commit_downloadMode		( DownloadDefault )
@@ -583,6 +590,22 @@ namespace zypp
                 {
                   str::strtonum(value, repo_refresh_delay);
                 }
+                else if ( entry == "repo.buildcache.max_concurrent_jobs" )
+                {
+                  str::strtonum(value, repo_buildcache_max_concurrent_jobs);
+                }
+                else if ( entry == "repo.buildcache.inprocess" )
+                {
+                  repo_buildcache_inprocess = str::strToBool( value, repo_buildcache_inprocess );
+                }
+                else if ( entry == "repo.whatprovides.snapshot" )
+                {
+                  repo_whatprovides_snapshot = str::strToBool( value, repo_whatprovides_snapshot );
+                }
+                else if ( entry == "repo.search.index" )
+                {
+                  repo_search_index = str::strToBool( value, repo_search_index );
+                }
                 else if ( entry == "repo.refresh.locales" )
                 {
                   std::vector<std::string> tmp;
@@ -602,6 +625,18 @@ namespace zypp
                 {
                   download_use_deltarpm_always = str::strToBool( value, download_use_deltarpm_always );
                 }
+                else if ( entry == "download.max_parallel_packages" )
+                {
+                  str::strtonum( value, download_max_parallel_packages );
+                }
+                else if ( entry == "download.max_parallel_packages_per_repo" )
+                {
+                  str::strtonum( value, download_max_parallel_packages_per_repo );
+                }
+                else if ( entry == "download.max_heap_size" )
+                {
+                  str::strtonum( value, download_max_heap_size );
+                }
                 else if ( entry == "download.media_preference" )
                 {
                   download_media_prefer_download.restoreToDefault( str::compareCI( value, "volatile" ) != 0 );
@@ -733,6 +768,7 @@ namespace zypp
       {
         Pathname newRoot { _autodetectSystemRoot() };
         MIL << "notifyTargetChanged (" << newRoot << ")" << endl;
+        _mediaConf.setSystemRoot( newRoot );
 
         if ( newRoot.emptyOrRoot() ) {
           _currentTargetDefaults.reset(); // to initial settigns from /
@@ -780,11 +816,18 @@ namespace zypp
 
     bool	repo_add_probe;
     unsigned	repo_refresh_delay;
+    unsigned	repo_buildcache_max_concurrent_jobs;
+    bool	repo_buildcache_inprocess;
+    bool	repo_whatprovides_snapshot;
+    bool	repo_search_index;
     LocaleSet	repoRefreshLocales;
     bool	repoLabelIsAlias;
 
     bool download_use_deltarpm;
     bool download_use_deltarpm_always;
+    unsigned download_max_parallel_packages;
+    unsigned download_max_parallel_packages_per_repo;
+    unsigned download_max_heap_size;
     DefaultOption<bool> download_media_prefer_download;
     DefaultOption<Pathname> download_mediaMountdir;
 
@@ -1164,6 +1207,27 @@ namespace zypp
   unsigned ZConfig::repo_refresh_delay() const
   { return _pimpl->repo_refresh_delay; }
 
+  unsigned ZConfig::repo_buildcache_max_concurrent_jobs() const
+  { return _pimpl->repo_buildcache_max_concurrent_jobs; }
+
+  bool ZConfig::repo_buildcache_inprocess() const
+  { return _pimpl->repo_buildcache_inprocess; }
+
+  void ZConfig::repo_buildcache_inprocess( bool yesno_r )
+  { _pimpl->repo_buildcache_inprocess = yesno_r; }
+
+  bool ZConfig::repo_whatprovides_snapshot() const
+  { return _pimpl->repo_whatprovides_snapshot; }
+
+  void ZConfig::repo_whatprovides_snapshot( bool yesno_r )
+  { _pimpl->repo_whatprovides_snapshot = yesno_r; }
+
+  bool ZConfig::repo_search_index() const
+  { return _pimpl->repo_search_index; }
+
+  void ZConfig::repo_search_index( bool yesno_r )
+  { _pimpl->repo_search_index = yesno_r; }
+
   LocaleSet ZConfig::repoRefreshLocales() const
   { return _pimpl->repoRefreshLocales.empty() ? Target::requestedLocales("") :_pimpl->repoRefreshLocales; }
 
@@ -1179,6 +1243,15 @@ namespace zypp
   bool ZConfig::download_use_deltarpm_always() const
   { return download_use_deltarpm() && _pimpl->download_use_deltarpm_always; }
 
+  unsigned ZConfig::download_max_parallel_packages() const
+  { return _pimpl->download_max_parallel_packages; }
+
+  unsigned ZConfig::download_max_parallel_packages_per_repo() const
+  { return _pimpl->download_max_parallel_packages_per_repo; }
+
+  ByteCount ZConfig::download_max_heap_size() const
+  { return ByteCount( _pimpl->download_max_heap_size, ByteCount::MiB ); }
+
   bool ZConfig::download_media_prefer_download() const
   { return _pimpl->download_media_prefer_download; }
 
@@ -1200,6 +1273,9 @@ namespace zypp
   long ZConfig::download_max_silent_tries() const
   { return _pimpl->_mediaConf.download_max_silent_tries(); }
 
+  bool ZConfig::download_mirror_stats() const
+  { return _pimpl->_mediaConf.download_mirror_stats(); }
+
   long ZConfig::download_transfer_timeout() const
   { return _pimpl->_mediaConf.download_transfer_timeout(); }
 
@@ -23,6 +23,7 @@
 #include <zypp/Arch.h>
 #include <zypp/Locale.h>
 #include <zypp/Pathname.h>
+#include <zypp/ByteCount.h>
 #include <zypp/IdString.h>
 #include <zypp/TriBool.h>
 #include <zypp/ResolverFocus.h>
@@ -269,6 +270,40 @@ namespace zypp
        */
       unsigned repo_refresh_delay() const;
 
+      /**
+       * Maximum number of repo2solv processes building repository caches in parallel.
+       * \c 0 means the number of online CPUs.
+       */
+      unsigned repo_buildcache_max_concurrent_jobs() const;
+
+      /**
+       * Whether \c rpm-md and \c yast2 repository caches are built in process
+       * instead of running \c repo2solv.
+       * Config option <tt>repo.buildcache.inprocess (false)</tt>
+       */
+      bool repo_buildcache_inprocess() const;
+      /** Set \ref repo_buildcache_inprocess. */
+      void repo_buildcache_inprocess( bool yesno_r );
+
+      /**
+       * Whether to keep a snapshot of the whatprovides index in the solv cache.
+       * If the same solv files are loaded again, the pool uses the snapshot
+       * instead of computing the index and the file provides anew.
+       * Config option <tt>repo.whatprovides.snapshot (false)</tt>
+       */
+      bool repo_whatprovides_snapshot() const;
+      /** Set \ref repo_whatprovides_snapshot. */
+      void repo_whatprovides_snapshot( bool yesno_r );
+
+      /**
+       * Whether \ref PoolQuery uses a trigram index to search names and summaries.
+       * The index of a repo is built on first use and saved next to its solv file.
+       * Config option <tt>repo.search.index (false)</tt>
+       */
+      bool repo_search_index() const;
+      /** Set \ref repo_search_index. */
+      void repo_search_index( bool yesno_r );
+
       /**
        * List of locales for which translated package descriptions should be downloaded.
        */
@@ -311,6 +346,12 @@ namespace zypp
        */
       long download_max_silent_tries() const;
 
+      /**
+       * Whether to keep per mirror download statistics across runs.
+       * \see MediaConfig::download_mirror_stats_file
+       */
+      bool download_mirror_stats() const;
+
       /**
        * Maximum time in seconds that you allow a transfer operation to take.
        */
@@ -328,6 +369,24 @@ namespace zypp
        */
       bool download_use_deltarpm_always() const;
 
+      /** Maximum number of packages downloaded in parallel before a commit.
+       * A value of 0 or 1 downloads the packages one by one.
+       * Config option <tt>download.max_parallel_packages (8)</tt>
+       */
+      unsigned download_max_parallel_packages() const;
+
+      /** Maximum number of packages downloaded in parallel from a single repository.
+       * Config option <tt>download.max_parallel_packages_per_repo (4)</tt>
+       */
+      unsigned download_max_parallel_packages_per_repo() const;
+
+      /** Maximum size of a heap of packages to download in \ref DownloadInHeaps mode.
+       * The next heap is downloaded while the current one is installed.
+       * A value of 0 downloads all packages in advance.
+       * Config option <tt>download.max_heap_size (0)</tt> (in MiB)
+       */
+      ByteCount download_max_heap_size() const;
+
       /**
        * Hint which media to prefer when installing packages (download vs. CD).
        * \see class \ref media::MediaPriority
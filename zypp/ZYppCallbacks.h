@@ -1042,6 +1042,42 @@ namespace zypp
     /** send data message */
     static bool data( const std::string & msg_r, const UserData & userData_r = UserData() )
     { return instance()->message( MsgType::data, msg_r, userData_r ); }
+
+    /**
+     * Ask the user to pick one of several answers, using ReportBase::report
+     *
+     * The UserData object will have the following fields:
+     * UserData::type		\ref LIST_CHOICE_REQUEST
+     * "Label"			std::string the question
+     * "Answers"		std::vector<std::pair<std::string,std::string>> each answer and its details
+     * "DefaultAnswer"		unsigned index of the default answer
+     * "RequestData"		UserData of the request, telling what it is about
+     *
+     * Userdata accepted:
+     * "Choice"			unsigned index of the chosen answer
+     *
+     * \return The chosen index, or \a defaultAnswer_r if no valid one was chosen.
+     * \note this is a non virtual function and will use ReportBase::report to send the report.
+     */
+    static unsigned listChoice( const std::string & label_r, const std::vector<std::pair<std::string,std::string>> & answers_r,
+                                unsigned defaultAnswer_r, const UserData & requestData_r = UserData() )
+    {
+      UserData data { LIST_CHOICE_REQUEST };
+      data.set( "Label",         label_r );
+      data.set( "Answers",       answers_r );
+      data.set( "DefaultAnswer", defaultAnswer_r );
+      data.set( "RequestData",   requestData_r );
+      instance()->report( data );
+
+      if ( data.hasvalue( "Choice" ) ) {
+        unsigned choice = data.get<unsigned>( "Choice" );
+        if ( choice < answers_r.size() )
+          return choice;
+      }
+      return defaultAnswer_r;
+    }
+    /** \relates listChoice generic reports UserData::type */
+    constexpr static const char * LIST_CHOICE_REQUEST = "JobReport/ListChoice";
     //@}
   };
 
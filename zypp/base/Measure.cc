@@ -12,9 +12,11 @@
 extern "C"
 {
 #include <sys/times.h>
+#include <sys/resource.h>
 #include <unistd.h>
 }
 #include <iostream>
+#include <fstream>
 #include <utility>
 
 #include <zypp/base/Logger.h>
@@ -251,6 +253,23 @@ namespace zypp
     void Measure::stop()
     { _pimpl.reset(); }
 
+    ByteCount residentSetSize()
+    {
+      std::ifstream statm( "/proc/self/statm" );
+      unsigned long size = 0, resident = 0;
+      if ( ! ( statm >> size >> resident ) )
+        return 0;
+      return ByteCount( resident * ::sysconf( _SC_PAGESIZE ) );
+    }
+
+    ByteCount peakResidentSetSize()
+    {
+      struct rusage usage;
+      if ( ::getrusage( RUSAGE_SELF, &usage ) != 0 )
+        return 0;
+      return ByteCount( usage.ru_maxrss, ByteCount::K );
+    }
+
     /////////////////////////////////////////////////////////////////
   } // namespace debug
   ///////////////////////////////////////////////////////////////////
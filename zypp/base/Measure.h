@@ -16,6 +16,7 @@
 #include <string>
 
 #include <zypp/base/PtrTypes.h>
+#include <zypp/ByteCount.h>
 
 ///////////////////////////////////////////////////////////////////
 namespace zypp
@@ -116,6 +117,12 @@ namespace zypp
     };
     ///////////////////////////////////////////////////////////////////
 
+    /** Current resident set size of the process (0 if unknown). */
+    ZYPP_API ByteCount residentSetSize();
+
+    /** Peak resident set size of the process (0 if unknown). */
+    ZYPP_API ByteCount peakResidentSetSize();
+
     /////////////////////////////////////////////////////////////////
   } // namespace debug
   ///////////////////////////////////////////////////////////////////
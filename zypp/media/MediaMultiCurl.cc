@@ -1787,10 +1787,12 @@ void MediaMultiCurl::checkFileDigest(Url &url, FILE *fp, MediaBlockList &blklist
     ZYPP_THROW(MediaCurlException(url, "fseeko", "seek error"));
   Digest dig;
   blklist.createFileDigest(dig);
-  char buf[4096];
+  // the file digest can't be split across threads, but reading bigger chunks
+  // noticeably lowers the per call overhead on large files
+  std::vector<char> buf( 256 * 1024 );
   size_t l = 0;
-  while ((l = fread(buf, 1, sizeof(buf), fp)) > 0)
-    dig.update(buf, l);
+  while ((l = fread(buf.data(), 1, buf.size(), fp)) > 0)
+    dig.update(buf.data(), l);
   if (!blklist.verifyFileDigest(dig))
     ZYPP_THROW(MediaCurlException(url, "file verification failed", "checksum error"));
 }
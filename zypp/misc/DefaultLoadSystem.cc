@@ -64,6 +64,7 @@ namespace zypp
       {
         RepoManager repoManager( sysRoot_r );
         RepoInfoList repos = repoManager.knownRepositories();
+        RepoInfoList toLoad;
         for_( it, repos.begin(), repos.end() )
         {
           RepoInfo & nrepo( *it );
@@ -90,17 +91,21 @@ namespace zypp
             repoManager.buildCache( nrepo );
           }
 
-          MIL << str::form( "*** load repo '%s'\t", nrepo.name().c_str() ) << std::flush;
-          try
-          {
-            repoManager.loadFromCache( nrepo );
+          toLoad.push_back( nrepo );
+        }
+
+        MIL << str::form( "*** load %zu repos\t", toLoad.size() ) << std::flush;
+        try
+        {
+          // like loading them one by one, this stops at the first repo failing to load
+          repoManager.loadFromCache( toLoad );
+          for ( const RepoInfo & nrepo : toLoad )
             MIL << satpool.reposFind( nrepo.alias() ) << endl;
-          }
-          catch ( const Exception & exp )
-          {
-            ERR << "*** load repo failed: " << exp.asString() + "\n" + exp.historyAsString() << endl;
-            ZYPP_RETHROW ( exp );
-          }
+        }
+        catch ( const Exception & exp )
+        {
+          ERR << "*** load repo failed: " << exp.asString() + "\n" + exp.historyAsString() << endl;
+          ZYPP_RETHROW ( exp );
         }
       }
       MIL << str::form( "*** Read system at '%s'", sysRoot_r.c_str() ) << endl;
@@ -11,9 +11,13 @@
 #include "zypp/parser/xml/Reader.h"
 
 #include <zypp-core/ManagedFile.h>
+#include <zypp-core/zyppng/base/EventLoop>
+#include <zypp-core/zyppng/base/SocketNotifier>
+#include <zypp-core/zyppng/thread/Wakeup>
 #include <zypp-core/zyppng/io/Process>
 #include <zypp-core/zyppng/pipelines/MTry>
 #include <zypp-core/zyppng/pipelines/Algorithm>
+#include <zypp-core/zyppng/pipelines/Transform>
 #include <zypp-media/MediaException>
 #include <zypp-media/ng/Provide>
 #include <zypp-media/ng/ProvideSpec>
@@ -21,6 +25,7 @@
 #include <zypp/ExternalProgram.h>
 #include <zypp/HistoryLog.h>
 #include <zypp/base/Algorithm.h>
+#include <zypp/repo/SolvfileBuilder.h>
 #include <zypp/ng/Context>
 #include <zypp/ng/workflows/logichelpers.h>
 #include <zypp/ng/workflows/contextfacade.h>
@@ -29,6 +34,9 @@
 
 #include <utility>
 #include <fstream>
+#include <numeric>
+#include <thread>
+#include <unistd.h>
 
 #undef  ZYPP_BASE_LOGGER_LOGGROUP
 #define ZYPP_BASE_LOGGER_LOGGROUP "zypp::repomanager"
@@ -630,6 +638,177 @@ namespace zyppng::RepoManagerWorkflow {
       }
     };
 
+    template <typename ZyppCtxRef> struct BuildSolvfileOp;
+
+    /**
+     * Runs \ref zypp::repo::buildSolvfile in a thread of its own, so the
+     * \ref EventLoop is not blocked while the metadata are parsed.
+     */
+    template <>
+    struct BuildSolvfileOp<ContextRef> : public AsyncOp<expected<void>>
+    {
+      BuildSolvfileOp() { }
+
+      BuildSolvfileOp( const BuildSolvfileOp & ) = delete;
+      BuildSolvfileOp & operator=( const BuildSolvfileOp & ) = delete;
+
+      ~BuildSolvfileOp() {
+        if ( _thread.joinable() )
+          _thread.join();
+      }
+
+      static AsyncOpRef<expected<void>> run( zypp::RepoInfo repo, zypp::repo::RepoType repokind, zypp::Pathname metadataPath, zypp::Pathname solvfile ) {
+        MIL << "Building solv file in process for repo " << repo.alias () << std::endl;
+        auto me = std::make_shared<BuildSolvfileOp<ContextRef>>();
+        me->_notifier = me->_wakeup.makeNotifier();
+        me->_notifier->connect( &SocketNotifier::sigActivated, *me, &BuildSolvfileOp<ContextRef>::threadFinished );
+        me->_thread = std::thread( [ op = me.get(), repokind, metadataPath = std::move(metadataPath), solvfile = std::move(solvfile) ]() {
+          op->_result = mtry( zypp::repo::buildSolvfile, repokind, metadataPath, solvfile );
+          op->_wakeup.notify();
+        });
+        return me;
+      }
+
+      void threadFinished( const SocketNotifier &, int ) {
+        _wakeup.ack();
+        _notifier->setEnabled( false );
+        _thread.join();
+        setReady( std::move(_result) );
+      }
+
+    private:
+      Wakeup _wakeup;
+      std::shared_ptr<SocketNotifier> _notifier;
+      std::thread _thread;
+      expected<void> _result = expected<void>::success(); //< written by _thread, read after it was joined
+    };
+
+    template <>
+    struct BuildSolvfileOp<SyncContextRef>
+    {
+      static expected<void> run( zypp::RepoInfo repo, zypp::repo::RepoType repokind, zypp::Pathname metadataPath, zypp::Pathname solvfile ) {
+        MIL << "Building solv file in process for repo " << repo.alias () << std::endl;
+        return mtry( zypp::repo::buildSolvfile, repokind, metadataPath, solvfile );
+      }
+    };
+
+    /** A prepared repo2solv run and the data needed to commit its result. */
+    struct Repo2SolvJob
+    {
+      zypp::RepoInfo _repo;
+      zypp::ExternalProgram::Arguments _args;
+      zypp::ManagedFile _solvfile;		//< unlinked unless the job succeeds
+      RepoStatus _rawMetadataStatus;
+      std::shared_ptr<void> _media;	//< keeps a plaindir medium attached while repo2solv runs
+      zypp::repo::RepoType _buildInProcess = zypp::repo::RepoType::NONE;	//< unless NONE, try \ref BuildSolvfileOp before repo2solv
+      zypp::Pathname _metadataPath;	//< the metadata to build in process
+    };
+
+    /**
+     * Runs a \ref Repo2SolvJob. If it is set up to build the solv file in process
+     * and this fails (e.g. for metadata compressed in a way we can't read), repo2solv
+     * is run instead.
+     */
+    template <typename ZyppCtxRef>
+    auto runRepo2SolvJob( const Repo2SolvJob &job )
+    {
+      constexpr bool isAsync = std::is_same_v<ZyppCtxRef, ContextRef>;
+      using Ret = std::conditional_t<isAsync, AsyncOpRef<expected<void>>, expected<void>>;
+
+      if ( job._buildInProcess == zypp::repo::RepoType::NONE )
+        return Ret( Repo2SolvOp<ZyppCtxRef>::run( job._repo, job._args ) );
+
+      return BuildSolvfileOp<ZyppCtxRef>::run( job._repo, job._buildInProcess, job._metadataPath, job._solvfile.value() )
+      | [ repo = job._repo, args = job._args ]( expected<void> res ) -> Ret {
+        if ( res )
+          return makeReadyResult<expected<void>, isAsync>( std::move(res) );
+        ZYPP_CAUGHT( res.error() );
+        WAR << repo.alias() << " failed to build the solv file in process, falling back to repo2solv" << std::endl;
+        return Repo2SolvOp<ZyppCtxRef>::run( repo, args );
+      };
+    }
+
+    /** Receives a \ref Repo2SolvJob whose execution was deferred. */
+    using Repo2SolvJobSink = std::function<void( Repo2SolvJob && )>;
+
+    /** Commit the solv file created by a \ref Repo2SolvJob and update the cache status. */
+    template <typename ZyppContextRefType>
+    expected<void> finishRepo2Solv( const RepoManagerRef<ZyppContextRefType> &repoMgr, Repo2SolvJob &job, expected<void> &&res )
+    {
+      if ( !res )
+        return std::move(res);
+
+      // We keep it.
+      job._solvfile.resetDispose();
+      return mtry( zypp::sat::updateSolvFileIndex, job._solvfile.value() ) // content digest for zypper bash completion
+      | and_then( [&]() {
+        // update timestamp and checksum
+        return repoMgr->setCacheStatus( job._repo, job._rawMetadataStatus );
+      });
+    }
+
+    /**
+     * Runs a list of \ref Repo2SolvJob, at most \a maxJobs of them in parallel.
+     * The result of each job is passed to \a finishCb, the collected return
+     * values are the result of the operation.
+     *
+     * The jobs are executed via \ref Process (or a thread, see \ref BuildSolvfileOp), so a \ref EventLoop is required
+     * to drive the operation.
+     */
+    /** Most jobs the last \ref Repo2SolvJobsOp ran at the same time. */
+    unsigned repo2SolvJobsPeak = 0;
+
+    struct Repo2SolvJobsOp : public AsyncOp<std::vector<expected<void>>>
+    {
+      using FinishCb = std::function<expected<void>( std::size_t, expected<void> && )>;
+
+      static AsyncOpRef<std::vector<expected<void>>> run( std::vector<Repo2SolvJob> jobs, unsigned maxJobs, FinishCb finishCb ) {
+        auto me = std::make_shared<Repo2SolvJobsOp>();
+        me->_jobs     = std::move(jobs);
+        me->_maxJobs  = std::max( maxJobs, 1U );
+        me->_finishCb = std::move(finishCb);
+        me->_running.resize( me->_jobs.size() );
+        me->_results.resize( me->_jobs.size(), expected<void>::success() );
+        MIL << "Running " << me->_jobs.size() << " repo2solv jobs, " << me->_maxJobs << " in parallel" << std::endl;
+        repo2SolvJobsPeak = 0;
+        me->schedule();
+        return me;
+      }
+
+    private:
+      void schedule() {
+        if ( _scheduling )
+          return; // a job failed to start and finished right away
+        _scheduling = true;
+        while ( _runningCnt < _maxJobs && _nextJob < _jobs.size() ) {
+          const std::size_t idx = _nextJob++;
+          repo2SolvJobsPeak = std::max( repo2SolvJobsPeak, ++_runningCnt );
+          _running[idx] = runRepo2SolvJob<ContextRef>( _jobs[idx] );
+          _running[idx]->onReady( [this, idx]( expected<void> &&res ) { jobFinished( idx, std::move(res) ); } );
+        }
+        _scheduling = false;
+
+        if ( _runningCnt == 0 && _nextJob == _jobs.size() )
+          setReady( std::move(_results) );
+      }
+
+      void jobFinished( std::size_t idx, expected<void> &&res ) {
+        --_runningCnt;
+        _results[idx] = _finishCb ? _finishCb( idx, std::move(res) ) : std::move(res);
+        schedule();
+      }
+
+    private:
+      std::vector<Repo2SolvJob> _jobs;
+      std::vector<AsyncOpRef<expected<void>>> _running;
+      std::vector<expected<void>> _results;
+      FinishCb    _finishCb;
+      unsigned    _maxJobs    = 1;
+      unsigned    _runningCnt = 0;
+      std::size_t _nextJob    = 0;
+      bool        _scheduling = false;
+    };
+
     template<typename Executor, class OpType>
     struct BuildCacheLogic : public LogicBase<Executor, OpType>{
 
@@ -642,10 +821,12 @@ namespace zyppng::RepoManagerWorkflow {
 
       ZYPP_ENABLE_LOGIC_BASE(Executor, OpType);
 
-      BuildCacheLogic( RefreshContextRefType &&refCtx, zypp::RepoManagerFlags::CacheBuildPolicy policy, ProgressObserverRef &&progressObserver )
+      /** If \a deferRepo2Solv is set, repo2solv is not executed but the prepared job is passed to it. */
+      BuildCacheLogic( RefreshContextRefType &&refCtx, zypp::RepoManagerFlags::CacheBuildPolicy policy, ProgressObserverRef &&progressObserver, Repo2SolvJobSink &&deferRepo2Solv = Repo2SolvJobSink() )
         : _refCtx( std::move(refCtx) )
         , _policy( policy )
         , _progressObserver( std::move(progressObserver) )
+        , _deferRepo2Solv( std::move(deferRepo2Solv) )
       {}
 
       MaybeAsyncRef<expected<RefreshContextRefType>> execute() {
@@ -773,7 +954,7 @@ namespace zyppng::RepoManagerWorkflow {
           MIL << "repo type is " << repokind << std::endl;
 
           return mountIfRequired( repokind, info )
-          | and_then([this, repokind, solvfile = std::move(solvfile) ]( std::optional<MediaHandle> forPlainDirs ) mutable {
+          | and_then([this, repokind, raw_metadata_status, solvfile = std::move(solvfile) ]( std::optional<MediaHandle> forPlainDirs ) mutable {
 
             const auto &info = _refCtx->repoInfo();
 
@@ -783,9 +964,6 @@ namespace zyppng::RepoManagerWorkflow {
               case zypp::repo::RepoType::YAST2_e :
               case zypp::repo::RepoType::RPMPLAINDIR_e :
               {
-                // Take care we unlink the solvfile on error
-                zypp::ManagedFile guard( solvfile, zypp::filesystem::unlink );
-
                 zypp::ExternalProgram::Arguments cmd;
 #ifdef ZYPP_REPO2SOLV_PATH
                 cmd.push_back( ZYPP_REPO2SOLV_PATH );
@@ -813,22 +991,36 @@ namespace zyppng::RepoManagerWorkflow {
                 else
                   cmd.push_back( _productdatapath.asString() );
 
-                return Repo2SolvOp<ZyppContextRefType>::run( info, std::move(cmd) )
-                | and_then( [this, guard = std::move(guard), solvfile = std::move(solvfile) ]() mutable {
-                  // We keep it.
-                  guard.resetDispose();
-                  return mtry( zypp::sat::updateSolvFileIndex, solvfile ); // content digest for zypper bash completion
-                });
+                Repo2SolvJob job {
+                  info,
+                  std::move(cmd),
+                  zypp::ManagedFile( solvfile, zypp::filesystem::unlink ), // Take care we unlink the solvfile on error
+                  raw_metadata_status,
+                  forPlainDirs ? std::make_shared<MediaHandle>( std::move(*forPlainDirs) ) : nullptr
+                };
+
+                if ( _refCtx->repoManagerOptions().buildCacheInProcess && zypp::repo::buildSolvfileSupported( repokind ) ) {
+                  job._buildInProcess = repokind;
+                  job._metadataPath   = _productdatapath;
+                }
+
+                if ( _deferRepo2Solv ) {
+                  MIL << info.alias() << " repo2solv deferred" << std::endl;
+                  _deferRepo2Solv( std::move(job) );
+                  return makeReadyResult( expected<void>::success() );
+                }
+
+                auto repo2solv = runRepo2SolvJob<ZyppContextRefType>( job );
+                return std::move(repo2solv)
+                | [ repoMgr = _refCtx->repoManager(), job = std::move(job) ]( expected<void> res ) mutable {
+                  return finishRepo2Solv( repoMgr, job, std::move(res) );
+                };
               }
               break;
               default:
                 return makeReadyResult( expected<void>::error( ZYPP_EXCPT_PTR(zypp::repo::RepoUnknownTypeException( info, _("Unhandled repository type") )) ) );
               break;
             }
-          })
-          | and_then([this, raw_metadata_status](){
-            // update timestamp and checksum
-            return _refCtx->repoManager()->setCacheStatus( _refCtx->repoInfo(), raw_metadata_status );
           });
         })
         | and_then( [this](){
@@ -858,6 +1050,7 @@ namespace zyppng::RepoManagerWorkflow {
       RefreshContextRefType _refCtx;
       zypp::RepoManagerFlags::CacheBuildPolicy _policy;
       ProgressObserverRef   _progressObserver;
+      Repo2SolvJobSink      _deferRepo2Solv;
 
       zypp::Pathname _mediarootpath;
       zypp::Pathname _productdatapath;
@@ -874,6 +1067,133 @@ namespace zyppng::RepoManagerWorkflow {
     return SimpleExecutor<BuildCacheLogic, SyncOp<expected<repo::SyncRefreshContextRef>>>::run( std::move(refCtx), policy, std::move(progressObserver));
   }
 
+  namespace {
+
+    /**
+     * Build the caches of several repos. The repos are prepared one by one, but instead of
+     * running repo2solv right away the jobs are collected and executed in parallel afterwards.
+     * The number of concurrent jobs is limited by \ref RepoManagerOptions::buildCacheMaxConcurrentJobs.
+     */
+    template<typename Executor, class OpType>
+    struct BuildCachesLogic : public LogicBase<Executor, OpType>{
+
+      using ZyppContextRefType    = std::conditional_t<zyppng::detail::is_async_op_v<OpType>, ContextRef, SyncContextRef>;
+      using RepoManagerRefType    = RepoManagerRef<ZyppContextRefType>;
+      using RefreshContextRefType = repo::RefreshContextRef<ZyppContextRefType>;
+      using BuildCacheOpType      = std::conditional_t<zyppng::detail::is_async_op_v<OpType>, AsyncOp<expected<RefreshContextRefType>>, SyncOp<expected<RefreshContextRefType>>>;
+      using Result                = std::vector<std::pair<zypp::RepoInfo, expected<void>>>;
+
+      ZYPP_ENABLE_LOGIC_BASE(Executor, OpType);
+
+      BuildCachesLogic( RepoManagerRefType &&repoMgr, std::vector<zypp::RepoInfo> &&infos, zypp::RepoManagerFlags::CacheBuildPolicy policy, ProgressObserverRef &&progressObserver )
+        : _repoMgr( std::move(repoMgr) )
+        , _infos( std::move(infos) )
+        , _policy( policy )
+        , _progressObserver( std::move(progressObserver) )
+      {}
+
+      MaybeAsyncRef<Result> execute() {
+
+        ProgressObserver::setup( _progressObserver, _("Building repository caches"), 1 );
+        ProgressObserver::start( _progressObserver );
+
+        _subProgress.reserve( _infos.size() );
+        for ( const auto &info : _infos )
+          _subProgress.push_back( ProgressObserver::makeSubTask( _progressObserver, 1.0, zypp::str::form(_("Building repository '%s' cache"), info.label().c_str()), 2 ) );
+
+        std::vector<std::size_t> repoIdx( _infos.size() );
+        std::iota( repoIdx.begin(), repoIdx.end(), 0 );
+
+        return std::move(repoIdx)
+        | transform( [this]( std::size_t idx ) {
+          return zyppng::repo::RefreshContext<ZyppContextRefType>::create( _repoMgr->zyppContext(), _infos[idx], _repoMgr )
+          | and_then( [this, idx]( RefreshContextRefType refCtx ) {
+            return SimpleExecutor<BuildCacheLogic, BuildCacheOpType>::run( std::move(refCtx), _policy, ProgressObserver::makeSubTask( _subProgress[idx] ), [this, idx]( Repo2SolvJob &&job ) {
+              _jobs.push_back( std::make_pair( idx, std::move(job) ) );
+            });
+          })
+          | inspect( incProgress( _subProgress[idx] ) )
+          | and_then( []( auto ) { return expected<void>::success(); } );
+        })
+        | [this]( std::vector<expected<void>> prepared ) {
+          _prepared = std::move(prepared);
+          return runJobs();
+        }
+        | [this]( std::vector<expected<void>> jobResults ) {
+          Result res;
+          res.reserve( _infos.size() );
+          for ( std::size_t i = 0; i < _infos.size(); ++i )
+            res.push_back( std::make_pair( _infos[i], std::move(_prepared[i]) ) );
+          for ( std::size_t j = 0; j < _jobs.size(); ++j )
+            res[_jobs[j].first].second = std::move(jobResults[j]);
+
+          for ( std::size_t i = 0; i < res.size(); ++i )
+            ProgressObserver::finish( _subProgress[i], res[i].second ? ProgressObserver::Success : ProgressObserver::Error );
+          ProgressObserver::finish( _progressObserver, ProgressObserver::Success );
+          return res;
+        };
+      }
+
+    private:
+      MaybeAsyncRef<std::vector<expected<void>>> runJobs() {
+
+        unsigned maxJobs = _repoMgr->options().buildCacheMaxConcurrentJobs;
+        if ( maxJobs == 0 ) {
+#ifdef _SC_NPROCESSORS_ONLN
+          maxJobs = std::max( sysconf(_SC_NPROCESSORS_ONLN), 1L );
+#else
+          maxJobs = 1;
+#endif
+        }
+
+        std::vector<Repo2SolvJob> jobs;
+        jobs.reserve( _jobs.size() );
+        for ( const auto &job : _jobs )
+          jobs.push_back( job.second );
+
+        const auto &finishJob = [this]( std::size_t j, expected<void> &&res ) {
+          return finishRepo2Solv( _repoMgr, _jobs[j].second, std::move(res) );
+        };
+
+        if constexpr ( zyppng::detail::is_async_op_v<OpType> ) {
+          return Repo2SolvJobsOp::run( std::move(jobs), maxJobs, finishJob );
+        } else {
+          // repo2solv runs as Process, so we need to drive a event loop until all jobs are done
+          auto loop = EventLoop::create();
+          auto op = Repo2SolvJobsOp::run( std::move(jobs), maxJobs, finishJob );
+          if ( !op->isReady() ) {
+            op->sigReady().connect( [&](){ loop->quit(); } );
+            loop->run();
+          }
+          return std::move(op->get());
+        }
+      }
+
+    private:
+      RepoManagerRefType _repoMgr;
+      std::vector<zypp::RepoInfo> _infos;
+      zypp::RepoManagerFlags::CacheBuildPolicy _policy;
+      ProgressObserverRef _progressObserver;
+      std::vector<ProgressObserverRef> _subProgress;
+
+      std::vector<expected<void>> _prepared;
+      std::vector<std::pair<std::size_t, Repo2SolvJob>> _jobs;  //< repo index and deferred job
+    };
+  }
+
+  AsyncOpRef<std::vector<std::pair<RepoInfo, expected<void>>>> buildCache( AsyncRepoManagerRef mgr, std::vector<RepoInfo> infos, zypp::RepoManagerFlags::CacheBuildPolicy policy, ProgressObserverRef progressObserver )
+  {
+    return SimpleExecutor<BuildCachesLogic, AsyncOp<std::vector<std::pair<RepoInfo, expected<void>>>>>::run( std::move(mgr), std::move(infos), policy, std::move(progressObserver) );
+  }
+
+  std::vector<std::pair<RepoInfo, expected<void>>> buildCache( SyncRepoManagerRef mgr, std::vector<RepoInfo> infos, zypp::RepoManagerFlags::CacheBuildPolicy policy, ProgressObserverRef progressObserver )
+  {
+    return SimpleExecutor<BuildCachesLogic, SyncOp<std::vector<std::pair<RepoInfo, expected<void>>>>>::run( std::move(mgr), std::move(infos), policy, std::move(progressObserver) );
+  }
+
+  unsigned buildCacheJobsPeak()
+  { return repo2SolvJobsPeak; }
+
 
   // Add repository logic
   namespace {
@@ -56,6 +56,20 @@ namespace zyppng {
     AsyncOpRef<expected<repo::AsyncRefreshContextRef> > buildCache( repo::AsyncRefreshContextRef refCtx, zypp::RepoManagerFlags::CacheBuildPolicy policy, ProgressObserverRef progressObserver = nullptr );
     expected<repo::SyncRefreshContextRef> buildCache( repo::SyncRefreshContextRef refCtx, zypp::RepoManagerFlags::CacheBuildPolicy policy, ProgressObserverRef progressObserver = nullptr );
 
+    /*!
+     * Build the caches of all repos in \a infos, running up to
+     * \ref RepoManagerOptions::buildCacheMaxConcurrentJobs repo2solv processes in parallel.
+     * Returns the result for each repo.
+     */
+    AsyncOpRef<std::vector<std::pair<RepoInfo, expected<void>>>> buildCache( AsyncRepoManagerRef mgr, std::vector<RepoInfo> infos, zypp::RepoManagerFlags::CacheBuildPolicy policy, ProgressObserverRef progressObserver = nullptr );
+    std::vector<std::pair<RepoInfo, expected<void>>> buildCache( SyncRepoManagerRef mgr, std::vector<RepoInfo> infos, zypp::RepoManagerFlags::CacheBuildPolicy policy, ProgressObserverRef progressObserver = nullptr );
+
+    /*!
+     * The most repo2solv jobs the last batched \ref buildCache ran at the same time.
+     * Lets tests check that \ref RepoManagerOptions::buildCacheMaxConcurrentJobs is honoured.
+     */
+    unsigned buildCacheJobsPeak();
+
     AsyncOpRef<expected<RepoInfo>> addRepository( AsyncRepoManagerRef mgr, RepoInfo info, ProgressObserverRef myProgress = nullptr );
     expected<RepoInfo> addRepository( SyncRepoManagerRef mgr, const RepoInfo &info, ProgressObserverRef myProgress = nullptr );
 
@@ -31,14 +31,21 @@
 #include <zypp/repo/PluginServices.h>
 
 #include <zypp/ng/reporthelper.h>
+#include <zypp/ng/context.h>
 #include <zypp/ng/repo/refresh.h>
 #include <zypp/ng/repo/workflows/repomanagerwf.h>
 #include <zypp/ng/repo/workflows/serviceswf.h>
 #include <zypp/ng/workflows/contextfacade.h>
 
+#include <algorithm>
+#include <atomic>
 #include <fstream>
+#include <thread>
 #include <utility>
 
+#include <fcntl.h>
+#include <unistd.h>
+
 #undef ZYPP_BASE_LOGGER_LOGGROUP
 #define ZYPP_BASE_LOGGER_LOGGROUP "zypp::repomanager"
 
@@ -96,6 +103,51 @@ namespace zyppng
         }
       }
     }
+
+    /** Read files into the page cache by some threads in the background, in the given order.
+     * libsolv can not parse into the same pool from several threads, but while one solv
+     * file is parsed the next ones are read. The threads are stopped and joined by the dtor.
+     */
+    class ReadAhead
+    {
+    public:
+      ReadAhead( std::vector<zypp::Pathname> files_r )
+        : _files( std::move(files_r) )
+      {
+        unsigned threads = std::min<size_t>( _files.size(), std::max( std::thread::hardware_concurrency(), 1U ) );
+        for ( unsigned i = 0; i < threads; ++i )
+          _threads.emplace_back( [this]() { run(); } );
+      }
+
+      ReadAhead( const ReadAhead & ) = delete;
+      ReadAhead & operator=( const ReadAhead & ) = delete;
+
+      ~ReadAhead()
+      {
+        _stop = true;
+        for ( std::thread & thread : _threads )
+          thread.join();
+      }
+
+    private:
+      void run()
+      {
+        std::vector<char> buffer( 1024 * 1024 );
+        for ( size_t idx = _next++; idx < _files.size() && ! _stop; idx = _next++ )
+        {
+          zypp::AutoFD fd { ::open( _files[idx].c_str(), O_RDONLY | O_CLOEXEC ) };
+          if ( fd == -1 )
+            continue;
+          while ( ! _stop && ::read( fd, buffer.data(), buffer.size() ) > 0 )
+            ;
+        }
+      }
+
+      std::vector<zypp::Pathname> _files;
+      std::vector<std::thread> _threads;
+      std::atomic<size_t> _next = 0;
+      std::atomic<bool> _stop = false;
+    };
   } // namespace
 
   std::ostream & operator<<( std::ostream & str, zypp::RepoManagerFlags::RawMetadataRefreshPolicy obj )
@@ -568,6 +620,34 @@ namespace zyppng
     ;
   }
 
+  template <typename ZyppContextRefType>
+  std::vector<std::pair<RepoInfo, expected<void>>> RepoManager<ZyppContextRefType>::loadFromCache( std::vector<RepoInfo> infos, ProgressObserverRef myProgress )
+  {
+    ProgressObserver::setup( myProgress, _("Loading from cache"), infos.size() );
+    ProgressObserver::start( myProgress );
+
+    std::vector<zypp::Pathname> solvfiles;
+    for ( const RepoInfo & info : infos ) {
+      if ( auto path = solv_path_for_repoinfo( _options, info ) )
+        solvfiles.push_back( *path / "solv" );
+    }
+    ReadAhead readAhead( std::move(solvfiles) );
+
+    std::vector<std::pair<RepoInfo, expected<void>>> res;
+    res.reserve( infos.size() );
+    bool success = true;
+    for ( RepoInfo & info : infos ) {
+      auto loaded = loadFromCache( info, ProgressObserver::makeSubTask( myProgress ) );
+      success = bool(loaded);
+      res.push_back( std::make_pair( std::move(info), std::move(loaded) ) );
+      if ( !success )
+        break;  // like loading them one by one, the remaining repos are not loaded
+    }
+
+    ProgressObserver::finish( myProgress, success ? ProgressObserver::Success : ProgressObserver::Error );
+    return res;
+  }
+
   template <typename ZyppContextRefType>
   expected<RepoInfo> RepoManager<ZyppContextRefType>::addProbedRepository( RepoInfo info, zypp::repo::RepoType probedType )
   {
@@ -879,17 +959,102 @@ namespace zyppng
     }));
   }
 
+  namespace {
+    /** Whether the metadata of \a info is downloaded, rather than read from a local medium. */
+    bool isDownloadingRepo( const RepoInfo &info )
+    { return ! info.baseUrlsEmpty() && info.url().schemeIsDownloading(); }
+
+    /**
+     * Refresh \a infos in the async RepoManager \a asyncMgr, its Provide instance downloads the
+     * metadata of all repos concurrently. User requests are answered via the legacy reports.
+     */
+    expected<std::vector<std::pair<RepoInfo, expected<void>>>> refreshMetadataConcurrently( AsyncRepoManager &asyncMgr, std::vector<RepoInfo> infos, zypp::RepoManagerFlags::RawMetadataRefreshPolicy policy, ProgressObserverRef myProgress )
+    {
+      try {
+        std::vector<connection> legacyReports { connectLegacyReports( asyncMgr.zyppContext() ) };
+        zypp::OnScopeExit disconnect( [&legacyReports]() {
+          for ( auto &conn : legacyReports )
+            conn.disconnect();
+        });
+        return make_expected_success( asyncMgr.refreshMetadata( std::move(infos), policy, std::move(myProgress) ) );
+      } catch ( const zypp::Exception &e ) {
+        ZYPP_CAUGHT( e );
+        return expected<std::vector<std::pair<RepoInfo, expected<void>>>>::error( std::current_exception() );
+      } catch ( ... ) {
+        return expected<std::vector<std::pair<RepoInfo, expected<void>>>>::error( std::current_exception() );
+      }
+    }
+  }
+
+  template<typename ZyppContextRefType>
+  expected<void> RepoManager<ZyppContextRefType>::setConcurrentRefreshContext( ContextRef ctx )
+  {
+    if constexpr ( std::is_same_v<ZyppContextRefType, SyncContextRef> ) {
+      _concurrentRefreshMgr.reset();
+      if ( ! ctx )
+        return expected<void>::success();
+
+      auto asyncMgr = AsyncRepoManager::create( std::move(ctx), _options );
+      if ( ! asyncMgr )
+        return expected<void>::error( asyncMgr.error() );
+      _concurrentRefreshMgr = std::move( *asyncMgr );
+    }
+    return expected<void>::success();
+  }
+
   template<typename ZyppContextRefType>
   std::vector<std::pair<RepoInfo, expected<void>>> RepoManager<ZyppContextRefType>::refreshMetadata( std::vector<RepoInfo> infos, RawMetadataRefreshPolicy policy, ProgressObserverRef myProgress )
   {
     using namespace zyppng::operators;
 
+    if constexpr ( std::is_same_v<ZyppContextRefType, SyncContextRef> ) {
+      // The blocking media backend fetches one file after the other. If the application opted in,
+      // downloading repos are refreshed concurrently in its async context, local media stay with
+      // the sync context.
+      const auto remoteCnt = std::count_if( infos.begin(), infos.end(), isDownloadingRepo );
+      if ( _concurrentRefreshMgr && remoteCnt > 1 ) {
+        std::vector<RepoInfo> remote;
+        std::vector<RepoInfo> local;
+        for ( const auto &info : infos )
+          ( isDownloadingRepo( info ) ? remote : local ).push_back( info );
+
+        ProgressObserver::setup( myProgress, "Refreshing repositories" , infos.size() );
+        auto remoteRes = refreshMetadataConcurrently( *_concurrentRefreshMgr, std::move(remote), policy, ProgressObserver::makeSubTask( myProgress, remoteCnt ) );
+        if ( remoteRes ) {
+          std::vector<std::pair<RepoInfo, expected<void>>> localRes;
+          if ( ! local.empty() )
+            localRes = refreshMetadata( std::move(local), policy, ProgressObserver::makeSubTask( myProgress, local.size() ) );
+
+          // merge the results in the order of infos
+          std::vector<std::pair<RepoInfo, expected<void>>> res;
+          auto remoteIt = remoteRes->begin();
+          auto localIt = localRes.begin();
+          for ( const auto &info : infos ) {
+            if ( isDownloadingRepo( info ) ) {
+              if ( remoteIt->second && ! isTmpRepo( info ) )
+                reposManip();	// remember to trigger appdata refresh
+              res.push_back( std::move( *(remoteIt++) ) );
+            }
+            else
+              res.push_back( std::move( *(localIt++) ) );
+          }
+
+          ProgressObserver::finish( myProgress, ProgressObserver::Success );
+          return res;
+        }
+        WAR << "Unable to refresh concurrently, refreshing one repo after the other." << std::endl;
+      }
+    }
+
     ProgressObserver::setup( myProgress, "Refreshing repositories" , 1 );
 
+    // First refresh the metadata of all repos. For the async context this is done concurrently,
+    // the Provide scheduler shares the download workers and enforces the per host connection limits.
+    // The caches of the refreshed repos are built afterwards in one go, running repo2solv in parallel.
     auto r = std::move(infos)
         | transform( [this, policy, myProgress]( const RepoInfo &info ) {
 
-        auto subProgress = ProgressObserver::makeSubTask( myProgress, 1.0, zypp::str::Str() << _("Refreshing Repository: ") << info.alias(), 3 );
+        auto subProgress = ProgressObserver::makeSubTask( myProgress, 1.0, zypp::str::Str() << _("Refreshing Repository: ") << info.alias(), 2 );
 
         // helper callback in case the repo type changes on the remote
         // do NOT capture by reference here, since this is possibly executed async
@@ -922,29 +1087,44 @@ namespace zyppng
             return zyppng::RepoManagerWorkflow::refreshMetadata ( std::move(refCtx), ProgressObserver::makeSubTask( subProgress ) );
           })
           | inspect( incProgress( subProgress ) )
-          | and_then([subProgress]( repo::RefreshContextRef<ZyppContextRefType> ctx ) {
-
-            if ( ! isTmpRepo( ctx->repoInfo() ) )
-              ctx->repoManager()->reposManip();	// remember to trigger appdata refresh
-
-            return zyppng::RepoManagerWorkflow::buildCache ( std::move(ctx), CacheBuildPolicy::BuildIfNeeded, ProgressObserver::makeSubTask( subProgress ) );
-          })
-          | inspect( incProgress( subProgress ) )
           | [ info = info, subProgress ]( expected<repo::RefreshContextRef<ZyppContextRefType>> result ) {
             if ( result ) {
+              if ( ! isTmpRepo( (*result)->repoInfo() ) )
+                (*result)->repoManager()->reposManip();	// remember to trigger appdata refresh
+
               ProgressObserver::finish( subProgress, ProgressObserver::Success );
-              return std::make_pair(info, expected<void>::success() );
+              // the refreshed RepoInfo, the probe may have updated the type
+              return std::make_pair( (*result)->repoInfo(), expected<void>::success() );
             } else {
               ProgressObserver::finish( subProgress, ProgressObserver::Error );
               return std::make_pair(info, expected<void>::error( result.error() ) );
             }
           };
+      })
+      | [this, myProgress]( std::vector<std::pair<RepoInfo, expected<void>>> refreshed ) {
+
+        std::vector<RepoInfo> toBuild;
+        for ( const auto &res : refreshed ) {
+          if ( res.second )
+            toBuild.push_back( res.first );
+        }
+
+        return RepoManagerWorkflow::buildCache( shared_this<RepoManager<ZyppContextRefType>>(), std::move(toBuild), CacheBuildPolicy::BuildIfNeeded, ProgressObserver::makeSubTask( myProgress ) )
+        | [ refreshed = std::move(refreshed) ]( std::vector<std::pair<RepoInfo, expected<void>>> built ) mutable {
+          // built contains the results of the successfully refreshed repos in the same order
+          auto builtIt = built.begin();
+          for ( auto &res : refreshed ) {
+            if ( res.second && builtIt != built.end() )
+              res.second = std::move( (builtIt++)->second );
+          }
+          return std::move(refreshed);
+        };
       }
       | [myProgress]( auto res ) {
         ProgressObserver::finish( myProgress, ProgressObserver::Success );
         return res;
       }
-    );
+    ;
 
     return joinPipeline( _zyppContext, r );
   }
@@ -980,6 +1160,12 @@ namespace zyppng
     );
   }
 
+  template<typename ZyppContextRefType>
+  std::vector<std::pair<RepoInfo, expected<void>>> RepoManager<ZyppContextRefType>::buildCache( std::vector<RepoInfo> infos, CacheBuildPolicy policy, ProgressObserverRef myProgress )
+  {
+    return joinPipeline( _zyppContext, RepoManagerWorkflow::buildCache( shared_this<RepoManager<ZyppContextRefType>>(), std::move(infos), policy, std::move(myProgress) ) );
+  }
+
   template<typename ZyppContextRefType>
   expected<RepoInfo> RepoManager<ZyppContextRefType>::addRepository(const RepoInfo &info, ProgressObserverRef myProgress)
   {
@@ -366,6 +366,14 @@ namespace zyppng {
 
     expected<void> loadFromCache( const RepoInfo & info, ProgressObserverRef myProgress = nullptr );
 
+    /*!
+     * Load the repos in \a infos from their caches. The solv files are read ahead
+     * by background threads while the repos are added to the pool one after the other.
+     * Returns the result for each repo tried. Loading stops at the first repo that fails,
+     * so only the last result can be an error.
+     */
+    std::vector<std::pair<RepoInfo, expected<void> > > loadFromCache( std::vector<RepoInfo> infos, ProgressObserverRef myProgress = nullptr );
+
     expected<RepoInfo> addProbedRepository( RepoInfo info, zypp::repo::RepoType probedType );
 
     expected<void> removeRepository( const RepoInfo & info, ProgressObserverRef myProgress = nullptr );
@@ -396,12 +404,38 @@ namespace zyppng {
      */
     expected<void> refreshMetadata( const RepoInfo & info, RawMetadataRefreshPolicy policy, ProgressObserverRef myProgress = nullptr  );
 
+    /*!
+     * Refresh the metadata of all repos in \a infos, then build the caches of the
+     * refreshed repos in one batch. Returns the result for each repo, in the order of \a infos.
+     *
+     * The async RepoManager downloads the metadata of all repos concurrently. The sync
+     * one refreshes one repo after the other, unless \ref setConcurrentRefreshContext was used.
+     */
     std::vector<std::pair<RepoInfo, expected<void> > > refreshMetadata(std::vector<RepoInfo> infos, RawMetadataRefreshPolicy policy, ProgressObserverRef myProgress = nullptr  );
 
+    /*!
+     * Opt in to refresh several downloading repos concurrently in the sync RepoManager.
+     * \ref refreshMetadata hands them to an \ref AsyncRepoManager running in \a ctx, whose
+     * Provide instance downloads the metadata of all repos at once. While it runs, the user
+     * requests of \a ctx are answered via the legacy reports (\ref connectLegacyReports).
+     * Local media are still refreshed by the sync context.
+     *
+     * Passing \c nullptr restores the default, refreshing one repo after the other.
+     * The async RepoManager ignores this, it always refreshes concurrently.
+     */
+    expected<void> setConcurrentRefreshContext( ContextRef ctx );
+
     expected<zypp::repo::RepoType> probe( const zypp::Url & url, const zypp::Pathname & path = zypp::Pathname() ) const;
 
     expected<void> buildCache( const RepoInfo & info, CacheBuildPolicy policy, ProgressObserverRef myProgress = nullptr );
 
+    /*!
+     * Build the caches of all repos in \a infos. The repo2solv processes of up to
+     * \ref RepoManagerOptions::buildCacheMaxConcurrentJobs repos run in parallel.
+     * Returns the result for each repo.
+     */
+    std::vector<std::pair<RepoInfo, expected<void> > > buildCache( std::vector<RepoInfo> infos, CacheBuildPolicy policy, ProgressObserverRef myProgress = nullptr );
+
     /*!
      * Adds the repository in \a info and returns the updated \ref RepoInfo object.
      */
@@ -504,6 +538,7 @@ namespace zyppng {
     ServiceSet		_services;
     zypp_private::repo::PluginRepoverification _pluginRepoverification;
     zypp::DefaultIntegral<bool,false> _reposDirty;
+    AsyncRepoManagerRef _concurrentRefreshMgr;	///< sync only: refreshes downloading repos if set
   };
 }
 
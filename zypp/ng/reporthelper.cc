@@ -11,6 +11,8 @@
 
 #include <zypp/Digest.h>
 #include <zypp/ng/userrequest.h>
+#include <zypp-media/ng/Provide>
+#include <zypp-media/auth/AuthData>
 
 namespace zyppng {
 
@@ -246,6 +248,134 @@ namespace zyppng {
     }
   }
 
+  namespace {
+    void forwardBooleanChoice( BooleanChoiceRequest &req, const std::string &ctype, const UserData &data )
+    {
+      if ( ctype == AcceptNoDigestRequest::CTYPE ) {
+        zypp::callback::SendReport<zypp::DigestReport> report;
+        req.setChoice( report->askUserToAcceptNoDigest( data.get<zypp::Pathname>( AcceptNoDigestRequest::FILE.data() ) ) );
+      }
+      else if ( ctype == AcceptUnknownDigestRequest::CTYPE ) {
+        // AcceptWrongDigestRequest shares the type, it is told apart by its fields
+        zypp::callback::SendReport<zypp::DigestReport> report;
+        if ( data.haskey( AcceptWrongDigestRequest::NAME_REQUESTED.data() ) )
+          req.setChoice( report->askUserToAcceptWrongDigest( data.get<zypp::Pathname>( AcceptWrongDigestRequest::FILE.data() ),
+                                                             data.get<std::string>( AcceptWrongDigestRequest::NAME_REQUESTED.data() ),
+                                                             data.get<std::string>( AcceptWrongDigestRequest::NAME_FOUND.data() ) ) );
+        else
+          req.setChoice( report->askUserToAccepUnknownDigest( data.get<zypp::Pathname>( AcceptUnknownDigestRequest::FILE.data() ),
+                                                              data.get<std::string>( AcceptUnknownDigestRequest::NAME.data() ) ) );
+      }
+      else if ( ctype == AcceptUnsignedFileRequest::CTYPE ) {
+        zypp::callback::SendReport<zypp::KeyRingReport> report;
+        req.setChoice( report->askUserToAcceptUnsignedFile( data.get<std::string>( AcceptUnsignedFileRequest::FILE.data() ),
+                                                            data.get<zypp::KeyContext>( AcceptUnsignedFileRequest::KEY_CONTEXT.data() ) ) );
+      }
+      else if ( ctype == AcceptUnknownKeyRequest::CTYPE ) {
+        zypp::callback::SendReport<zypp::KeyRingReport> report;
+        req.setChoice( report->askUserToAcceptUnknownKey( data.get<std::string>( AcceptUnknownKeyRequest::FILE.data() ),
+                                                          data.get<std::string>( AcceptUnknownKeyRequest::KEYID.data() ),
+                                                          data.get<zypp::KeyContext>( AcceptUnknownKeyRequest::KEY_CONTEXT.data() ) ) );
+      }
+      else if ( ctype == AcceptFailedVerificationRequest::CTYPE ) {
+        zypp::callback::SendReport<zypp::KeyRingReport> report;
+        req.setChoice( report->askUserToAcceptVerificationFailed( data.get<std::string>( AcceptFailedVerificationRequest::FILE.data() ),
+                                                                  data.get<zypp::PublicKey>( AcceptFailedVerificationRequest::KEY.data() ),
+                                                                  data.get<zypp::KeyContext>( AcceptFailedVerificationRequest::KEY_CONTEXT.data() ) ) );
+      }
+      else {
+        WAR << "No legacy report for " << ctype << ", keeping the default answer: " << req.label() << std::endl;
+      }
+    }
+
+    void forwardMessage( ShowMessageRequest &req, const std::string &ctype, const UserData &data )
+    {
+      if ( ctype == VerifyInfoEvent::CTYPE ) {
+        zypp::callback::SendReport<zypp::KeyRingReport> report;
+        report->infoVerify( data.get<std::string>( VerifyInfoEvent::FILE.data() ),
+                            data.get<zypp::PublicKeyData>( VerifyInfoEvent::KEY_DATA.data() ),
+                            data.get<zypp::KeyContext>( VerifyInfoEvent::KEY_CONTEXT.data() ) );
+        return;
+      }
+      if ( ctype == KeyAutoImportInfoEvent::CTYPE ) {
+        zypp::callback::SendReport<zypp::KeyRingReport> report;
+        report->reportAutoImportKey( *data.get<const std::list<zypp::PublicKeyData> *>( KeyAutoImportInfoEvent::KEY_DATA_LIST.data() ),
+                                     data.get<zypp::PublicKeyData>( KeyAutoImportInfoEvent::KEY_DATA.data() ),
+                                     data.get<zypp::KeyContext>( KeyAutoImportInfoEvent::KEY_CONTEXT.data() ) );
+        return;
+      }
+
+      switch ( req.messageType() ) {
+        case ShowMessageRequest::MType::Debug:
+          zypp::JobReport::debug( req.message(), data );
+          break;
+        case ShowMessageRequest::MType::Info:
+          zypp::JobReport::info( req.message(), data );
+          break;
+        case ShowMessageRequest::MType::Warning:
+          zypp::JobReport::warning( req.message(), data );
+          break;
+        case ShowMessageRequest::MType::Error:
+          zypp::JobReport::error( req.message(), data );
+          break;
+        case ShowMessageRequest::MType::Important:
+          zypp::JobReport::important( req.message(), data );
+          break;
+        case ShowMessageRequest::MType::Data:
+          zypp::JobReport::data( req.message(), data );
+          break;
+      }
+    }
+  }
+
+  std::vector<connection> connectLegacyReports( const ContextRef &ctx )
+  {
+    std::vector<connection> conns;
+
+    conns.push_back( ctx->sigEvent().connect( []( UserRequestRef req ) {
+      const std::string ctype { req->userData().type().asString() };
+      switch ( req->type() ) {
+        case UserRequestType::Message:
+          forwardMessage( static_cast<ShowMessageRequest &>(*req), ctype, req->userData() );
+          break;
+        case UserRequestType::BooleanChoice:
+          forwardBooleanChoice( static_cast<BooleanChoiceRequest &>(*req), ctype, req->userData() );
+          break;
+        case UserRequestType::KeyTrust: {
+          auto &r = static_cast<TrustKeyRequest &>(*req);
+          if ( ctype == AcceptKeyRequest::CTYPE ) {
+            zypp::callback::SendReport<zypp::KeyRingReport> report;
+            r.setChoice( static_cast<TrustKeyRequest::KeyTrust>( report->askUserToAcceptKey( r.userData().get<zypp::PublicKey>( AcceptKeyRequest::KEY.data() ),
+                                                                                              r.userData().get<zypp::KeyContext>( AcceptKeyRequest::KEY_CONTEXT.data() ) ) ) );
+          }
+          break;
+        }
+        case UserRequestType::ListChoice: {
+          auto &r = static_cast<ListChoiceRequest &>(*req);
+          std::vector<std::pair<std::string,std::string>> answers;
+          for ( const auto &answer : r.answers() )
+            answers.emplace_back( answer.opt, answer.detail );
+          r.setChoice( zypp::JobReport::listChoice( r.label(), answers, r.defaultAnswer(), r.userData() ) );
+          break;
+        }
+        case UserRequestType::Custom:
+          break;
+      }
+    }) );
+
+    conns.push_back( ctx->provider()->sigAuthRequired().connect( []( const zypp::Url &reqUrl, const std::string &triedUsername, const std::map<std::string, std::string> & ) -> std::optional<zypp::media::AuthData> {
+      zypp::callback::SendReport<zypp::media::AuthenticationReport> report;
+      zypp::media::AuthData auth( reqUrl );
+      auth.setUsername( triedUsername );
+      std::string prompt_msg = zypp::str::Format(_("Authentication required for '%s'")) % reqUrl.asString();
+      if ( report->prompt( reqUrl, prompt_msg, auth ) && auth.valid() )
+        return auth;
+      return std::nullopt;
+    }) );
+
+    return conns;
+  }
+
   // explicitely intantiate the template types we want to work with
   template class BasicReportHelper<SyncContextRef>;
   template class BasicReportHelper<ContextRef>;
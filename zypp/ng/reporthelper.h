@@ -163,6 +163,16 @@ namespace zyppng {
     bool data( std::string msg_r, UserData userData_r = UserData() );
 
   };
+
+  /*!
+   * Answer the user requests and authentication requests of the async context \a ctx
+   * via the legacy zypp callbacks. This lets sync code run an async workflow in a private
+   * context without changing what the application sees. List choices are asked via
+   * \ref zypp::JobReport::listChoice. Custom requests keep their default answer.
+   *
+   * The returned connections are to be disconnected when the workflow is done.
+   */
+  std::vector<connection> connectLegacyReports( const ContextRef &ctx );
 }
 
 
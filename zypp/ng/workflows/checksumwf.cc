@@ -41,11 +41,12 @@ namespace zyppng::CheckSumWorkflow {
     using MediaHandle     = typename ProvideType::MediaHandle;
     using ProvideRes      = typename ProvideType::Res;
 
-    CheckSumWorkflowLogic( ZyppContextRefType zyppContext, zypp::CheckSum &&checksum, zypp::Pathname file )
+    CheckSumWorkflowLogic( ZyppContextRefType zyppContext, zypp::CheckSum &&checksum, zypp::Pathname file, zypp::CheckSum &&downloadedChecksum = zypp::CheckSum() )
       : _context( std::move(zyppContext) )
       , _report( _context )
       , _checksum(std::move( checksum ))
       , _file(std::move( file ))
+      , _downloadedChecksum(std::move( downloadedChecksum ))
       {}
 
     auto execute()
@@ -63,7 +64,12 @@ namespace zyppng::CheckSumWorkflow {
 
       } else {
 
-        return _context->provider()->checksumForFile ( _file, _checksum.type() )
+        // the checksum calculated by the worker while it downloaded the file spares reading it again
+        auto realChecksum = ( _downloadedChecksum.type() == _checksum.type() )
+          ? makeReadyResult( expected<zypp::CheckSum>::success( _downloadedChecksum ) )
+          : _context->provider()->checksumForFile ( _file, _checksum.type() );
+
+        return std::move(realChecksum)
           | [] ( expected<zypp::CheckSum> sum ) {
             if ( !sum )
               return zypp::CheckSum( );
@@ -109,6 +115,7 @@ namespace zyppng::CheckSumWorkflow {
     DigestReportHelper<ZyppContextRefType> _report;
     zypp::CheckSum _checksum;
     zypp::Pathname _file;
+    zypp::CheckSum _downloadedChecksum;
 
   };
 
@@ -126,7 +133,7 @@ namespace zyppng::CheckSumWorkflow {
   {
     using zyppng::operators::operator|;
     return [ zyppCtx, checksum=std::move(checksum) ]( ProvideRes res ) mutable -> AsyncOpRef<expected<ProvideRes>> {
-      return verifyChecksum( zyppCtx, std::move(checksum), res.file() )
+      return SimpleExecutor<CheckSumWorkflowLogic, AsyncOp<expected<void>>>::run( zyppCtx, std::move(checksum), res.file(), res.downloadedChecksum() )
        | [ res ] ( expected<void> result ) mutable {
           if ( result )
             return expected<ProvideRes>::success( std::move(res) );
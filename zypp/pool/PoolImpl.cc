@@ -13,6 +13,7 @@
 #include <zypp/base/LogTools.h>
 
 #include <zypp/pool/PoolImpl.h>
+#include <zypp/sat/detail/PoolImpl.h>
 
 using std::endl;
 
@@ -52,6 +53,146 @@ namespace zypp
     PoolImpl::~PoolImpl()
     {}
 
+    ///////////////////////////////////////////////////////////////////
+    //
+    //	METHOD NAME : PoolImpl::updateStore
+    //	METHOD TYPE : void
+    //
+    void PoolImpl::updateStore() const
+    {
+      static const PoolItem noItem;
+      sat::Pool pool( satpool() );
+      sat::detail::PoolImpl & satpoolimpl( sat::detail::PoolMember::myPool() );
+
+      bool reusedIDs = _watcherIDs.remember( pool.serialIDs() );
+      std::vector<sat::detail::PoolImpl::SolvableIdRange> ranges;
+      if ( reusedIDs || _store.empty()
+        || ! satpoolimpl.changedRangesSince( _storeChangedRangesPos, ranges ) )
+      {
+        // rescan all
+        ranges.clear();
+        ranges.push_back( sat::detail::PoolImpl::SolvableIdRange( 1, std::max( size_type(pool.capacity()), _store.size() ) ) );
+      }
+      _storeChangedRangesPos = satpoolimpl.changedRangesEnd();
+
+      if ( reusedIDs )
+      {
+        // all PoolItems are to be replaced
+        _id2itemDirty = true;
+        _id2item.clear();
+      }
+
+      std::vector<SolvableIdType> addedIDs;
+      std::list<PoolItem> addedProducts;
+      if ( _store.size() < pool.capacity() )
+        _store.resize( pool.capacity() );
+
+      for ( const auto & range : ranges )
+      {
+        SolvableIdType rend = std::min( size_type(range.second), _store.size() );
+        for ( SolvableIdType i = std::max( range.first, SolvableIdType(1) ); i < rend; ++i )
+        {
+          sat::Solvable s( i );
+          PoolItem & pi( _store[i] );
+          if ( s )
+          {
+            if ( reusedIDs || pi == noItem )
+            {
+              // new PoolItem to add
+              addedIDs.push_back( i );
+            }
+          }
+          else if ( pi != noItem )
+          {
+            // the PoolItem got invalidated (e.g unloaded repo)
+            if ( ! _id2itemDirty )
+              id2itemErase( i );
+            pi = PoolItem();
+          }
+        }
+      }
+      if ( _store.size() > pool.capacity() )
+        _store.resize( pool.capacity() );
+
+      // Create all new PoolItems in one chunk; the ResObjects are created on demand.
+      std::sort( addedIDs.begin(), addedIDs.end() );
+      addedIDs.erase( std::unique( addedIDs.begin(), addedIDs.end() ), addedIDs.end() );	// ranges may overlap
+      PoolItem::makePoolItems( _store, addedIDs ); // the only way to create a new one!
+      for ( SolvableIdType i : addedIDs )
+      {
+        const PoolItem & pi( _store[i] );
+        // remember products for buddy processing (requires clean store)
+        if ( pi.isKind( ResKind::product ) )
+          addedProducts.push_back( pi );
+        if ( ! _id2itemDirty )
+          id2itemInsert( pi );
+      }
+      _storeDirty = false;
+      DBG << "Store updated: " << ranges.size() << " ranges, " << addedIDs.size() << " new items" << endl;
+
+      // Now, as the pool is adjusted, ....
+
+      // .... we check for product buddies.
+      if ( ! addedProducts.empty() )
+      {
+        for_( it, addedProducts.begin(), addedProducts.end() )
+        {
+          it->setBuddy( asKind<Product>(*it)->referencePackage() );
+        }
+      }
+
+      // .... we must reapply those query based hard locks.
+      if ( ! addedIDs.empty() )
+      {
+        reapplyHardLocks( addedIDs );
+      }
+
+      // Compute the initial status of Patches etc.
+      if ( !_establishedStates )
+        _establishedStates.reset( new EstablishedStatesImpl );
+    }
+
+    ///////////////////////////////////////////////////////////////////
+    //
+    //	METHOD NAME : PoolImpl::id2itemInsert
+    //	METHOD TYPE : void
+    //
+    void PoolImpl::id2itemInsert( const PoolItem & pi_r ) const
+    {
+      const sat::Solvable & s( pi_r.satSolvable() );
+      sat::detail::IdType id = s.ident().id();
+      if ( s.isKind( ResKind::srcpackage ) )
+        id = -id;
+      _id2item.insert( std::make_pair( id, pi_r ) );
+
+      if ( _id2itemKeys.size() <= s.id() )
+        _id2itemKeys.resize( _store.size() > s.id() ? _store.size() : s.id()+1, sat::detail::noId );
+      _id2itemKeys[s.id()] = id;
+    }
+
+    ///////////////////////////////////////////////////////////////////
+    //
+    //	METHOD NAME : PoolImpl::id2itemErase
+    //	METHOD TYPE : void
+    //
+    void PoolImpl::id2itemErase( SolvableIdType id_r ) const
+    {
+      if ( id_r >= _id2itemKeys.size() || _id2itemKeys[id_r] == sat::detail::noId )
+        return;
+
+      const PoolItem & pi( _store[id_r] );
+      auto range( _id2item.equal_range( _id2itemKeys[id_r] ) );
+      for ( auto it = range.first; it != range.second; ++it )
+      {
+        if ( it->second == pi )
+        {
+          _id2item.erase( it );
+          break;
+        }
+      }
+      _id2itemKeys[id_r] = sat::detail::noId;
+    }
+
     /////////////////////////////////////////////////////////////////
   } // namespace pool
   ///////////////////////////////////////////////////////////////////
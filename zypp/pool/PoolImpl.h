@@ -284,12 +284,14 @@ namespace zypp
         const HardLockQueries & hardLockQueries() const
         { return _hardLockQueries; }
 
-        void reapplyHardLocks() const
+        void reapplyHardLocks( const std::vector<SolvableIdType> & addedIDs_r ) const
         {
           // It is assumed that reapplyHardLocks is called after new
           // items were added to the pool, but the _hardLockQueries
           // did not change since. Action is to be performed only on
           // those items that gained the bit in the UserLockQueryField.
+          if ( _hardLockQueries.empty() )
+            return;
           MIL << "Re-apply " << _hardLockQueries.size() << " HardLockQueries" << endl;
           PoolQueryResult locked;
           for_( it, _hardLockQueries.begin(), _hardLockQueries.end() )
@@ -297,11 +299,12 @@ namespace zypp
             locked += *it;
           }
           MIL << "HardLockQueries match " << locked.size() << " Solvables." << endl;
-          for_( it, begin(), end() )
+          for ( SolvableIdType id : addedIDs_r )
           {
             // NOTE bsc#1225267: While reapplyLock sets but never unsets a lock,
             // we don't need to care about buddies like in setHardLockQueries.
-            resstatus::UserLockQueryManip::reapplyLock( it->status(), locked.contains( *it ) );
+            const PoolItem & pi( _store[id] );
+            resstatus::UserLockQueryManip::reapplyLock( pi.status(), locked.contains( pi ) );
           }
         }
 
@@ -371,78 +374,19 @@ namespace zypp
         {
           checkSerial();
           if ( _storeDirty )
-          {
-            sat::Pool pool( satpool() );
-            bool addedItems = false;
-            bool reusedIDs = _watcherIDs.remember( pool.serialIDs() );
-            std::list<PoolItem> addedProducts;
-
-            _store.resize( pool.capacity() );
-
-            if ( pool.capacity() )
-            {
-              for ( sat::detail::SolvableIdType i = pool.capacity()-1; i != 0; --i )
-              {
-                sat::Solvable s( i );
-                PoolItem & pi( _store[i] );
-                if ( ! s &&  pi )
-                {
-                  // the PoolItem got invalidated (e.g unloaded repo)
-                  pi = PoolItem();
-                }
-                else if ( reusedIDs || (s && ! pi) )
-                {
-                  // new PoolItem to add
-                  pi = PoolItem::makePoolItem( s ); // the only way to create a new one!
-                  // remember products for buddy processing (requires clean store)
-                  if ( s.isKind( ResKind::product ) )
-                    addedProducts.push_back( pi );
-                  if ( !addedItems )
-                    addedItems = true;
-                }
-              }
-            }
-            _storeDirty = false;
-
-            // Now, as the pool is adjusted, ....
-
-            // .... we check for product buddies.
-            if ( ! addedProducts.empty() )
-            {
-              for_( it, addedProducts.begin(), addedProducts.end() )
-              {
-                it->setBuddy( asKind<Product>(*it)->referencePackage() );
-              }
-            }
-
-            // .... we must reapply those query based hard locks.
-            if ( addedItems )
-            {
-              reapplyHardLocks();
-            }
-
-            // Compute the initial status of Patches etc.
-            if ( !_establishedStates )
-              _establishedStates.reset( new EstablishedStatesImpl );
-          }
+            updateStore();
           return _store;
         }
 
         const Id2ItemT & id2item () const
         {
-          checkSerial();
+          store();	// patches the _id2item index unless it's dirty
           if ( _id2itemDirty )
           {
-            store();
             _id2item = Id2ItemT( size() );
+            _id2itemKeys.assign( _store.size(), sat::detail::noId );
             for_( it, begin(), end() )
-            {
-              const sat::Solvable &s = (*it)->satSolvable();
-              sat::detail::IdType id = s.ident().id();
-              if ( s.isKind( ResKind::srcpackage ) )
-                id = -id;
-              _id2item.insert( std::make_pair( id, *it ) );
-            }
+              id2itemInsert( *it );
             //INT << _id2item << endl;
             _id2itemDirty = false;
           }
@@ -462,13 +406,23 @@ namespace zypp
 
         void invalidate() const
         {
+          // _id2item is patched along with the _store
           _storeDirty = true;
-          _id2itemDirty = true;
-          _id2item.clear();
           _poolProxy.reset();
           _establishedStates.reset();
         }
 
+        /** Bring the _store in sync with the sat pool.
+         * Unless the sat pool reused its IDs, only the solvable ranges
+         * changed since the last update are visited.
+         */
+        void updateStore() const;
+
+        /** Add \a pi to the \ref _id2item index. */
+        void id2itemInsert( const PoolItem & pi_r ) const;
+        /** Remove the item at store index \a id_r from the \ref _id2item index. */
+        void id2itemErase( SolvableIdType id_r ) const;
+
       private:
         /** Watch sat pools serial number. */
         SerialNumberWatcher                   _watcher;
@@ -476,7 +430,11 @@ namespace zypp
         SerialNumberWatcher                   _watcherIDs;
         mutable ContainerT                    _store;
         mutable DefaultIntegral<bool,true>    _storeDirty;
+        /** Position in sat pools changed ranges the _store is in sync with. */
+        mutable DefaultIntegral<unsigned,0>   _storeChangedRangesPos;
         mutable Id2ItemT		      _id2item;
+        /** The _id2item key used for each _store index (the solvable is gone when the item is removed). */
+        mutable std::vector<sat::detail::IdType> _id2itemKeys;
         mutable DefaultIntegral<bool,true>    _id2itemDirty;
 
       private:
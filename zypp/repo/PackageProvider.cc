@@ -566,6 +566,12 @@ namespace zypp
 
     ManagedFile RpmPackageProvider::doProvidePackage() const
     {
+      // A package prefetched (maybe rebuilt from a delta rpm) by the CommitPackagePrefetcher
+      // is in the staging area, where the default provider picks it up.
+      const RepoInfo & info { _package->repoInfo() };
+      if ( PathInfo( RepoMediaAccess::stagingPath( info ) / info.path() / _package->location().filename() ).isFile() )
+        return Base::doProvidePackage();
+
       // check whether to process patch/delta rpms
       // FIXME we only check the first url for now.
       if ( ZConfig::instance().download_use_deltarpm()
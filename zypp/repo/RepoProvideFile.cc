@@ -244,6 +244,9 @@ namespace zypp
     const ProvideFilePolicy & RepoMediaAccess::defaultPolicy() const
     { return _impl->_defaultPolicy; }
 
+    Pathname RepoMediaAccess::stagingPath( const RepoInfo & repo_r )
+    { return repo_r.packagesPath() / ".staging"; }
+
     ManagedFile RepoMediaAccess::provideFile( const RepoInfo& repo_r,
                                               const OnMediaLocation & loc_rx,
                                               const ProvideFilePolicy & policy_r )
@@ -271,6 +274,13 @@ namespace zypp
       fetcher.addCachePath( repo_r.packagesPath() );
       MIL << "Added cache path " << repo_r.packagesPath() << endl;
 
+      // files downloaded in advance
+      if ( PathInfo( stagingPath( repo_r ) ).isDir() )
+      {
+        fetcher.addCachePath( stagingPath( repo_r ) );
+        MIL << "Added cache path " << stagingPath( repo_r ) << endl;
+      }
+
       // Test whether download destination is writable, if not
       // switch into the tmpspace (e.g. bnc#755239, download and
       // install srpms as user).
@@ -89,6 +89,14 @@ namespace zypp
       /** Get the current default \ref ProvideFilePolicy. */
       const ProvideFilePolicy & defaultPolicy() const;
 
+    public:
+      /** Directory where files of \a repo_r downloaded in advance are staged.
+       * \ref provideFile takes a file found there (by checksum) instead of
+       * downloading it again. It still passes the \ref ProvideFilePolicy::fileChecker.
+       * \see \ref target::CommitPackagePrefetcher
+       */
+      static Pathname stagingPath( const RepoInfo & repo_r );
+
    private:
       class Impl;
        RW_pointer<Impl> _impl;
@@ -0,0 +1,319 @@
+/*---------------------------------------------------------------------\
+|                          ____ _   __ __ ___                          |
+|                         |__  / \ / / . \ . \                         |
+|                           / / \ V /|  _/  _/                         |
+|                          / /__ | | | | | |                           |
+|                         /_____||_| |_| |_|                           |
+|                                                                      |
+\---------------------------------------------------------------------*/
+/** \file	zypp/repo/SolvfileBuilder.cc
+ *
+*/
+#include <cstdio>
+#include <iostream>
+#include <fstream>
+#include <list>
+#include <algorithm>
+
+#include <zypp/base/LogTools.h>
+#include <zypp/base/String.h>
+#include <zypp/base/Gettext.h>
+#include <zypp/base/Measure.h>
+#include <zypp-core/base/InputStream>
+#include <zypp/AutoDispose.h>
+#include <zypp/PathInfo.h>
+#include <zypp/parser/yum/RepomdFileReader.h>
+#include <zypp/repo/RepoException.h>
+#include <zypp/repo/SolvfileBuilder.h>
+
+extern "C"
+{
+#include <solv/pool.h>
+#include <solv/repo.h>
+#include <solv/repo_write.h>
+#include <solv/repo_rpmmd.h>
+#include <solv/repo_repomdxml.h>
+#include <solv/repo_updateinfoxml.h>
+#include <solv/repo_deltainfoxml.h>
+#include <solv/repo_susetags.h>
+#include <solv/repo_content.h>
+#include <solv/repo_autopattern.h>
+}
+
+using std::endl;
+
+#undef  ZYPP_BASE_LOGGER_LOGGROUP
+#define ZYPP_BASE_LOGGER_LOGGROUP "zypp::repo2solv"
+
+///////////////////////////////////////////////////////////////////
+namespace zypp
+{
+  ///////////////////////////////////////////////////////////////////
+  namespace repo
+  {
+    ///////////////////////////////////////////////////////////////////
+    namespace
+    {
+      /** \c fopencookie read function feeding libsolv from a \c std::istream. */
+      ssize_t istreamRead( void * cookie_r, char * buf_r, size_t size_r )
+      {
+        std::istream & str( *static_cast<std::istream *>(cookie_r) );
+        str.read( buf_r, size_r );
+        return str.bad() ? -1 : str.gcount();
+      }
+
+      ///////////////////////////////////////////////////////////////////
+      /// \class SolvInput
+      /// \brief A \c FILE* reading a (maybe gzip or zchunk compressed) metadata file via \ref InputStream.
+      ///////////////////////////////////////////////////////////////////
+      class SolvInput
+      {
+      public:
+        SolvInput( const Pathname & file_r )
+        : _input( assertNotZstd( file_r ) )
+        {
+          if ( ! _input.stream() )
+            ZYPP_THROW( RepoException( str::Format(_("Can't open file '%s' for reading.")) % file_r ) );
+
+          cookie_io_functions_t io { istreamRead, nullptr, nullptr, nullptr };
+          _fp = AutoFILE( ::fopencookie( &_input.stream(), "r", io ) );
+          if ( ! _fp )
+            ZYPP_THROW( RepoException( str::Format(_("Can't open file '%s' for reading.")) % file_r ) );
+        }
+
+        operator FILE *() const
+        { return _fp; }
+
+      private:
+        /** \ref InputStream is not able to decode zstd, we'd pass the compressed data to libsolv. */
+        static const Pathname & assertNotZstd( const Pathname & file_r )
+        {
+          if ( file_r.extension() == ".zst" )
+            ZYPP_THROW( RepoException( str::Format(_("Can't read zstd compressed file '%s'.")) % file_r ) );
+          return file_r;
+        }
+
+      private:
+        InputStream _input;
+        AutoFILE _fp;	// closed before _input
+      };
+
+      ///////////////////////////////////////////////////////////////////
+      /// \class SolvBuilder
+      /// \brief A private libsolv pool holding the one repo to build.
+      ///////////////////////////////////////////////////////////////////
+      class SolvBuilder
+      {
+      public:
+        SolvBuilder()
+        : _pool( ::pool_create() )
+        , _repo( ::repo_create( _pool, "repo2solv" ) )
+        {}
+
+        SolvBuilder( const SolvBuilder & ) = delete;
+        SolvBuilder & operator=( const SolvBuilder & ) = delete;
+
+        ~SolvBuilder()
+        { ::pool_free( _pool ); }
+
+        ::Pool * pool() const
+        { return _pool; }
+
+        /** Parse \a file_r by calling <tt>adder_r( repo, FILE* )</tt>. */
+        template <class Adder>
+        void add( const Pathname & file_r, Adder && adder_r )
+        {
+          DBG << "Parse " << file_r << endl;
+          SolvInput input( file_r );
+          if ( adder_r( _repo, static_cast<FILE *>(input) ) != 0 )
+            ZYPP_THROW( RepoException( str::Format(_("Failed to parse '%1%': %2%")) % file_r % ::pool_errstr( _pool ) ) );
+        }
+
+        /** Add the pattern-package derived patterns and write the solv file. */
+        void write( const Pathname & solvfile_r )
+        {
+          ::repo_add_autopattern( _repo, 0 );
+          ::repo_internalize( _repo );
+
+          FILE * fp = ::fopen( solvfile_r.c_str(), "we" );
+          if ( ! fp )
+            ZYPP_THROW( RepoException( str::Format(_("Can't open file '%s' for writing.")) % solvfile_r ) );
+
+          int ret = ::repo_write( _repo, fp );
+          if ( ::fclose( fp ) != 0 )
+            ret = -1;
+          if ( ret != 0 )
+            ZYPP_THROW( RepoException( str::Format(_("Failed to write '%1%': %2%")) % solvfile_r % ::pool_errstr( _pool ) ) );
+
+          MIL << "Wrote " << _repo->nsolvables << " solvables to " << solvfile_r << endl;
+        }
+
+      private:
+        ::Pool * _pool;
+        ::Repo * _repo;
+      };
+
+      /** Parse rpm-md metadata below \a repodir_r (the parts \c repo2solv would parse). */
+      void buildRpmmd( SolvBuilder & builder_r, const Pathname & repodir_r )
+      {
+        const Pathname repomd { repodir_r / "repodata/repomd.xml" };
+        builder_r.add( repomd, []( ::Repo * repo_r, FILE * fp_r ) {
+          return ::repo_add_repomdxml( repo_r, fp_r, REPO_NO_INTERNALIZE );
+        });
+
+        std::vector<std::pair<std::string,Pathname>> resources;
+        parser::yum::RepomdFileReader( repomd, [&]( OnMediaLocation && loc_r, const std::string & type_r ) {
+          resources.push_back( std::make_pair( type_r, repodir_r / loc_r.filename() ) );
+          return true;
+        });
+        // primary must be parsed first, the others extend its solvables
+        std::stable_partition( resources.begin(), resources.end(), []( const auto & res_r ) { return res_r.first == "primary"; } );
+
+        for ( const auto & [ type, file ] : resources )
+        {
+          if ( type == "primary" )
+          {
+            builder_r.add( file, []( ::Repo * repo_r, FILE * fp_r ) {
+              return ::repo_add_rpmmd( repo_r, fp_r, nullptr, REPO_NO_INTERNALIZE );
+            });
+          }
+          else if ( type == "susedata" || str::hasPrefix( type, "susedata." ) )
+          {
+            const std::string lang { str::stripPrefix( str::stripPrefix( type, "susedata" ), "." ) };
+            builder_r.add( file, [&lang]( ::Repo * repo_r, FILE * fp_r ) {
+              return ::repo_add_rpmmd( repo_r, fp_r, lang.empty() ? nullptr : lang.c_str(), REPO_NO_INTERNALIZE|REPO_REUSE_REPODATA|REPO_EXTEND_SOLVABLES );
+            });
+          }
+          else if ( type == "suseinfo" )
+          {
+            // repo keywords and expire; same format as repomd.xml
+            builder_r.add( file, []( ::Repo * repo_r, FILE * fp_r ) {
+              return ::repo_add_repomdxml( repo_r, fp_r, REPO_NO_INTERNALIZE|REPO_REUSE_REPODATA );
+            });
+          }
+          else if ( type == "updateinfo" )
+          {
+            builder_r.add( file, []( ::Repo * repo_r, FILE * fp_r ) {
+              return ::repo_add_updateinfoxml( repo_r, fp_r, REPO_NO_INTERNALIZE|REPO_REUSE_REPODATA );
+            });
+          }
+          else if ( type == "deltainfo" || type == "prestodelta" )
+          {
+            builder_r.add( file, []( ::Repo * repo_r, FILE * fp_r ) {
+              return ::repo_add_deltainfoxml( repo_r, fp_r, REPO_NO_INTERNALIZE|REPO_REUSE_REPODATA );
+            });
+          }
+          // filelists, other, appdata... are not parsed by repo2solv either
+        }
+      }
+
+      /** Parse susetags metadata below \a repodir_r (the parts \c repo2solv would parse). */
+      void buildSusetags( SolvBuilder & builder_r, const Pathname & repodir_r )
+      {
+        std::string descrdir { "suse/setup/descr" };
+        Id defvendor = 0;
+
+        const Pathname content { repodir_r / "content" };
+        if ( PathInfo( content ).isFile() )
+        {
+          builder_r.add( content, []( ::Repo * repo_r, FILE * fp_r ) {
+            return ::repo_add_content( repo_r, fp_r, REPO_NO_INTERNALIZE|REPO_REUSE_REPODATA );
+          });
+
+          std::ifstream str( content.c_str() );
+          for ( std::string line; std::getline( str, line ); )
+          {
+            if ( str::hasPrefix( line, "DESCRDIR " ) )
+              descrdir = str::trim( line.substr( 9 ) );
+            else if ( str::hasPrefix( line, "VENDOR " ) )
+              defvendor = ::pool_str2id( builder_r.pool(), str::trim( line.substr( 7 ) ).c_str(), 1 );
+          }
+        }
+
+        const Pathname descr { repodir_r / descrdir };
+        std::list<std::string> entries;
+        if ( filesystem::readdir( entries, descr, false ) != 0 )
+          ZYPP_THROW( RepoException( str::Format(_("Can't read directory '%s'.")) % descr ) );
+        entries.sort();
+
+        const auto & findEntry = [&entries]( const std::string & name_r ) {
+          for ( const char * ext : { "", ".gz" } )
+            if ( std::find( entries.begin(), entries.end(), name_r+ext ) != entries.end() )
+              return name_r+ext;
+          return std::string();
+        };
+
+        const std::string packages { findEntry( "packages" ) };
+        if ( packages.empty() )
+          ZYPP_THROW( RepoException( str::Format(_("File '%s' not found.")) % (descr/"packages") ) );
+
+        builder_r.add( descr/packages, [defvendor]( ::Repo * repo_r, FILE * fp_r ) {
+          return ::repo_add_susetags( repo_r, fp_r, defvendor, nullptr, REPO_NO_INTERNALIZE|SUSETAGS_RECORD_SHARES );
+        });
+
+        for ( const std::string & entry : entries )
+        {
+          if ( str::hasPrefix( entry, "packages." ) && entry != packages )
+          {
+            // packages.DU (diskusage), packages.LANG (translations); the filelist is not parsed by repo2solv either
+            std::string lang { str::stripSuffix( str::stripPrefix( entry, "packages." ), ".gz" ) };
+            if ( lang == "FL" )
+              continue;
+            if ( lang == "DU" )
+              lang.clear();
+            builder_r.add( descr/entry, [defvendor,&lang]( ::Repo * repo_r, FILE * fp_r ) {
+              return ::repo_add_susetags( repo_r, fp_r, defvendor, lang.empty() ? nullptr : lang.c_str(), REPO_NO_INTERNALIZE|REPO_REUSE_REPODATA|REPO_EXTEND_SOLVABLES );
+            });
+          }
+          else if ( str::hasSuffix( entry, ".pat" ) || str::hasSuffix( entry, ".pat.gz" ) || str::hasSuffix( entry, ".pat.zst" ) )
+          {
+            // .zst is rejected by SolvInput rather than silently skipped
+            builder_r.add( descr/entry, [defvendor]( ::Repo * repo_r, FILE * fp_r ) {
+              return ::repo_add_susetags( repo_r, fp_r, defvendor, nullptr, REPO_NO_INTERNALIZE|REPO_REUSE_REPODATA );
+            });
+          }
+        }
+      }
+    } // namespace
+    ///////////////////////////////////////////////////////////////////
+
+    bool buildSolvfileSupported( const RepoType & repokind_r )
+    {
+      switch ( repokind_r.toEnum() )
+      {
+        case RepoType::RPMMD_e:
+        case RepoType::YAST2_e:
+          return true;
+        default:
+          break;
+      }
+      return false;
+    }
+
+    void buildSolvfile( const RepoType & repokind_r, const Pathname & metadataPath_r, const Pathname & solvfile_r )
+    {
+      debug::Measure m( "buildSolvfile "+metadataPath_r.asString() );
+      MIL << "Build " << repokind_r << " solv file from " << metadataPath_r << endl;
+
+      SolvBuilder builder;
+      switch ( repokind_r.toEnum() )
+      {
+        case RepoType::RPMMD_e:
+          buildRpmmd( builder, metadataPath_r );
+          break;
+
+        case RepoType::YAST2_e:
+          buildSusetags( builder, metadataPath_r );
+          break;
+
+        default:
+          ZYPP_THROW( RepoException( str::Format(_("Unhandled repository type '%s'.")) % repokind_r ) );
+          break;
+      }
+      builder.write( solvfile_r );
+    }
+
+  } // namespace repo
+  ///////////////////////////////////////////////////////////////////
+} // namespace zypp
+///////////////////////////////////////////////////////////////////
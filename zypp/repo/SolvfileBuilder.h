@@ -0,0 +1,47 @@
+/*---------------------------------------------------------------------\
+|                          ____ _   __ __ ___                          |
+|                         |__  / \ / / . \ . \                         |
+|                           / / \ V /|  _/  _/                         |
+|                          / /__ | | | | | |                           |
+|                         /_____||_| |_| |_|                           |
+|                                                                      |
+\---------------------------------------------------------------------*/
+/** \file	zypp/repo/SolvfileBuilder.h
+ *
+*/
+#ifndef ZYPP_REPO_SOLVFILEBUILDER_H
+#define ZYPP_REPO_SOLVFILEBUILDER_H
+
+#include <zypp/Pathname.h>
+#include <zypp/repo/RepoType.h>
+
+///////////////////////////////////////////////////////////////////
+namespace zypp
+{
+  ///////////////////////////////////////////////////////////////////
+  namespace repo
+  {
+    /** Whether \ref buildSolvfile is able to handle metadata of type \a repokind_r.
+     * Currently \c rpm-md and \c yast2 (susetags) are supported.
+     */
+    bool buildSolvfileSupported( const RepoType & repokind_r );
+
+    /** In-process replacement for <tt>repo2solv -X</tt>.
+     *
+     * Parses the raw metadata below \a metadataPath_r using the libsolvext
+     * parsers and writes the solv file to \a solvfile_r. Compressed metadata
+     * files are read via \ref InputStream (gzip and zchunk). Metadata using
+     * other compressions (e.g. zstd) are rejected, \c repo2solv must be used
+     * for them.
+     *
+     * An incomplete \a solvfile_r may be left behind on error.
+     *
+     * \throws RepoException if parsing or writing fails.
+     */
+    void buildSolvfile( const RepoType & repokind_r, const Pathname & metadataPath_r, const Pathname & solvfile_r );
+
+  } // namespace repo
+  ///////////////////////////////////////////////////////////////////
+} // namespace zypp
+///////////////////////////////////////////////////////////////////
+#endif // ZYPP_REPO_SOLVFILEBUILDER_H
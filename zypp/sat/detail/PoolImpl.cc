@@ -11,6 +11,8 @@
 */
 #include <iostream>
 #include <fstream>
+#include <algorithm>
+#include <unordered_map>
 #include <boost/mpl/int.hpp>
 
 #include <zypp/base/Easy.h>
@@ -21,6 +23,10 @@
 #include <zypp-core/fs/WatchFile>
 #include <zypp-core/parser/Sysconfig>
 #include <zypp/base/IOStream.h>
+#include <zypp/AutoDispose.h>
+#include <zypp/Digest.h>
+#include <zypp/PathInfo.h>
+#include <zypp/TmpPath.h>
 
 #include <zypp/ZConfig.h>
 
@@ -36,6 +42,8 @@
 
 extern "C"
 {
+#include <solv/solvversion.h>
+#include <sys/stat.h>
 // Workaround libsolv project not providing a common include
 // directory. (the -devel package does, but the git repo doesn't).
 // #include <solv/repo_helix.h>
@@ -242,9 +250,70 @@ namespace zypp
         ::pool_free( _pool );
       }
 
+      ///////////////////////////////////////////////////////////////////
+      /// \class PoolImpl::WhatprovidesCache
+      /// \brief Whatprovides index remembered across repo changes.
+      ///
+      /// Creating the whatprovides index from scratch is expensive on large
+      /// pools. If repos or solvables are just added or removed, the index is
+      /// detached from the pool (libsolv would free it otherwise) and
+      /// \ref PoolImpl::prepare updates just the entries of the names provided
+      /// by the added or removed solvables.
+      ///
+      /// The index is created anew if anything else it depends on changed:
+      /// the architecture, the installed repo or the set of file dependencies.
+      /// libsolvs optional aux data are dropped by an update. They are restored
+      /// by the next full build.
+      ///////////////////////////////////////////////////////////////////
+      struct PoolImpl::WhatprovidesCache
+      {
+        /** Capacity for \a size_r entries. libsolv grows the index in blocks when new Ids are created and relies on it. */
+        static int capacity( int size_r )
+        {
+          static constexpr int block = 1024;
+          return ( size_r + block - 1 ) / block * block;
+        }
+
+        ~WhatprovidesCache()
+        {
+          ::solv_free( _whatprovides );
+          ::solv_free( _whatprovides_rel );
+          ::solv_free( _whatprovidesdata );
+        }
+
+        // What the index was built for:
+        Arch _arch;
+        CRepo * _installed = nullptr;
+        std::vector<IdType> _fileprovides;	///< sorted
+        Offset _dataSize = 0;			///< used whatprovidesdata after the full build
+
+        // The detached index:
+        bool _detached = false;
+        Offset * _whatprovides = nullptr;
+        Offset * _whatprovides_rel = nullptr;
+        IdType * _whatprovidesdata = nullptr;
+        Offset _whatprovidesdataoff = 0;
+        int _whatprovidesdataleft = 0;
+        int _nstrings = 0;			///< names from here on are not in the index
+        SolvableIdType _nsolvables = 0;		///< solvables from here on are not in the index
+        std::vector<IdType> _removed;		///< names provided by removed solvables
+      };
+
      ///////////////////////////////////////////////////////////////////
 
       void PoolImpl::setDirty( const char * a1, const char * a2, const char * a3 )
+      {
+        contentSetDirty( a1, a2, a3 );
+        depSetDirty();	// invaldate dependency/namespace related indices
+      }
+
+      void PoolImpl::repoSetDirty( const char * a1, const char * a2, const char * a3 )
+      {
+        contentSetDirty( a1, a2, a3 );
+        detachWhatprovides();	// updated in prepare
+      }
+
+      void PoolImpl::contentSetDirty( const char * a1, const char * a2, const char * a3 )
       {
         if ( _retractedSpec.empty() ) {
           // lazy init IdString types we can not use inside the ctor
@@ -267,8 +336,6 @@ namespace zypp
         _retractedSpec.setDirty();    // re-evaluate blacklisted spec
         _ptfMasterSpec.setDirty();    //  --"--
         _ptfPackageSpec.setDirty();   //  --"--
-
-        depSetDirty();	// invaldate dependency/namespace related indices
       }
 
       void PoolImpl::localeSetDirty( const char * a1, const char * a2, const char * a3 )
@@ -280,7 +347,7 @@ namespace zypp
           else           MIL << a1 << endl;
         }
         _trackedLocaleIdsPtr.reset();	// requested locales changed
-        depSetDirty();	// invaldate dependency/namespace related indices
+        nsSetDirty();	// invaldate namespace:language providers
       }
 
       void PoolImpl::depSetDirty( const char * a1, const char * a2, const char * a3 )
@@ -291,9 +358,395 @@ namespace zypp
           else if ( a2 ) MIL << a1 << " " << a2 << endl;
           else           MIL << a1 << endl;
         }
+        _whatprovidesCache.reset();
         ::pool_freewhatprovides( _pool );
       }
 
+      void PoolImpl::nsSetDirty( const char * a1, const char * a2, const char * a3 )
+      {
+        if ( a1 )
+        {
+          if      ( a3 ) MIL << a1 << " " << a2 << " " << a3 << endl;
+          else if ( a2 ) MIL << a1 << " " << a2 << endl;
+          else           MIL << a1 << endl;
+        }
+        _serialNS.setDirty();	// namespace providers change
+        // Namespace providers are computed on demand and cached in the rel part of
+        // the index. Not just the namespace rels themselves but any rich dependency
+        // may refer to them, so all rel entries are reset (a detached index gets
+        // them reset when it is updated).
+        if ( _pool->whatprovides )
+          std::fill( _pool->whatprovides_rel, _pool->whatprovides_rel + _pool->nrels, 0 );
+      }
+
+      void PoolImpl::detachWhatprovides()
+      {
+        if ( ! _whatprovidesCache )
+          return;	// created anew anyway
+
+        WhatprovidesCache & cache( *_whatprovidesCache );
+        if ( cache._detached )
+          return;
+        if ( ! _pool->whatprovides )
+        {
+          // freed behind our back
+          _whatprovidesCache.reset();
+          return;
+        }
+
+        cache._whatprovides = _pool->whatprovides;
+        cache._whatprovides_rel = _pool->whatprovides_rel;
+        cache._whatprovidesdata = _pool->whatprovidesdata;
+        cache._whatprovidesdataoff = _pool->whatprovidesdataoff;
+        cache._whatprovidesdataleft = _pool->whatprovidesdataleft;
+        cache._detached = true;
+
+        _pool->whatprovides = nullptr;
+        _pool->whatprovides_rel = nullptr;
+        _pool->whatprovidesdata = nullptr;
+        _pool->whatprovidesdataoff = 0;
+        _pool->whatprovidesdataleft = 0;
+        ::pool_freewhatprovides( _pool );	// the remaining aux data
+      }
+
+      bool PoolImpl::updateWhatprovides( const sat::Queue & fileprovides_r ) const
+      {
+        if ( ! ( _whatprovidesCache && _whatprovidesCache->_detached ) )
+          return false;
+
+        WhatprovidesCache & cache( *_whatprovidesCache );
+        if ( cache._installed != _pool->installed || cache._arch != ZConfig::instance().systemArchitecture() )
+          return false;
+        // File provides were added to the old solvables for the file dependencies known by then.
+        for ( IdType id : fileprovides_r )
+        {
+          if ( ! std::binary_search( cache._fileprovides.begin(), cache._fileprovides.end(), id ) )
+            return false;
+        }
+        // Each update leaves the replaced lists unused in whatprovidesdata.
+        if ( cache._whatprovidesdataoff > 2 * cache._dataSize )
+          return false;
+
+        debug::Measure m( "update whatprovides" );
+        const int nstrings = _pool->ss.nstrings;
+        const int nrels = _pool->nrels;
+        const int stringsCapacity = WhatprovidesCache::capacity( nstrings );
+        const int relsCapacity = WhatprovidesCache::capacity( nrels );
+
+        // Reattach the index. New names are not provided, unless by an added solvable.
+        // The rel entries are computed on demand, and any of them may refer to a changed name.
+        _pool->whatprovides = (Offset *)::solv_realloc2( cache._whatprovides, stringsCapacity, sizeof(Offset) );
+        std::fill( _pool->whatprovides + cache._nstrings, _pool->whatprovides + nstrings, 1 );
+        std::fill( _pool->whatprovides + nstrings, _pool->whatprovides + stringsCapacity, 0 );
+        _pool->whatprovides_rel = (Offset *)::solv_realloc2( cache._whatprovides_rel, relsCapacity, sizeof(Offset) );
+        std::fill( _pool->whatprovides_rel, _pool->whatprovides_rel + relsCapacity, 0 );
+        _pool->whatprovidesdata = cache._whatprovidesdata;
+        _pool->whatprovidesdataoff = cache._whatprovidesdataoff;
+        _pool->whatprovidesdataleft = cache._whatprovidesdataleft;
+        cache._whatprovides = nullptr;
+        cache._whatprovides_rel = nullptr;
+        cache._whatprovidesdata = nullptr;
+        cache._detached = false;
+
+        // The providers added per name, in ascending order like pool_createwhatprovides.
+        // Names provided by removed solvables just need their list to be filtered.
+        std::unordered_map<IdType,std::vector<IdType>> added;
+        for ( IdType name : cache._removed )
+          added[name];
+        cache._removed.clear();
+
+        for ( SolvableIdType i = cache._nsolvables; i < SolvableIdType(_pool->nsolvables); ++i )
+        {
+          CSolvable * s( _pool->solvables + i );
+          if ( ! ( s->repo && s->provides ) || s->repo->disabled )
+            continue;
+          if ( s->repo != _pool->installed && ! ::pool_installable( _pool, s ) )
+            continue;
+          for ( IdType * pp = s->repo->idarraydata + s->provides; *pp; ++pp )
+          {
+            IdType id = *pp;
+            while ( ISRELDEP(id) )
+              id = GETRELDEP( _pool, id )->name;
+            std::vector<IdType> & providers( added[id] );
+            if ( providers.empty() || providers.back() != IdType(i) )
+              providers.push_back( i );
+          }
+        }
+
+        sat::Queue providers;
+        for ( const auto & [name,newproviders] : added )
+        {
+          providers.clear();
+          for ( IdType * pp = _pool->whatprovidesdata + _pool->whatprovides[name]; *pp; ++pp )
+          {
+            // drop the removed solvables (and any reused id)
+            if ( SolvableIdType(*pp) < cache._nsolvables && _pool->solvables[*pp].repo )
+              providers.push( *pp );
+          }
+          for ( IdType p : newproviders )
+            providers.push( p );
+          _pool->whatprovides[name] = ::pool_queuetowhatprovides( _pool, providers );
+        }
+        MIL << "Updated whatprovides of " << added.size() << " names for solvables from " << cache._nsolvables << endl;
+        ++_whatprovidesUpdates;
+        cache._nstrings = nstrings;
+        cache._nsolvables = _pool->nsolvables;
+        return true;
+      }
+
+      void PoolImpl::createWhatprovides( const sat::Queue & fileprovides_r ) const
+      {
+        _whatprovidesCache.reset();
+        ::pool_createwhatprovides( _pool );
+        ++_whatprovidesBuilds;
+        rememberWhatprovides( fileprovides_r );
+      }
+
+      void PoolImpl::rememberWhatprovides( const sat::Queue & fileprovides_r ) const
+      {
+        _whatprovidesCache.reset();
+        // Pools using libsolvs on demand features are not updated.
+        if ( _pool->considered
+             || ::pool_get_flag( _pool, POOL_FLAG_ADDFILEPROVIDESFILTERED )
+             || ::pool_get_flag( _pool, POOL_FLAG_WHATPROVIDESWITHDISABLED ) )
+          return;
+
+        _whatprovidesCache.reset( new WhatprovidesCache );
+        WhatprovidesCache & cache( *_whatprovidesCache );
+        cache._arch = ZConfig::instance().systemArchitecture();
+        cache._installed = _pool->installed;
+        cache._fileprovides.assign( fileprovides_r.begin(), fileprovides_r.end() );
+        std::sort( cache._fileprovides.begin(), cache._fileprovides.end() );
+        cache._dataSize = _pool->whatprovidesdataoff;
+        cache._nstrings = _pool->ss.nstrings;
+        cache._nsolvables = _pool->nsolvables;
+      }
+
+      /** Tell the pool file provides were added (SolvInternals.cc). */
+      void setAddedFileprovides( CPool * pool_r );
+
+      ///////////////////////////////////////////////////////////////////
+      namespace
+      {
+        /** Snapshot file format version; part of the key. */
+        const std::string snapshotMagic { "ZYPP-WHATPROVIDES-1" };
+
+        template <class Tp>
+        void writeSnapshotData( std::ostream & str, const Tp * data_r, std::size_t size_r )
+        { str.write( reinterpret_cast<const char *>( data_r ), size_r * sizeof(Tp) ); }
+
+        template <class Tp>
+        bool readSnapshotData( std::istream & str, Tp * data_r, std::size_t size_r )
+        { return bool( str.read( reinterpret_cast<char *>( data_r ), size_r * sizeof(Tp) ) ); }
+      } // namespace
+      ///////////////////////////////////////////////////////////////////
+
+      std::string PoolImpl::whatprovidesSnapshotKey( Pathname & file_r ) const
+      {
+        // The index refers to string, rel and solvable ids. They are the same if the
+        // same solv files are loaded in the same order into the same string pool.
+        // The solv files in turn change whenever their repos cookie (RepoStatus) does.
+        // So only the strings and rels created outside of loading a solv file need to
+        // be hashed, not the whole string space (which is several MB).
+        Pathname solvCache;
+        std::vector<std::pair<IdType,IdType>> loadedStrings;
+        std::vector<std::pair<IdType,IdType>> loadedRels;
+        Digest digest;
+        digest.create( Digest::sha1() );
+        digest.update( snapshotMagic.c_str(), snapshotMagic.size() + 1 );
+        digest.update( ::solv_version, ::strlen( ::solv_version ) + 1 );
+        const std::string arch { ZConfig::instance().systemArchitecture().asString() };
+        digest.update( arch.c_str(), arch.size() + 1 );
+
+        for ( int i = 1; i < _pool->nrepos; ++i )
+        {
+          CRepo * repo( _pool->repos[i] );
+          if ( ! repo )
+            continue;
+          auto it { _repoSolvFiles.find( repo ) };
+          if ( it == _repoSolvFiles.end() || it->second._path.empty() || it->second._fileprovides )
+            return std::string();
+          // All solv files in one solv cache: <solvCache>/<alias>/solv
+          const Pathname & solvFile { it->second._path };
+          if ( solvCache.empty() )
+            solvCache = solvFile.dirname().dirname();
+          else if ( solvFile.dirname().dirname() != solvCache )
+            return std::string();
+
+          const RepoSolvFile & entry { it->second };
+          digest.update( entry._ident.c_str(), entry._ident.size() + 1 );
+          const int data[] { repo->start, repo->end, repo->nsolvables, isSystemRepo( repo ),
+                             entry._stringsBegin, entry._stringsEnd, entry._relsBegin, entry._relsEnd };
+          digest.update( reinterpret_cast<const char *>( data ), sizeof(data) );
+          loadedStrings.push_back( { entry._stringsBegin, entry._stringsEnd } );
+          loadedRels.push_back( { entry._relsBegin, entry._relsEnd } );
+        }
+        if ( solvCache.empty() )
+          return std::string();
+
+        const int data[] { _pool->nsolvables, _pool->ss.nstrings, int(_pool->ss.sstrings), _pool->nrels };
+        digest.update( reinterpret_cast<const char *>( data ), sizeof(data) );
+
+        // Hash the gaps between the loaded ranges, in id order.
+        auto hashGaps = []( std::vector<std::pair<IdType,IdType>> & loaded_r, IdType end_r, auto hashRange_r ) {
+          std::sort( loaded_r.begin(), loaded_r.end() );
+          IdType next = 0;
+          for ( const auto & range : loaded_r )
+          {
+            if ( range.first < next || range.second < range.first || range.second > end_r )
+              return false;	// not created by the loads we know of
+            hashRange_r( next, range.first );
+            next = range.second;
+          }
+          hashRange_r( next, end_r );
+          return true;
+        };
+        const auto stringOffset = [this]( IdType id_r ) -> Offset {
+          return id_r < _pool->ss.nstrings ? _pool->ss.strings[id_r] : _pool->ss.sstrings;
+        };
+        if ( ! hashGaps( loadedStrings, _pool->ss.nstrings, [&]( IdType begin_r, IdType end_r ) {
+                           if ( begin_r < end_r )
+                             digest.update( _pool->ss.stringspace + stringOffset( begin_r ), stringOffset( end_r ) - stringOffset( begin_r ) );
+                         } )
+             || ! hashGaps( loadedRels, _pool->nrels, [&]( IdType begin_r, IdType end_r ) {
+                              if ( begin_r < end_r )
+                                digest.update( reinterpret_cast<const char *>( _pool->rels + begin_r ), ( end_r - begin_r ) * sizeof(*_pool->rels) );
+                            } ) )
+          return std::string();
+
+        file_r = solvCache / ".whatprovides";	// a repo alias must not start with a dot
+        return digest.digest();
+      }
+
+      bool PoolImpl::loadWhatprovidesSnapshot( const Pathname & file_r, const std::string & key_r ) const
+      {
+        std::ifstream str( file_r.c_str(), std::ios::binary );
+        if ( ! str )
+          return false;
+
+        std::string magic;
+        std::string key;
+        std::getline( str, magic );
+        std::getline( str, key );
+        if ( magic != snapshotMagic || key != key_r )
+        {
+          MIL << "Whatprovides snapshot " << file_r << " does not match the pool" << endl;
+          return false;
+        }
+
+        // sizes: strings, whatprovidesdata, added file provides (pairs), file dependencies
+        unsigned sizes[4];
+        if ( ! readSnapshotData( str, sizes, 4 ) || sizes[0] != unsigned(_pool->ss.nstrings) )
+          return false;
+
+        std::vector<IdType> added( 2 * sizes[2] );
+        sat::Queue fileprovides;
+        std::vector<IdType> filedeps( sizes[3] );
+        AutoDispose<Offset *> whatprovides { (Offset *)::solv_calloc( WhatprovidesCache::capacity( sizes[0] ), sizeof(Offset) ), ::solv_free };
+        AutoDispose<IdType *> whatprovidesdata { (IdType *)::solv_calloc( sizes[1], sizeof(IdType) ), ::solv_free };
+        if ( ! ( readSnapshotData( str, added.data(), added.size() )
+                 && readSnapshotData( str, filedeps.data(), filedeps.size() )
+                 && readSnapshotData( str, whatprovides.value(), sizes[0] )
+                 && readSnapshotData( str, whatprovidesdata.value(), sizes[1] ) ) )
+        {
+          WAR << "Whatprovides snapshot " << file_r << " is truncated" << endl;
+          return false;
+        }
+        for ( unsigned i = 0; i < added.size(); i += 2 )
+        {
+          if ( added[i] < 2 || added[i] >= _pool->nsolvables || ! _pool->solvables[added[i]].repo || added[i+1] <= 0 || added[i+1] >= _pool->ss.nstrings )
+            return false;
+        }
+        for ( unsigned i = 0; i < sizes[0]; ++i )
+        {
+          if ( whatprovides.value()[i] >= sizes[1] )
+            return false;
+        }
+        // Each list is a 0-terminated list of solvable ids. A terminating last entry
+        // makes sure no list runs beyond the data.
+        if ( sizes[1] == 0 || whatprovidesdata.value()[sizes[1]-1] != 0 )
+          return false;
+        for ( unsigned i = 0; i < sizes[1]; ++i )
+        {
+          IdType id { whatprovidesdata.value()[i] };
+          if ( id < 0 || id >= _pool->nsolvables )
+            return false;
+        }
+        for ( IdType id : filedeps )
+        {
+          if ( id <= 0 || id >= _pool->ss.nstrings )
+            return false;
+        }
+
+        // Add the file provides pool_addfileprovides added, then attach the index.
+        _whatprovidesCache.reset();
+        for ( unsigned i = 0; i < added.size(); i += 2 )
+        {
+          CSolvable * s( _pool->solvables + added[i] );
+          s->provides = ::repo_addid_dep( s->repo, s->provides, added[i+1], SOLVABLE_FILEMARKER );
+        }
+        _pool->whatprovides = whatprovides.value();
+        whatprovides.resetDispose();
+        _pool->whatprovides_rel = (Offset *)::solv_calloc( WhatprovidesCache::capacity( _pool->nrels ), sizeof(Offset) );
+        _pool->whatprovidesdata = whatprovidesdata.value();
+        whatprovidesdata.resetDispose();
+        _pool->whatprovidesdataoff = sizes[1];
+        _pool->whatprovidesdataleft = 0;
+        setAddedFileprovides( _pool );	// as if pool_addfileprovides_queue was called
+
+        for ( auto & el : _repoSolvFiles )
+          el.second._fileprovides = true;
+        for ( IdType id : filedeps )
+          fileprovides.push( id );
+        rememberWhatprovides( fileprovides );
+        MIL << "Using whatprovides snapshot " << file_r << endl;
+        return true;
+      }
+
+      void PoolImpl::saveWhatprovidesSnapshot( const Pathname & file_r, const std::string & key_r,
+                                               const std::vector<unsigned> & providesSizes_r, const sat::Queue & fileprovides_r ) const
+      {
+        // The file provides are appended to the provides (after a SOLVABLE_FILEMARKER).
+        std::vector<IdType> added;
+        for ( detail::SolvableIdType i = 2; i < providesSizes_r.size(); ++i )
+        {
+          CSolvable * s( _pool->solvables + i );
+          if ( ! ( s->repo && s->provides ) )
+            continue;
+          unsigned size = 0;
+          for ( IdType * pp = s->repo->idarraydata + s->provides; *pp; ++pp, ++size )
+          {
+            if ( size >= providesSizes_r[i] && *pp != SOLVABLE_FILEMARKER )
+            {
+              added.push_back( i );
+              added.push_back( *pp );
+            }
+          }
+        }
+
+        filesystem::TmpFile tmp { filesystem::TmpFile::makeSibling( file_r, 0644 ) };
+        if ( ! tmp )
+        {
+          DBG << "Can not write whatprovides snapshot " << file_r << endl;	// e.g. not root
+          return;
+        }
+        std::ofstream str( tmp.path().c_str(), std::ios::binary );
+        str << snapshotMagic << '\n' << key_r << '\n';
+        const unsigned sizes[4] { unsigned(_pool->ss.nstrings), _pool->whatprovidesdataoff, unsigned(added.size() / 2), fileprovides_r.size() };
+        writeSnapshotData( str, sizes, 4 );
+        writeSnapshotData( str, added.data(), added.size() );
+        writeSnapshotData( str, fileprovides_r.begin(), fileprovides_r.size() );
+        writeSnapshotData( str, _pool->whatprovides, sizes[0] );
+        writeSnapshotData( str, _pool->whatprovidesdata, sizes[1] );
+        str.close();
+        if ( ! str || filesystem::rename( tmp.path(), file_r ) != 0 )
+        {
+          WAR << "Can not write whatprovides snapshot " << file_r << endl;
+          return;
+        }
+        MIL << "Saved whatprovides snapshot " << file_r << " (" << added.size() / 2 << " file provides)" << endl;
+      }
+
       void PoolImpl::prepare() const
       {
         // additional /etc/sysconfig/storage check:
@@ -301,7 +754,7 @@ namespace zypp
         if ( sysconfigFile.hasChanged() )
         {
           _requiredFilesystemsPtr.reset(); // recreated on demand
-          const_cast<PoolImpl*>(this)->depSetDirty( "/etc/sysconfig/storage change" );
+          const_cast<PoolImpl*>(this)->nsSetDirty( "/etc/sysconfig/storage change" );
         }
         if ( _watcher.remember( _serial ) )
         {
@@ -311,10 +764,39 @@ namespace zypp
         }
         if ( ! _pool->whatprovides )
         {
-          MIL << "pool_createwhatprovides..." << endl;
+          Pathname snapshotFile;
+          std::string snapshotKey;
+          if ( ZConfig::instance().repo_whatprovides_snapshot() )
+            snapshotKey = whatprovidesSnapshotKey( snapshotFile );
 
-          ::pool_addfileprovides( _pool );
-          ::pool_createwhatprovides( _pool );
+          if ( snapshotKey.empty() || ! loadWhatprovidesSnapshot( snapshotFile, snapshotKey ) )
+          {
+            // To tell the file provides added for the snapshot.
+            std::vector<unsigned> providesSizes;
+            if ( ! snapshotKey.empty() )
+            {
+              providesSizes.resize( _pool->nsolvables, 0 );
+              for ( detail::SolvableIdType i = 2; i < providesSizes.size(); ++i )
+              {
+                CSolvable * s( _pool->solvables + i );
+                if ( s->repo && s->provides )
+                  for ( IdType * pp = s->repo->idarraydata + s->provides; *pp; ++pp )
+                    ++providesSizes[i];
+              }
+            }
+
+            sat::Queue fileprovides;
+            ::pool_addfileprovides_queue( _pool, fileprovides, nullptr );
+            for ( auto & el : _repoSolvFiles )
+              el.second._fileprovides = true;
+            if ( ! updateWhatprovides( fileprovides ) )
+            {
+              MIL << "pool_createwhatprovides..." << endl;
+              createWhatprovides( fileprovides );
+            }
+            if ( ! snapshotKey.empty() )
+              saveWhatprovidesSnapshot( snapshotFile, snapshotKey, providesSizes, fileprovides );
+          }
         }
         if ( ! _pool->languages )
         {
@@ -327,7 +809,7 @@ namespace zypp
 
       CRepo * PoolImpl::_createRepo( const std::string & name_r )
       {
-        setDirty(__FUNCTION__, name_r.c_str() );
+        repoSetDirty(__FUNCTION__, name_r.c_str() );
         CRepo * ret = ::repo_create( _pool, name_r.c_str() );
         if ( ret && name_r == systemRepoAlias() )
           ::pool_set_installed( _pool, ret );
@@ -336,10 +818,34 @@ namespace zypp
 
       void PoolImpl::_deleteRepo( CRepo * repo_r )
       {
-        setDirty(__FUNCTION__, repo_r->name );
+        if ( isSystemRepo( repo_r ) )
+          setDirty(__FUNCTION__, repo_r->name );
+        else
+        {
+          repoSetDirty(__FUNCTION__, repo_r->name );
+          if ( _whatprovidesCache )
+          {
+            // remember the names whose providers change
+            for ( detail::IdType i = repo_r->start; i < repo_r->end; ++i )
+            {
+              CSolvable * s( _pool->solvables + i );
+              if ( s->repo != repo_r || ! s->provides )
+                continue;
+              for ( IdType * pp = repo_r->idarraydata + s->provides; *pp; ++pp )
+              {
+                IdType id = *pp;
+                while ( ISRELDEP(id) )
+                  id = GETRELDEP( _pool, id )->name;
+                _whatprovidesCache->_removed.push_back( id );
+              }
+            }
+          }
+        }
+        rememberChangedRange( repo_r );
         if ( isSystemRepo( repo_r ) )
           _autoinstalled.clear();
         eraseRepoInfo( repo_r );
+        _repoSolvFiles.erase( repo_r );
         ::repo_free( repo_r, /*resusePoolIDs*/false );
         // If the last repo is removed clear the pool to actually reuse all IDs.
         // NOTE: the explicit ::repo_free above asserts all solvables are memset(0)!
@@ -348,12 +854,33 @@ namespace zypp
           _serialIDs.setDirty();	// Indicate resusePoolIDs - ResPool must also invalidate its PoolItems
           ::pool_freeallrepos( _pool, /*resusePoolIDs*/true );
         }
+        // Ids of solvables freed at the end of the pool are reused
+        if ( _whatprovidesCache && SolvableIdType(_pool->nsolvables) < _whatprovidesCache->_nsolvables )
+          _whatprovidesCache->_nsolvables = _pool->nsolvables;
       }
 
-      int PoolImpl::_addSolv( CRepo * repo_r, FILE * file_r )
+      int PoolImpl::_addSolv( CRepo * repo_r, FILE * file_r, const Pathname & path_r )
       {
-        setDirty(__FUNCTION__, repo_r->name );
+        repoSetDirty(__FUNCTION__, repo_r->name );
+        {
+          // A repo loaded from exactly one solv file is identified by the file.
+          struct stat st;
+          if ( ! path_r.empty() && _repoSolvFiles.find( repo_r ) == _repoSolvFiles.end() && repo_r->nsolvables == 0
+               && ::fstat( ::fileno( file_r ), &st ) == 0 && S_ISREG( st.st_mode ) )
+          {
+            _repoSolvFiles[repo_r] = { path_r, str::Str() << path_r << " " << st.st_dev << " " << st.st_ino << " " << st.st_size
+                                                          << " " << st.st_mtim.tv_sec << "." << st.st_mtim.tv_nsec, false };
+          }
+          else
+            _repoSolvFiles[repo_r] = {};
+        }
+        RepoSolvFile & entry { _repoSolvFiles[repo_r] };
+        entry._stringsBegin = _pool->ss.nstrings;
+        entry._relsBegin = _pool->nrels;
         int ret = ::repo_add_solv( repo_r, file_r, 0 );
+        entry._stringsEnd = _pool->ss.nstrings;
+        entry._relsEnd = _pool->nrels;
+        rememberChangedRange( repo_r );
         if ( ret == 0 )
           _postRepoAdd( repo_r );
         return ret;
@@ -361,8 +888,10 @@ namespace zypp
 
       int PoolImpl::_addHelix( CRepo * repo_r, FILE * file_r )
       {
-        setDirty(__FUNCTION__, repo_r->name );
+        repoSetDirty(__FUNCTION__, repo_r->name );
+        _repoSolvFiles[repo_r] = {};	// no snapshot
         int ret = ::repo_add_helix( repo_r, file_r, 0 );
+        rememberChangedRange( repo_r );
         if ( ret == 0 )
           _postRepoAdd( repo_r );
         return 0;
@@ -370,8 +899,10 @@ namespace zypp
 
       int PoolImpl::_addTesttags(CRepo *repo_r, FILE *file_r)
       {
-        setDirty(__FUNCTION__, repo_r->name );
+        repoSetDirty(__FUNCTION__, repo_r->name );
+        _repoSolvFiles[repo_r] = {};	// no snapshot
         int ret = ::testcase_add_testtags( repo_r, file_r, 0 );
+        rememberChangedRange( repo_r );
         if ( ret == 0 )
           _postRepoAdd( repo_r );
         return 0;
@@ -423,8 +954,64 @@ namespace zypp
 
       detail::SolvableIdType PoolImpl::_addSolvables( CRepo * repo_r, unsigned count_r )
       {
-        setDirty(__FUNCTION__, repo_r->name );
-        return ::repo_add_solvable_block( repo_r, count_r );
+        repoSetDirty(__FUNCTION__, repo_r->name );
+        _repoSolvFiles[repo_r] = {};	// no snapshot
+        detail::SolvableIdType ret = ::repo_add_solvable_block( repo_r, count_r );
+        rememberChangedRange( ret, ret + count_r );
+        return ret;
+      }
+
+      void PoolImpl::rememberChangedRange( SolvableIdType begin_r, SolvableIdType end_r )
+      {
+        static const unsigned maxChangedRanges = 256;
+        if ( begin_r >= end_r )
+          return;
+        _changedRanges.push_back( SolvableIdRange( begin_r, end_r ) );
+        if ( _changedRanges.size() > maxChangedRanges )
+        {
+          _changedRanges.pop_front();
+          ++_changedRangesBegin;
+        }
+      }
+
+      bool PoolImpl::changedRangesSince( unsigned pos_r, std::vector<SolvableIdRange> & ranges_r ) const
+      {
+        if ( pos_r < _changedRangesBegin || pos_r > changedRangesEnd() )
+          return false;
+        ranges_r.insert( ranges_r.end(), _changedRanges.begin() + ( pos_r - _changedRangesBegin ), _changedRanges.end() );
+        return true;
+      }
+
+      const TrigramIndex & PoolImpl::trigramIndex( CRepo * repo_r, IdType attr_r ) const
+      {
+        static const TrigramIndex noIndex;
+        if ( ! repo_r->nsolvables )
+          return noIndex;	// don't block the snapshot of a repo to be loaded
+
+        RepoSolvFile & entry { _repoSolvFiles[repo_r] };
+        auto it { entry._trigramIndex.find( attr_r ) };
+        if ( it != entry._trigramIndex.end() )
+          return it->second;
+
+        TrigramIndex & index { entry._trigramIndex[attr_r] };
+        Pathname file;
+        std::string key;
+        if ( ! entry._path.empty() )
+        {
+          // Solvables freed by _postRepoAdd depend on the architecture.
+          file = entry._path.extend( "." + str::stripPrefix( IdString(attr_r).asString(), "solvable:" ) + ".trigrams" );
+          key = str::Str() << entry._ident << " " << ZConfig::instance().systemArchitecture()
+                           << " " << repo_r->end - repo_r->start << " " << repo_r->nsolvables;
+          if ( index.load( file, key, repo_r ) )
+          {
+            DBG << "Using trigram index " << file << endl;
+            return index;
+          }
+        }
+        index = TrigramIndex( repo_r, attr_r );
+        if ( ! file.empty() )
+          index.save( file, key );
+        return index;
       }
 
       void PoolImpl::setRepoInfo( RepoIdType id_r, const RepoInfo & info_r )
@@ -452,7 +1039,7 @@ namespace zypp
           }
 
           if ( dirty )
-            setDirty(__FUNCTION__, info_r.alias().c_str() );
+            repoSetDirty(__FUNCTION__, info_r.alias().c_str() );	// whatprovides does not depend on the priority
         }
         _repoinfos[id_r] = info_r;
       }
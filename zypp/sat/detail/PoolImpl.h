@@ -21,12 +21,14 @@ extern "C"
 #include <solv/pool_parserpmrichdep.h>
 }
 #include <iosfwd>
+#include <deque>
 
 #include <zypp/base/Hash.h>
 #include <zypp/base/NonCopyable.h>
 #include <zypp/base/SerialNumber.h>
 #include <zypp/base/SetTracker.h>
 #include <zypp/sat/detail/PoolMember.h>
+#include <zypp/sat/detail/TrigramIndex.h>
 #include <zypp/sat/SolvableSpec.h>
 #include <zypp/sat/Queue.h>
 #include <zypp/RepoInfo.h>
@@ -72,17 +74,37 @@ namespace zypp
           const SerialNumber & serialIDs() const
           { return _serialIDs; }
 
+          /** Serial number changing whenever the namespace providers (language, filesystem, etc.) are invalidated. */
+          const SerialNumber & serialNS() const
+          { return _serialNS; }
+
           /** Update housekeeping data (e.g. whatprovides).
            * \todo actually requires a watcher.
            */
           void prepare() const;
 
+          /** Number of whatprovides index updates (\ref updateWhatprovides) so far. */
+          unsigned whatprovidesUpdates() const
+          { return _whatprovidesUpdates; }
+
+          /** Number of whatprovides index full builds (\ref createWhatprovides) so far. */
+          unsigned whatprovidesBuilds() const
+          { return _whatprovidesBuilds; }
+
         private:
           /** Invalidate housekeeping data (e.g. whatprovides) if the
            *  pools content changed.
            */
           void setDirty( const char * a1 = 0, const char * a2 = 0, const char * a3 = 0 );
 
+          /** Like \ref setDirty, but if just repos or solvables are added or removed.
+           *  The whatprovides index is kept aside and updated by \ref prepare.
+           */
+          void repoSetDirty( const char * a1 = 0, const char * a2 = 0, const char * a3 = 0 );
+
+          /** Invalidate housekeeping data except for whatprovides. */
+          void contentSetDirty( const char * a1, const char * a2, const char * a3 );
+
           /** Invalidate locale related housekeeping data.
            */
           void localeSetDirty( const char * a1 = 0, const char * a2 = 0, const char * a3 = 0 );
@@ -91,6 +113,35 @@ namespace zypp
            */
           void depSetDirty( const char * a1 = 0, const char * a2 = 0, const char * a3 = 0 );
 
+          /** Invalidate the namespace providers (language, filesystem, etc.) in the whatprovides index.
+           */
+          void nsSetDirty( const char * a1 = 0, const char * a2 = 0, const char * a3 = 0 );
+
+          /** Detach the whatprovides index from the pool before repos or solvables are added or removed. */
+          void detachWhatprovides();
+
+          /** Update the detached whatprovides index. \return \c false if it must be created anew. */
+          bool updateWhatprovides( const sat::Queue & fileprovides_r ) const;
+
+          /** Create the whatprovides index anew. */
+          void createWhatprovides( const sat::Queue & fileprovides_r ) const;
+
+          /** Remember the new whatprovides index to update it after repo changes. */
+          void rememberWhatprovides( const sat::Queue & fileprovides_r ) const;
+
+          /** Key identifying the loaded solv files. Empty if the pool was loaded otherwise,
+           * or if file provides were added to its solvables already.
+           * \a file_r is set to the snapshot to use.
+           */
+          std::string whatprovidesSnapshotKey( Pathname & file_r ) const;
+
+          /** Use the whatprovides index and file provides from a snapshot, if its key matches. */
+          bool loadWhatprovidesSnapshot( const Pathname & file_r, const std::string & key_r ) const;
+
+          /** Save the whatprovides index and the file provides added since \a providesSizes_r. */
+          void saveWhatprovidesSnapshot( const Pathname & file_r, const std::string & key_r,
+                                         const std::vector<unsigned> & providesSizes_r, const sat::Queue & fileprovides_r ) const;
+
           /** Callback to resolve namespace dependencies (language, modalias, filesystem, etc.). */
           static detail::IdType nsCallback( CPool *, void * data, detail::IdType lhs, detail::IdType rhs );
 
@@ -135,8 +186,10 @@ namespace zypp
           /** Adding solv file to a repo.
            * Except for \c isSystemRepo_r, solvables of incompatible architecture
            * are filtered out.
+           * The solv files \a path_r, if known, enables a snapshot of the whatprovides
+           * index (\ref ZConfig::repo_whatprovides_snapshot).
           */
-          int _addSolv( CRepo * repo_r, FILE * file_r );
+          int _addSolv( CRepo * repo_r, FILE * file_r, const Pathname & path_r = Pathname() );
 
           /** Adding helix file to a repo.
            * Except for \c isSystemRepo_r, solvables of incompatible architecture
@@ -157,6 +210,35 @@ namespace zypp
           /** Helper postprocessing the repo after adding solv or helix files. */
           void _postRepoAdd( CRepo * repo_r );
 
+        public:
+          /** \name Solvable id ranges touched by content changes.
+           * Adding or deleting repos and solvables records the affected
+           * range of solvable ids. This allows \ref pool::PoolImpl to patch
+           * its PoolItem store rather than rescanning the whole pool.
+           * Only the most recent changes are remembered.
+           */
+          //@{
+          /** A range of solvable ids \c [first,second). */
+          using SolvableIdRange = std::pair<SolvableIdType,SolvableIdType>;
+
+          /** Position behind the most recently recorded range. */
+          unsigned changedRangesEnd() const
+          { return _changedRangesBegin + _changedRanges.size(); }
+
+          /** Append the ranges recorded since position \a pos_r to \a ranges_r.
+           * Returns \c false if they are no longer available, in which case
+           * the caller must rescan the whole pool.
+           */
+          bool changedRangesSince( unsigned pos_r, std::vector<SolvableIdRange> & ranges_r ) const;
+          //@}
+
+        private:
+          /** Remember the solvable id range currently covered by \a repo_r. */
+          void rememberChangedRange( CRepo * repo_r )
+          { rememberChangedRange( repo_r->start, repo_r->end ); }
+          /** Remember the solvable id range \c [begin_r,end_r). */
+          void rememberChangedRange( SolvableIdType begin_r, SolvableIdType end_r );
+
         public:
           /** a \c valid \ref Solvable has a non NULL repo pointer. */
           bool validSolvable( const CSolvable & slv_r ) const
@@ -347,6 +429,12 @@ namespace zypp
           { return _ptfPackageSpec.contains( solv_r ); }
           //@}
 
+        public:
+          /** The \ref TrigramIndex of \a attr_r in \a repo_r.
+           * Built on first use, or loaded from next to the solv file the repo was loaded from.
+           */
+          const TrigramIndex & trigramIndex( CRepo * repo_r, IdType attr_r ) const;
+
         public:
           /** accessor for etc/sysconfig/storage reading file on demand */
           const std::set<std::string> & requiredFilesystems() const;
@@ -358,10 +446,37 @@ namespace zypp
           SerialNumber _serial;
           /** Serial number of IDs - changes whenever resusePoolIDs==true - ResPool must also invalidate its PoolItems! */
           SerialNumber _serialIDs;
+          /** Serial number of the namespace providers - changes with each \ref nsSetDirty. */
+          SerialNumber _serialNS;
           /** Watch serial number. */
           SerialNumberWatcher _watcher;
           /** Additional \ref RepoInfo. */
           std::map<RepoIdType,RepoInfo> _repoinfos;
+          /** Whatprovides index remembered across repo changes. */
+          struct WhatprovidesCache;
+          mutable scoped_ptr<WhatprovidesCache> _whatprovidesCache;
+          mutable unsigned _whatprovidesUpdates = 0;
+          mutable unsigned _whatprovidesBuilds = 0;
+          /** Per repo data valid as long as the repos content does not change:
+           * the solv file it was loaded from (for the whatprovides snapshot)
+           * and the search indices built so far.
+           */
+          struct RepoSolvFile
+          {
+            Pathname _path;		///< empty if the repo was loaded otherwise
+            std::string _ident;		///< the files identity
+            bool _fileprovides = false;	///< whether file provides were added to the solvables
+            IdType _stringsBegin = 0;	///< pool strings created by loading the file [begin,end)
+            IdType _stringsEnd = 0;
+            IdType _relsBegin = 0;	///< pool rels created by loading the file [begin,end)
+            IdType _relsEnd = 0;
+            std::map<IdType,TrigramIndex> _trigramIndex;	///< per attribute
+          };
+          mutable std::map<RepoIdType,RepoSolvFile> _repoSolvFiles;
+          /** Recently changed solvable id ranges. */
+          std::deque<SolvableIdRange> _changedRanges;
+          /** Position of the 1st entry in \ref _changedRanges. */
+          unsigned _changedRangesBegin = 0;
 
           /**  */
           base::SetTracker<LocaleSet> _requestedLocalesTracker;
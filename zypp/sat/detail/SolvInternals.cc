@@ -0,0 +1,39 @@
+/*---------------------------------------------------------------------\
+|                          ____ _   __ __ ___                          |
+|                         |__  / \ / / . \ . \                         |
+|                           / / \ V /|  _/  _/                         |
+|                          / /__ | | | | | |                           |
+|                         /_____||_| |_| |_|                           |
+|                                                                      |
+\---------------------------------------------------------------------*/
+/** \file	zypp/sat/detail/SolvInternals.cc
+ * Pool members libsolv does not expose in its public API.
+ * Keep this file small, it is the only one built with libsolvs internal struct layout.
+*/
+#define LIBSOLV_INTERNAL
+extern "C"
+{
+#include <solv/pool.h>
+}
+#include <zypp/sat/detail/PoolMember.h>
+
+///////////////////////////////////////////////////////////////////
+namespace zypp
+{
+  ///////////////////////////////////////////////////////////////////
+  namespace sat
+  {
+    ///////////////////////////////////////////////////////////////////
+    namespace detail
+    {
+      void setAddedFileprovides( CPool * pool_r )
+      {
+        // as pool_addfileprovides_queue does
+        pool_r->addedfileprovides = pool_r->addfileprovidesfiltered ? 1 : 2;
+      }
+    } // namespace detail
+    ///////////////////////////////////////////////////////////////////
+  } // namespace sat
+  ///////////////////////////////////////////////////////////////////
+} // namespace zypp
+///////////////////////////////////////////////////////////////////
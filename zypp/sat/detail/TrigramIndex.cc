@@ -0,0 +1,302 @@
+/*---------------------------------------------------------------------\
+|                          ____ _   __ __ ___                          |
+|                         |__  / \ / / . \ . \                         |
+|                           / / \ V /|  _/  _/                         |
+|                          / /__ | | | | | |                           |
+|                         /_____||_| |_| |_|                           |
+|                                                                      |
+\---------------------------------------------------------------------*/
+/** \file	zypp/sat/detail/TrigramIndex.cc
+ *
+*/
+extern "C"
+{
+#include <solv/repo.h>
+}
+#include <iostream>
+#include <fstream>
+#include <algorithm>
+#include <cstring>
+#include <unordered_map>
+
+#include <zypp/base/LogTools.h>
+#include <zypp/base/StrMatcher.h>
+#include <zypp/PathInfo.h>
+#include <zypp/TmpPath.h>
+#include <zypp/Repository.h>
+#include <zypp/sat/LookupAttr.h>
+
+#include <zypp/sat/detail/TrigramIndex.h>
+
+using std::endl;
+
+///////////////////////////////////////////////////////////////////
+namespace zypp
+{
+  ///////////////////////////////////////////////////////////////////
+  namespace sat
+  {
+    ///////////////////////////////////////////////////////////////////
+    namespace detail
+    {
+      ///////////////////////////////////////////////////////////////////
+      namespace
+      {
+        /** Index file format version. */
+        const std::string indexMagic { "ZYPP-TRIGRAMS-1" };
+
+        inline unsigned char asciiLower( unsigned char ch_r )
+        { return ( 'A' <= ch_r && ch_r <= 'Z' ) ? ch_r + ( 'a' - 'A' ) : ch_r; }
+
+        /** Append the trigrams of \a str_r to \a trigrams_r.
+         * Unless \a nonAscii_r, trigrams containing non ASCII bytes are skipped.
+         */
+        void addTrigrams( const char * str_r, std::size_t size_r, std::vector<TrigramIndex::Trigram> & trigrams_r, bool nonAscii_r = true )
+        {
+          for ( std::size_t i = 2; i < size_r; ++i )
+          {
+            unsigned char a = str_r[i-2], b = str_r[i-1], c = str_r[i];
+            if ( ! nonAscii_r && ( ( a | b | c ) & 0x80 ) )
+              continue;
+            trigrams_r.push_back( asciiLower( a ) << 16 | asciiLower( b ) << 8 | asciiLower( c ) );
+          }
+        }
+
+        template <class Tp>
+        void sortUnique( std::vector<Tp> & vec_r )
+        {
+          std::sort( vec_r.begin(), vec_r.end() );
+          vec_r.erase( std::unique( vec_r.begin(), vec_r.end() ), vec_r.end() );
+        }
+
+        /** Call \a fnc_r with each Solvable (relative to the repos start) and the trigrams in its values of \a attr_r. */
+        template <class Fnc>
+        void forEachSolvableTrigrams( CRepo * repo_r, IdType attr_r, Fnc && fnc_r )
+        {
+          std::vector<TrigramIndex::Trigram> trigrams;
+          SolvableIdType current = 0;
+          LookupAttr q( (SolvAttr(attr_r)), Repository( repo_r ) );
+          for_( it, q.begin(), q.end() )
+          {
+            if ( it.inSolvable().id() != current )
+            {
+              if ( current )
+              {
+                sortUnique( trigrams );
+                fnc_r( current - repo_r->start, trigrams );
+                trigrams.clear();
+              }
+              current = it.inSolvable().id();
+            }
+            const char * str { it.c_str() };
+            if ( str )
+              addTrigrams( str, ::strlen( str ), trigrams );
+          }
+          if ( current )
+          {
+            sortUnique( trigrams );
+            fnc_r( current - repo_r->start, trigrams );
+          }
+        }
+
+        template <class Tp>
+        void writeIndexData( std::ostream & str, const std::vector<Tp> & data_r )
+        { str.write( reinterpret_cast<const char *>( data_r.data() ), data_r.size() * sizeof(Tp) ); }
+
+        template <class Tp>
+        bool readIndexData( std::istream & str, std::vector<Tp> & data_r, std::size_t size_r )
+        {
+          data_r.resize( size_r );
+          return bool( str.read( reinterpret_cast<char *>( data_r.data() ), size_r * sizeof(Tp) ) );
+        }
+      } // namespace
+      ///////////////////////////////////////////////////////////////////
+
+      TrigramIndex::TrigramIndex( CRepo * repo_r, IdType attr_r )
+      : _start( repo_r->start )
+      {
+        // Count the Solvables per trigram first, then store them.
+        std::unordered_map<Trigram,unsigned> slot;
+        forEachSolvableTrigrams( repo_r, attr_r, [&]( unsigned, const std::vector<Trigram> & trigrams_r ) {
+          for ( Trigram trigram : trigrams_r )
+            ++slot[trigram];
+        });
+
+        _trigrams.reserve( slot.size() );
+        for ( const auto & el : slot )
+          _trigrams.push_back( el.first );
+        std::sort( _trigrams.begin(), _trigrams.end() );
+
+        _offsets.reserve( _trigrams.size() + 1 );
+        _offsets.push_back( 0 );
+        for ( Trigram trigram : _trigrams )
+        {
+          unsigned & count { slot[trigram] };
+          _offsets.push_back( _offsets.back() + count );
+          count = _offsets[_offsets.size()-2];	// now the next free slot
+        }
+
+        _solvables.resize( _offsets.back() );
+        forEachSolvableTrigrams( repo_r, attr_r, [&]( unsigned solvable_r, const std::vector<Trigram> & trigrams_r ) {
+          for ( Trigram trigram : trigrams_r )
+            _solvables[slot[trigram]++] = solvable_r;
+        });
+        DBG << "Trigram index " << IdString(attr_r) << " of " << repo_r->name << ": "
+            << _trigrams.size() << " trigrams, " << _solvables.size() << " entries" << endl;
+      }
+
+      bool TrigramIndex::load( const Pathname & file_r, const std::string & key_r, CRepo * repo_r )
+      {
+        std::ifstream str( file_r.c_str(), std::ios::binary );
+        if ( ! str )
+          return false;
+
+        std::string magic;
+        std::string key;
+        std::getline( str, magic );
+        std::getline( str, key );
+        if ( magic != indexMagic || key != key_r )
+          return false;
+
+        // sizes: trigrams, entries
+        std::vector<unsigned> sizes;
+        std::vector<Trigram> trigrams;
+        std::vector<unsigned> offsets;
+        std::vector<unsigned> solvables;
+        if ( ! ( readIndexData( str, sizes, 2 )
+                 && readIndexData( str, trigrams, sizes[0] )
+                 && readIndexData( str, offsets, sizes[0] + 1 )
+                 && readIndexData( str, solvables, sizes[1] ) ) )
+        {
+          WAR << "Trigram index " << file_r << " is truncated" << endl;
+          return false;
+        }
+        if ( offsets.front() != 0 || offsets.back() != solvables.size()
+             || ! std::is_sorted( offsets.begin(), offsets.end() ) || ! std::is_sorted( trigrams.begin(), trigrams.end() ) )
+          return false;
+        const unsigned range = repo_r->end - repo_r->start;
+        for ( unsigned solvable : solvables )
+        {
+          if ( solvable >= range )
+            return false;
+        }
+
+        _start = repo_r->start;
+        _trigrams.swap( trigrams );
+        _offsets.swap( offsets );
+        _solvables.swap( solvables );
+        return true;
+      }
+
+      bool TrigramIndex::save( const Pathname & file_r, const std::string & key_r ) const
+      {
+        filesystem::TmpFile tmp { filesystem::TmpFile::makeSibling( file_r, 0644 ) };
+        if ( ! tmp )
+        {
+          DBG << "Can not write trigram index " << file_r << endl;	// e.g. not root
+          return false;
+        }
+        std::ofstream str( tmp.path().c_str(), std::ios::binary );
+        str << indexMagic << '\n' << key_r << '\n';
+        writeIndexData( str, std::vector<unsigned>{ unsigned(_trigrams.size()), unsigned(_solvables.size()) } );
+        writeIndexData( str, _trigrams );
+        writeIndexData( str, _offsets );
+        writeIndexData( str, _solvables );
+        str.close();
+        if ( ! str || filesystem::rename( tmp.path(), file_r ) != 0 )
+        {
+          WAR << "Can not write trigram index " << file_r << endl;
+          return false;
+        }
+        return true;
+      }
+
+      bool TrigramIndex::trigrams( const StrMatcher & matcher_r, std::vector<Trigram> & trigrams_r )
+      {
+        const std::string & search { matcher_r.searchstring() };
+        const Match & flags { matcher_r.flags() };
+        // Beyond ASCII case folding depends on the locale, so those trigrams are not used.
+        bool nonAscii = ! flags.test( Match::NOCASE );
+
+        std::vector<Trigram> ret;
+        switch ( flags.mode() )
+        {
+          case Match::STRING:
+          case Match::STRINGSTART:
+          case Match::STRINGEND:
+          case Match::SUBSTRING:
+            addTrigrams( search.c_str(), search.size(), ret, nonAscii );
+            break;
+
+          case Match::GLOB:
+          {
+            // The literal parts between the wildcards. Bracket expressions are not parsed.
+            std::string literal;
+            for ( std::string::size_type i = 0; i < search.size(); ++i )
+            {
+              char ch = search[i];
+              if ( ch == '[' )
+                return false;
+              if ( ch == '*' || ch == '?' )
+              {
+                addTrigrams( literal.c_str(), literal.size(), ret, nonAscii );
+                literal.clear();
+              }
+              else if ( ch == '\\' && i+1 < search.size() )
+                literal += search[++i];
+              else
+                literal += ch;
+            }
+            addTrigrams( literal.c_str(), literal.size(), ret, nonAscii );
+          }
+          break;
+
+          default:	// REGEX (also used for several search strings)
+            return false;
+        }
+
+        if ( ret.empty() )
+          return false;
+        sortUnique( ret );
+        trigrams_r.insert( trigrams_r.end(), ret.begin(), ret.end() );
+        return true;
+      }
+
+      void TrigramIndex::find( const std::vector<Trigram> & trigrams_r, std::vector<SolvableIdType> & ids_r ) const
+      {
+        // The entries of each trigram, intersected starting with the shortest.
+        std::vector<std::pair<unsigned,unsigned>> ranges;
+        for ( Trigram trigram : trigrams_r )
+        {
+          auto it { std::lower_bound( _trigrams.begin(), _trigrams.end(), trigram ) };
+          if ( it == _trigrams.end() || *it != trigram )
+            return;	// not contained in any Solvable
+          unsigned idx = it - _trigrams.begin();
+          ranges.push_back( { _offsets[idx], _offsets[idx+1] } );
+        }
+        if ( ranges.empty() )
+          return;
+        std::sort( ranges.begin(), ranges.end(), []( const auto & lhs, const auto & rhs ) {
+          return( lhs.second - lhs.first < rhs.second - rhs.first );
+        });
+
+        std::vector<unsigned> result( _solvables.begin() + ranges[0].first, _solvables.begin() + ranges[0].second );
+        std::vector<unsigned> next;
+        for ( unsigned i = 1; i < ranges.size() && ! result.empty(); ++i )
+        {
+          next.clear();
+          std::set_intersection( result.begin(), result.end(),
+                                 _solvables.begin() + ranges[i].first, _solvables.begin() + ranges[i].second,
+                                 std::back_inserter( next ) );
+          result.swap( next );
+        }
+        for ( unsigned solvable : result )
+          ids_r.push_back( _start + solvable );
+      }
+
+    } // namespace detail
+    ///////////////////////////////////////////////////////////////////
+  } // namespace sat
+  ///////////////////////////////////////////////////////////////////
+} // namespace zypp
+///////////////////////////////////////////////////////////////////
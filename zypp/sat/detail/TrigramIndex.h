@@ -0,0 +1,86 @@
+/*---------------------------------------------------------------------\
+|                          ____ _   __ __ ___                          |
+|                         |__  / \ / / . \ . \                         |
+|                           / / \ V /|  _/  _/                         |
+|                          / /__ | | | | | |                           |
+|                         /_____||_| |_| |_|                           |
+|                                                                      |
+\---------------------------------------------------------------------*/
+/** \file	zypp/sat/detail/TrigramIndex.h
+ *
+*/
+#ifndef ZYPP_SAT_DETAIL_TRIGRAMINDEX_H
+#define ZYPP_SAT_DETAIL_TRIGRAMINDEX_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <zypp/sat/detail/PoolMember.h>
+#include <zypp/Pathname.h>
+
+///////////////////////////////////////////////////////////////////
+namespace zypp
+{
+  class StrMatcher;
+
+  ///////////////////////////////////////////////////////////////////
+  namespace sat
+  {
+    ///////////////////////////////////////////////////////////////////
+    namespace detail
+    {
+      ///////////////////////////////////////////////////////////////////
+      /// \class TrigramIndex
+      /// \brief The Solvables of a repo containing some trigrams in an attribute.
+      ///
+      /// A trigram is a sequence of 3 bytes in the (ASCII lowercased) string
+      /// values of an attribute. A string containing the search string of a
+      /// \ref StrMatcher contains all its trigrams. So the index tells a few
+      /// candidates to check, instead of checking all the strings.
+      ///
+      /// The Solvables are stored relative to the repos start, so the index
+      /// can be saved along with the solv file the repo was loaded from.
+      ///////////////////////////////////////////////////////////////////
+      class TrigramIndex
+      {
+      public:
+        using Trigram = std::uint32_t;
+
+      public:
+        /** Default ctor: an empty index. */
+        TrigramIndex()
+        {}
+
+        /** Index the string values of \a attr_r in \a repo_r. */
+        TrigramIndex( CRepo * repo_r, IdType attr_r );
+
+        /** Load the index of \a repo_r from \a file_r if it was saved with \a key_r. */
+        bool load( const Pathname & file_r, const std::string & key_r, CRepo * repo_r );
+
+        /** Save the index to \a file_r (replacing it atomically). */
+        bool save( const Pathname & file_r, const std::string & key_r ) const;
+
+      public:
+        /** Append the trigrams a string matched by \a matcher_r must contain to \a trigrams_r (sorted, unique).
+         * Returns \c false if the index can not serve the match mode or the search string is too short.
+         */
+        static bool trigrams( const StrMatcher & matcher_r, std::vector<Trigram> & trigrams_r );
+
+        /** Append the Solvables containing all \a trigrams_r to \a ids_r (sorted). */
+        void find( const std::vector<Trigram> & trigrams_r, std::vector<SolvableIdType> & ids_r ) const;
+
+      private:
+        SolvableIdType _start = 0;		///< the repos start
+        std::vector<Trigram> _trigrams;		///< the indexed trigrams (sorted)
+        std::vector<unsigned> _offsets;		///< _trigrams[i] is in _solvables[_offsets[i],_offsets[i+1])
+        std::vector<unsigned> _solvables;	///< relative to _start
+      };
+
+    } // namespace detail
+    ///////////////////////////////////////////////////////////////////
+  } // namespace sat
+  ///////////////////////////////////////////////////////////////////
+} // namespace zypp
+///////////////////////////////////////////////////////////////////
+#endif // ZYPP_SAT_DETAIL_TRIGRAMINDEX_H
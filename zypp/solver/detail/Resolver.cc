@@ -146,6 +146,9 @@ bool Resolver::removeOrphaned() const                   { return _satResolver->_
 void Resolver::setRemoveUnneeded( bool yesno_r )        { _satResolver->_removeUnneeded = yesno_r; }
 bool Resolver::removeUnneeded() const                   { return _satResolver->_removeUnneeded; }
 
+void Resolver::setReuseSolverResult( bool yesno_r )     { _satResolver->_reuseResult = yesno_r; }
+bool Resolver::reuseSolverResult() const                { return _satResolver->_reuseResult; }
+
 #define ZOLV_FLAG_TRIBOOL( ZSETTER, ZGETTER, ZVARDEFAULT, ZVARNAME )			\
     void Resolver::ZSETTER( TriBool state_r )						\
     { _applyDefault_##ZGETTER = indeterminate(state_r);					\
@@ -204,6 +204,9 @@ class ZYPP_API_DEPTESTOMATIC Resolver : private base::NonCopyable
     void setRemoveUnneeded( bool yesno_r );
     bool removeUnneeded() const;
 
+    void setReuseSolverResult( bool yesno_r );
+    bool reuseSolverResult() const;
+
     void setFocus( ResolverFocus focus_r );
     ResolverFocus focus() const;
 
@@ -291,6 +291,7 @@ SATResolver::SATResolver (ResPool  pool, sat::detail::CPool *satPool)
     : _pool(std::move(pool))
     , _satPool(satPool)
     , _satSolver(NULL)
+    , _prevSolver(NULL)
     , _focus			( ZConfig::instance().solver_focus() )
     , _fixsystem(false)
     , _allowdowngrade		( false )
@@ -312,6 +313,7 @@ SATResolver::SATResolver (ResPool  pool, sat::detail::CPool *satPool)
     , _dup_allowvendorchange	( ZConfig::instance().solver_dupAllowVendorChange() )
     , _solveSrcPackages(false)
     , _cleandepsOnRemove(ZConfig::instance().solver_cleandepsOnRemove())
+    , _reuseResult(false)
 {
 }
 
@@ -319,6 +321,7 @@ SATResolver::SATResolver (ResPool  pool, sat::detail::CPool *satPool)
 SATResolver::~SATResolver()
 {
   solverEnd();
+  prevSolverEnd();
 }
 
 //---------------------------------------------------------------------------
@@ -441,6 +444,19 @@ SATResolver::solverEnd()
     _satSolver = NULL;
     queue_free( &(_jobQueue) );
   }
+  _fingerprint.clear();
+}
+
+void
+SATResolver::prevSolverEnd()
+{
+  if ( _prevSolver )
+  {
+    solver_free(_prevSolver);
+    _prevSolver = NULL;
+    queue_free( &(_prevJobQueue) );
+  }
+  _prevFingerprint.clear();
 }
 
 void
@@ -449,6 +465,15 @@ SATResolver::solverInit(const PoolItemList & weakItems)
     MIL << "SATResolver::solverInit()" << endl;
 
     // Remove old stuff and create a new jobqueue
+    prevSolverEnd();
+    if ( _reuseResult && _satSolver && ! _fingerprint.empty() )
+    {
+      // Keep the last run, solving() may reuse it.
+      _prevSolver = _satSolver;
+      _prevJobQueue = _jobQueue;
+      _prevFingerprint.swap( _fingerprint );
+      _satSolver = NULL;
+    }
     solverEnd();
     _satSolver = solver_create( _satPool );
     queue_init( &_jobQueue );
@@ -673,6 +698,39 @@ void SATResolver::solverInitSetModeJobsAndFlags()
     solver_set_flag(_satSolver, SOLVER_FLAG_DUP_ALLOW_VENDORCHANGE,	_dup_allowvendorchange );
 }
 
+std::vector<sat::detail::IdType> SATResolver::solverFingerprint() const
+{
+  // The jobs...
+  std::vector<sat::detail::IdType> ret( _jobQueue.elements, _jobQueue.elements + _jobQueue.count );
+  ret.push_back( ID_NULL );
+  // ...the solver flags (-1 if unknown)...
+  for ( int flag = 1; flag < 64; ++flag )
+    ret.push_back( solver_get_flag( _satSolver, flag ) );
+  // ...and what else affects the result.
+  ret.push_back( myPool().serial().serial() );
+  ret.push_back( myPool().serialNS().serial() );	// nsSetDirty does not touch serial()
+  ret.push_back( ::pool_get_custom_vendorcheck( _satPool ) == &relaxedVendorCheck );
+  ret.push_back( _distupgrade );
+  ret.push_back( _removeOrphaned );
+  ret.push_back( ZConfig::instance().solverUpgradeRemoveDroppedPackages() );
+  return ret;
+}
+
+bool SATResolver::solverReusePrev()
+{
+  if ( ! _prevSolver || _fingerprint.empty() || _fingerprint != _prevFingerprint )
+    return false;
+
+  // The previous solver and its jobs (incl. those added in solving()).
+  solver_free( _satSolver );
+  queue_free( &(_jobQueue) );
+  _satSolver = _prevSolver;
+  _jobQueue = _prevJobQueue;
+  _prevSolver = NULL;
+  _prevFingerprint.clear();
+  return true;
+}
+
 //----------------------------------------------------------------------------
 //----------------------------------------------------------------------------
 // solving.....
@@ -713,54 +771,64 @@ SATResolver::solving(const CapabilitySet & requires_caps,
 {
     sat::Pool::instance().prepare();
 
-    // Solve !
-    MIL << "Starting solving...." << endl;
-    MIL << *this;
-    if ( solver_solve( _satSolver, &(_jobQueue) ) == 0 )
+    if ( _reuseResult )
+      _fingerprint = solverFingerprint();
+
+    if ( solverReusePrev() )
+    {
+      MIL << "Nothing changed since the last run. Reusing its result." << endl;
+    }
+    else
     {
-      // bsc#1155819: Weakremovers of future product not evaluated.
-      // Do a 2nd run to cleanup weakremovers() of to be installed
-      // Produtcs unless removeunsupported is active (cleans up all).
-      if ( _distupgrade )
+      // Solve !
+      MIL << "Starting solving...." << endl;
+      MIL << *this;
+      if ( solver_solve( _satSolver, &(_jobQueue) ) == 0 )
       {
-        if ( _removeOrphaned )
-          MIL << "Droplist processing not needed. RemoveUnsupported is On." << endl;
-        else if ( ! ZConfig::instance().solverUpgradeRemoveDroppedPackages() )
-          MIL << "Droplist processing is disabled in ZConfig." << endl;
-        else
+        // bsc#1155819: Weakremovers of future product not evaluated.
+        // Do a 2nd run to cleanup weakremovers() of to be installed
+        // Produtcs unless removeunsupported is active (cleans up all).
+        if ( _distupgrade )
         {
-          bool resolve = false;
-          MIL << "Checking droplists ..." << endl;
-          // get Solvables to be installed...
-          sat::SolvableQueue decisionq;
-          solver_get_decisionqueue( _satSolver, decisionq );
-          for ( sat::detail::IdType id : decisionq )
+          if ( _removeOrphaned )
+            MIL << "Droplist processing not needed. RemoveUnsupported is On." << endl;
+          else if ( ! ZConfig::instance().solverUpgradeRemoveDroppedPackages() )
+            MIL << "Droplist processing is disabled in ZConfig." << endl;
+          else
           {
-            if ( id < 0 )
-              continue;
-            sat::Solvable slv { (sat::detail::SolvableIdType)id };
-            // get product buddies (they carry the weakremover)...
-            static const Capability productCap { "product()" };
-            if ( slv && slv.provides().matches( productCap ) )
+            bool resolve = false;
+            MIL << "Checking droplists ..." << endl;
+            // get Solvables to be installed...
+            sat::SolvableQueue decisionq;
+            solver_get_decisionqueue( _satSolver, decisionq );
+            for ( sat::detail::IdType id : decisionq )
             {
-              CapabilitySet droplist { slv.valuesOfNamespace( "weakremover" ) };
-              MIL << "Droplist for " << slv << ": size " << droplist.size() << endl;
-              if ( !droplist.empty() )
+              if ( id < 0 )
+                continue;
+              sat::Solvable slv { (sat::detail::SolvableIdType)id };
+              // get product buddies (they carry the weakremover)...
+              static const Capability productCap { "product()" };
+              if ( slv && slv.provides().matches( productCap ) )
               {
-                for ( const auto & cap : droplist )
+                CapabilitySet droplist { slv.valuesOfNamespace( "weakremover" ) };
+                MIL << "Droplist for " << slv << ": size " << droplist.size() << endl;
+                if ( !droplist.empty() )
                 {
-                  queue_push( &_jobQueue, SOLVER_DROP_ORPHANED | SOLVER_SOLVABLE_NAME );
-                  queue_push( &_jobQueue, cap.id() );
+                  for ( const auto & cap : droplist )
+                  {
+                    queue_push( &_jobQueue, SOLVER_DROP_ORPHANED | SOLVER_SOLVABLE_NAME );
+                    queue_push( &_jobQueue, cap.id() );
+                  }
+                  // PIN product - a safety net to prevent cleanup from changing the decision for this product
+                  queue_push( &(_jobQueue), SOLVER_INSTALL | SOLVER_SOLVABLE );
+                  queue_push( &(_jobQueue), id );
+                  resolve = true;
                 }
-                // PIN product - a safety net to prevent cleanup from changing the decision for this product
-                queue_push( &(_jobQueue), SOLVER_INSTALL | SOLVER_SOLVABLE );
-                queue_push( &(_jobQueue), id );
-                resolve = true;
               }
             }
+            if ( resolve )
+              solver_solve( _satSolver, &(_jobQueue) );
           }
-          if ( resolve )
-            solver_solve( _satSolver, &(_jobQueue) );
         }
       }
     }
@@ -70,6 +70,12 @@ class SATResolver : public base::ReferenceCounted, private base::NonCopyable, pr
     sat::detail::CPool *_satPool;
     sat::detail::CSolver *_satSolver;
     sat::detail::CQueue _jobQueue;
+    std::vector<sat::detail::IdType> _fingerprint;	// of the _satSolver run (if _reuseResult)
+
+    // the previous solver run kept for reuse (if _reuseResult)
+    sat::detail::CSolver *_prevSolver;
+    sat::detail::CQueue _prevJobQueue;
+    std::vector<sat::detail::IdType> _prevFingerprint;
 
     // list of problematic items (orphaned)
     PoolItemList _problem_items;
@@ -107,6 +113,7 @@ class SATResolver : public base::ReferenceCounted, private base::NonCopyable, pr
     bool _dup_allowvendorchange:1;	// dup mode: allow one to change vendor of installed solvables
     bool _solveSrcPackages:1;		// false: generate no job rule for source packages selected in the pool
     bool _cleandepsOnRemove:1;		// whether removing a package should also remove no longer needed requirements
+    bool _reuseResult:1;		// reuse the previous solver run if jobs, flags and pool are unchanged
 
   private:
     bool _protectPTFs:1;		// protect from accidental removal of PTFs if only @System is present (bsc#1203248)
@@ -132,6 +139,13 @@ class SATResolver : public base::ReferenceCounted, private base::NonCopyable, pr
     // cleanup solver
     void solverEnd();
 
+    // what the result of a solver run with the _jobQueue depends on
+    std::vector<sat::detail::IdType> solverFingerprint() const;
+    // take the previous solver run if its fingerprint matches
+    bool solverReusePrev();
+    // cleanup the previous solver run
+    void prevSolverEnd();
+
    // Checking if this solvable/item has a buddy which reflect the real
    // user visible description of an item
    // e.g. The release package has a buddy to the concerning product item.
@@ -33,32 +33,24 @@ namespace zypp
   { /////////////////////////////////////////////////////////////////
 
     ///////////////////////////////////////////////////////////////////
-    namespace {
-      ///////////////////////////////////////////////////////////////////
-      /// \class QueryInstalledEditionHelper
-      /// \short Helper for PackageProvider queries during download.
-      /// Queries the exact version of a currently installed package
-      /// in context(/) which may then be used by \ref applydeltarpm
-      /// to build a final rpm.
-      ///////////////////////////////////////////////////////////////////
-      struct QueryInstalledEditionHelper
+    //
+    //	class QueryInstalledEditionHelper
+    //
+    ///////////////////////////////////////////////////////////////////
+
+    bool QueryInstalledEditionHelper::operator()( const std::string & name_r, const Edition & ed_r, const Arch & arch_r ) const
+    {
+      rpm::librpmDb::db_const_iterator it( "/" );
+      for ( it.findByName( name_r ); *it; ++it )
       {
-        bool operator()( const std::string & name_r, const Edition & ed_r, const Arch & arch_r ) const
+        if ( arch_r == it->tag_arch()
+          && ( ed_r == Edition::noedition || ed_r == it->tag_edition() ) )
         {
-          rpm::librpmDb::db_const_iterator it( "/" );
-          for ( it.findByName( name_r ); *it; ++it )
-          {
-            if ( arch_r == it->tag_arch()
-              && ( ed_r == Edition::noedition || ed_r == it->tag_edition() ) )
-            {
-              return true;
-            }
-          }
-          return false;
+          return true;
         }
-      };
-    } // namespace
-    ///////////////////////////////////////////////////////////////////
+      }
+      return false;
+    }
 
     ///////////////////////////////////////////////////////////////////
     //
@@ -144,7 +136,10 @@ namespace zypp
     { _pimpl->setCommitList( std::move(commitList_r) ); }
 
     ManagedFile CommitPackageCache::get( const PoolItem & citem_r )
-    { return _pimpl->get( citem_r ); }
+    {
+      _pimpl->enterHeapOf( citem_r );
+      return _pimpl->get( citem_r );
+    }
 
     bool CommitPackageCache::preloaded() const
     { return _pimpl->preloaded(); }
@@ -152,6 +147,12 @@ namespace zypp
     void CommitPackageCache::preloaded( bool newval_r )
     { _pimpl->preloaded( newval_r ); }
 
+    void CommitPackageCache::prefetch( const ProgressData::ReceiverFnc & progress_r )
+    { _pimpl->prefetch( progress_r ); }
+
+    void CommitPackageCache::downloadInHeaps( ByteCount maxHeapSize_r, const ProgressData::ReceiverFnc & progress_r )
+    { _pimpl->downloadInHeaps( maxHeapSize_r, progress_r ); }
+
     /******************************************************************
     **
     **	FUNCTION NAME : operator<<
@@ -20,6 +20,8 @@
 #include <zypp/PoolItem.h>
 #include <zypp/Pathname.h>
 #include <zypp/ManagedFile.h>
+#include <zypp/ProgressData.h>
+#include <zypp/ByteCount.h>
 
 ///////////////////////////////////////////////////////////////////
 namespace zypp
@@ -96,6 +98,26 @@ namespace zypp
       /** Set preloaded hint. */
       void preloaded( bool newval_r );
 
+      /** Download the packages to install in advance, several at once.
+       * The packages are picked up by \ref get. A package which fails to
+       * download here is downloaded (and the problem reported) by \ref get.
+       * Does nothing if <tt>download.max_parallel_packages</tt> is less than 2.
+       * \see \ref CommitPackagePrefetcher
+       * \throws AbortRequestException if \a progress_r requests to abort.
+       */
+      void prefetch( const ProgressData::ReceiverFnc & progress_r = ProgressData::ReceiverFnc() );
+
+      /** Download the packages to install heap by heap (\ref DownloadInHeaps).
+       * The commit list is split into heaps of about half \a maxHeapSize_r, closed
+       * only where the requirements of the packages installed so far are met.
+       * The 1st heap is downloaded now. When \ref get is asked for the 1st package
+       * of a heap, the staged files of the previous heap are removed and the next
+       * heap is downloaded in the background. Packages which could not be downloaded
+       * this way are downloaded by \ref get.
+       * \throws AbortRequestException if \a progress_r requests to abort.
+       */
+      void downloadInHeaps( ByteCount maxHeapSize_r, const ProgressData::ReceiverFnc & progress_r = ProgressData::ReceiverFnc() );
+
     public:
       /** Implementation. */
       class Impl;
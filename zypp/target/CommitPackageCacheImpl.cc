@@ -10,9 +10,17 @@
  *
 */
 #include <iostream>
+#include <algorithm>
+#include <unordered_set>
 #include <zypp/base/Logger.h>
 
 #include <zypp/target/CommitPackageCacheImpl.h>
+#include <zypp/sat/WhatProvides.h>
+#include <zypp/target/rpm/RpmDb.h>
+#include <zypp/Package.h>
+#include <zypp/Target.h>
+#include <zypp/ZConfig.h>
+#include <zypp/ZYppFactory.h>
 
 using std::endl;
 
@@ -23,7 +31,211 @@ namespace zypp
   namespace target
   { /////////////////////////////////////////////////////////////////
 
+    ///////////////////////////////////////////////////////////////////
+    namespace
+    {
+      /** Whether \a cap_r is unmet, but will be provided by a later step of the transaction.
+       * \a done_r are the steps done so far. Requirements nothing in the transaction
+       * provides do not count (e.g. rpmlib() or namespaces).
+       */
+      bool waitsForLaterStep( const Capability & cap_r, const std::unordered_set<sat::Solvable> & done_r )
+      {
+        bool later = false;
+        for ( const sat::Solvable & prov : sat::WhatProvides( cap_r ) )
+        {
+          PoolItem pi { prov };
+          if ( prov.isSystem() )
+          {
+            if ( ! ( pi.status().isToBeUninstalled() && done_r.count( prov ) ) )
+              return false;	// still installed
+          }
+          else if ( pi.status().isToBeInstalled() )
+          {
+            if ( done_r.count( prov ) )
+              return false;	// installed already
+            later = true;
+          }
+        }
+        return later;
+      }
 
+      /** Check the signatures of the staged packages all at once.
+       * The results are remembered by the \ref rpm::RpmDb and used when the packages
+       * are provided one by one. Errors are reported there, not here.
+       */
+      void checkStagedSignatures( const CommitPackagePrefetcher & prefetcher_r )
+      {
+        std::vector<Pathname> files { prefetcher_r.stagedFilesToCheck() };
+        if ( files.empty() )
+          return;
+
+        Target_Ptr target { getZYpp()->getTarget() };
+        if ( ! target )
+          return;
+
+        try
+        {
+          target->rpmDb().checkPackageSignatures( files );
+        }
+        catch ( const Exception & excpt )
+        {
+          ZYPP_CAUGHT( excpt );
+        }
+      }
+    } // namespace
+    ///////////////////////////////////////////////////////////////////
+
+    std::vector<std::vector<PoolItem>> computeHeaps( const std::vector<sat::Solvable> & commitList_r, ByteCount maxSize_r )
+    {
+      std::vector<std::vector<PoolItem>> heaps;
+      std::vector<PoolItem> heap;
+      ByteCount heapSize;
+      std::unordered_set<sat::Solvable> done;
+      std::vector<Capability> pending;	// requirements a later step provides
+
+      for ( const sat::Solvable & solv : commitList_r )
+      {
+        PoolItem pi { solv };
+        if ( ! ( pi.status().isToBeInstalled() && pi->isKind<Package>() ) )
+        {
+          done.insert( solv );
+          continue;
+        }
+
+        if ( ! heap.empty() && pending.empty() && heapSize + pi->downloadSize() > maxSize_r )
+        {
+          heaps.push_back( std::move(heap) );
+          heap.clear();
+          heapSize = 0;
+        }
+        heap.push_back( pi );
+        heapSize += pi->downloadSize();
+        done.insert( solv );
+
+        for ( const Capability & cap : solv.requires() )
+          pending.push_back( cap );
+        pending.erase( std::remove_if( pending.begin(), pending.end(), [&done]( const Capability & cap_r ) {
+                         return ! waitsForLaterStep( cap_r, done );
+                       } ), pending.end() );
+      }
+      if ( ! heap.empty() )
+        heaps.push_back( std::move(heap) );
+      return heaps;
+    }
+
+    CommitPackageCache::Impl::~Impl()
+    {
+      _cancelNext = true;
+      finishNextHeap();
+    }
+
+    void CommitPackageCache::Impl::prefetch( const ProgressData::ReceiverFnc & progress_r )
+    {
+      if ( ZConfig::instance().download_max_parallel_packages() < 2 )
+        return;
+
+      if ( ! _prefetcher )
+        _prefetcher.reset( new CommitPackagePrefetcher );
+
+      for ( const sat::Solvable & solv : _commitList )
+      {
+        PoolItem pi( solv );
+        if ( pi.status().isToBeInstalled() )
+          _prefetcher->add( pi );
+      }
+      MIL << *_prefetcher << endl;
+      _prefetcher->run( progress_r );
+      checkStagedSignatures( *_prefetcher );
+    }
+
+    void CommitPackageCache::Impl::downloadInHeaps( ByteCount maxHeapSize_r, const ProgressData::ReceiverFnc & progress_r )
+    {
+      // While a heap is installed the next one is downloaded, so each gets half of the space.
+      _heaps = computeHeaps( _commitList, ByteCount( maxHeapSize_r / 2 ) );
+      _heapOf.clear();
+      for ( unsigned i = 0; i < _heaps.size(); ++i )
+      {
+        for ( const PoolItem & pi : _heaps[i] )
+          _heapOf[pi.satSolvable()] = i;
+      }
+      MIL << "Commit in " << _heaps.size() << " heaps of about " << ByteCount( maxHeapSize_r / 2 ) << endl;
+      if ( _heaps.empty() )
+        return;
+
+      // The 1st heap is downloaded now, each following one while the previous one is installed.
+      _currentHeap = 0;
+      _prefetcher.reset( new CommitPackagePrefetcher );
+      for ( const PoolItem & pi : _heaps[0] )
+        _prefetcher->add( pi );
+      MIL << "Heap 0: " << *_prefetcher << endl;
+      _prefetcher->run( progress_r );
+      checkStagedSignatures( *_prefetcher );
+
+      startHeap( 1 );
+    }
+
+    void CommitPackageCache::Impl::enterHeapOf( const PoolItem & citem_r )
+    {
+      auto it = _heapOf.find( citem_r.satSolvable() );
+      if ( it == _heapOf.end() || it->second <= _currentHeap )
+        return;
+
+      // 1st package of a new heap: the packages of the current heap are done.
+      _currentHeap = it->second;
+      if ( _nextHeap != _currentHeap )
+        _cancelNext = true;	// heaps were skipped
+      finishNextHeap();
+
+      // Drops the staged files of the done heap.
+      if ( _nextHeap == _currentHeap )
+        _prefetcher = std::move(_nextPrefetcher);
+      else
+        _prefetcher.reset();
+      _nextPrefetcher.reset();
+
+      startHeap( _currentHeap + 1 );
+      if ( _prefetcher )
+        checkStagedSignatures( *_prefetcher );	// while the next heap downloads
+    }
+
+    void CommitPackageCache::Impl::startHeap( unsigned heap_r )
+    {
+      if ( heap_r >= _heaps.size() )
+        return;
+
+      _nextHeap = heap_r;
+      _nextPrefetcher.reset( new CommitPackagePrefetcher );
+      for ( const PoolItem & pi : _heaps[heap_r] )
+        _nextPrefetcher->add( pi );
+      MIL << "Heap " << heap_r << ": " << *_nextPrefetcher << endl;
+
+      // CommitPackagePrefetcher::run does not touch the pool, so it can run in the background.
+      _cancelNext = false;
+      _nextDone = std::async( std::launch::async, [this,&prefetcher=*_nextPrefetcher]() {
+        return prefetcher.run( [this]( const ProgressData & ) { return ! _cancelNext; } );
+      });
+    }
+
+    void CommitPackageCache::Impl::finishNextHeap()
+    {
+      if ( ! _nextDone.valid() )
+        return;
+
+      // Failed downloads are retried by get, when the package is needed.
+      try
+      {
+        _nextDone.get();
+      }
+      catch ( const Exception & excpt )
+      {
+        ZYPP_CAUGHT( excpt );
+        WAR << "Background download of heap " << _nextHeap << " stopped: " << excpt.asUserString() << endl;
+      }
+      catch ( const std::exception & excpt )
+      {
+        WAR << "Background download of heap " << _nextHeap << " failed: " << excpt.what() << endl;
+      }
+    }
 
     /////////////////////////////////////////////////////////////////
   } // namespace target
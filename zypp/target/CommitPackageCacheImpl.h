@@ -13,12 +13,20 @@
 #define ZYPP_TARGET_COMMITPACKAGECACHEIMPL_H
 
 #include <iosfwd>
+#include <atomic>
+#include <future>
+#include <memory>
+#include <unordered_map>
 #include <utility>
+#include <vector>
 
 #include <zypp/base/Logger.h>
 #include <zypp/base/Exception.h>
+#include <zypp/Arch.h>
+#include <zypp/Edition.h>
 
 #include <zypp/target/CommitPackageCache.h>
+#include <zypp/target/CommitPackagePrefetcher.h>
 
 ///////////////////////////////////////////////////////////////////
 namespace zypp
@@ -27,6 +35,28 @@ namespace zypp
   namespace target
   { /////////////////////////////////////////////////////////////////
 
+    ///////////////////////////////////////////////////////////////////
+    /// \class QueryInstalledEditionHelper
+    /// \short Helper for PackageProvider queries during download.
+    /// Queries the exact version of a currently installed package
+    /// in context(/) which may then be used by \ref applydeltarpm
+    /// to build a final rpm.
+    ///////////////////////////////////////////////////////////////////
+    struct QueryInstalledEditionHelper
+    {
+      bool operator()( const std::string & name_r, const Edition & ed_r, const Arch & arch_r ) const;
+    };
+
+    /** Split the packages to install in \a commitList_r into heaps of about \a maxSize_r download size.
+     *
+     * The heaps follow the order of \a commitList_r. A heap is only closed where
+     * the requirements of all packages installed so far are met, so a heap may
+     * grow beyond \a maxSize_r to include a whole dependency cycle. A package
+     * larger than \a maxSize_r gets a heap of its own.
+     * \see \ref CommitPackageCache::downloadInHeaps
+     */
+    std::vector<std::vector<PoolItem>> computeHeaps( const std::vector<sat::Solvable> & commitList_r, ByteCount maxSize_r );
+
     ///////////////////////////////////////////////////////////////////
     //
     //	CLASS NAME : CommitPackageCache::Impl
@@ -47,8 +77,7 @@ namespace zypp
       : _packageProvider(std::move( packageProvider_r ))
       {}
 
-      virtual ~Impl()
-      {}
+      virtual ~Impl();
 
     public:
       /** Provide the package.
@@ -71,6 +100,17 @@ namespace zypp
       void preloaded( bool newval_r )
       { _preloaded = newval_r; }
 
+      /** Download the packages to install in advance. */
+      void prefetch( const ProgressData::ReceiverFnc & progress_r );
+
+      /** Download the packages to install heap by heap. */
+      void downloadInHeaps( ByteCount maxHeapSize_r, const ProgressData::ReceiverFnc & progress_r );
+
+      /** Called by \ref CommitPackageCache::get before \ref get.
+       * Advances to the heap of \a citem_r, if it starts a new one.
+       */
+      void enterHeapOf( const PoolItem & citem_r );
+
     protected:
       /** Let the Source provide the package. */
       virtual ManagedFile sourceProvidePackage( const PoolItem & pi ) const
@@ -100,10 +140,25 @@ namespace zypp
         return _packageProvider( pi, /*cached only*/true );
       }
 
+    private:
+      /** Start downloading heap \a heap_r in the background. */
+      void startHeap( unsigned heap_r );
+      /** Wait until the background download is done. */
+      void finishNextHeap();
+
     private:
       std::vector<sat::Solvable> _commitList;
       PackageProvider _packageProvider;
       DefaultIntegral<bool,false> _preloaded;
+      std::unique_ptr<CommitPackagePrefetcher> _prefetcher;	///< keeps the staged files until the commit (or the current heap) is done
+
+      std::vector<std::vector<PoolItem>> _heaps;		///< DownloadInHeaps: the packages to download per heap
+      std::unordered_map<sat::Solvable,unsigned> _heapOf;	///< DownloadInHeaps: the heap a package belongs to
+      unsigned _currentHeap = 0;
+      unsigned _nextHeap = 0;
+      std::unique_ptr<CommitPackagePrefetcher> _nextPrefetcher;	///< the heap downloaded in the background
+      std::future<unsigned> _nextDone;
+      std::atomic<bool> _cancelNext { false };
     };
     ///////////////////////////////////////////////////////////////////
 
@@ -0,0 +1,521 @@
+/*---------------------------------------------------------------------\
+|                          ____ _   __ __ ___                          |
+|                         |__  / \ / / . \ . \                         |
+|                           / / \ V /|  _/  _/                         |
+|                          / /__ | | | | | |                           |
+|                         /_____||_| |_| |_|                           |
+|                                                                      |
+\---------------------------------------------------------------------*/
+/** \file	zypp/target/CommitPackagePrefetcher.cc
+ *
+*/
+#include <iostream>
+#include <algorithm>
+#include <functional>
+#include <chrono>
+#include <list>
+#include <map>
+#include <thread>
+
+#include <signal.h>
+#include <unistd.h>
+
+#include <zypp/base/Logger.h>
+#include <zypp/base/String.h>
+#include <zypp/base/Gettext.h>
+#include <zypp-core/base/UserRequestException>
+#include <zypp-core/zyppng/base/EventLoop>
+#include <zypp-core/zyppng/io/Process>
+
+#include <zypp-curl/ng/network/Downloader>
+#include <zypp-curl/ng/network/DownloadSpec>
+#include <zypp-curl/ng/network/NetworkRequestDispatcher>
+#include <zypp-curl/auth/CurlAuthData>
+#include <zypp-media/auth/CredentialManager>
+
+#include <zypp/target/CommitPackagePrefetcher.h>
+#include <zypp/target/CommitPackageCacheImpl.h>
+#include <zypp/repo/RepoProvideFile.h>
+#include <zypp/repo/DeltaCandidates.h>
+#include <zypp/repo/Applydeltarpm.h>
+#include <zypp/repo/PackageDelta.h>
+#include <zypp/Package.h>
+#include <zypp/PathInfo.h>
+#include <zypp/ResPool.h>
+#include <zypp/ZConfig.h>
+
+using std::endl;
+
+///////////////////////////////////////////////////////////////////
+namespace zypp
+{
+  ///////////////////////////////////////////////////////////////////
+  namespace target
+  {
+    ///////////////////////////////////////////////////////////////////
+    namespace
+    {
+      /** The 1st delta rpm \ref RepoProvidePackage could build \a pkg_r from.
+       * Same conditions as in \ref RpmPackageProvider::tryDelta, except for the
+       * full \c applydeltarpm check, which is left to \c applydeltarpm itself.
+       */
+      std::optional<packagedelta::DeltaRpm> usableDeltaRpm( const Package::constPtr & pkg_r )
+      {
+        if ( ! ZConfig::instance().download_use_deltarpm() || ! applydeltarpm::haveApplydeltarpm() )
+          return std::nullopt;
+
+        const ResPool & pool( ResPool::instance() );
+        repo::DeltaCandidates deltas( std::list<Repository>( pool.knownRepositoriesBegin(), pool.knownRepositoriesEnd() ), pkg_r->name() );
+        std::list<packagedelta::DeltaRpm> deltaRpms { deltas.deltaRpms( pkg_r ) };
+        const QueryInstalledEditionHelper installedInSystem;
+        if ( deltaRpms.empty() || ! installedInSystem( pkg_r->name(), Edition::noedition, pkg_r->arch() ) )
+          return std::nullopt;
+
+        for ( const packagedelta::DeltaRpm & delta : deltaRpms )
+        {
+          const RepoInfo & info { delta.repository().info() };
+          if ( info.baseUrlsEmpty() || ! info.url().schemeIsDownloading() )
+            continue;
+          if ( delta.location().checksum().empty() )
+            continue;	// applydeltarpm runs as root, it gets verified input only
+          if ( delta.baseversion().edition() != Edition::noedition
+            && ! installedInSystem( pkg_r->name(), delta.baseversion().edition(), pkg_r->arch() ) )
+            continue;
+          if ( ! applydeltarpm::quickcheck( delta.baseversion().sequenceinfo() ) )
+            continue;
+          return delta;
+        }
+        return std::nullopt;
+      }
+
+      /** Url of \a file_r in \a info_r. */
+      Url urlOf( const RepoInfo & info_r, const Pathname & file_r )
+      {
+        Url url { info_r.url() };
+        url.setPathName( ( Pathname( url.getPathName() ) / info_r.path() / file_r ).asString() );
+        return url;
+      }
+    } // namespace
+    ///////////////////////////////////////////////////////////////////
+
+    CommitPackagePrefetcher::CommitPackagePrefetcher( unsigned maxParallel_r, unsigned maxPerRepo_r )
+    : _maxParallel( std::max( maxParallel_r, 1U ) )
+    , _maxPerRepo( std::max( maxPerRepo_r, 1U ) )
+    {}
+
+    CommitPackagePrefetcher::CommitPackagePrefetcher()
+    : CommitPackagePrefetcher( ZConfig::instance().download_max_parallel_packages(),
+                               ZConfig::instance().download_max_parallel_packages_per_repo() )
+    {}
+
+    CommitPackagePrefetcher::~CommitPackagePrefetcher()
+    {
+      // Remove our own files only, another prefetcher may share the staging area.
+      for ( const Pathname & target : _targets )
+        filesystem::unlink( target );
+
+      for ( const Pathname & dir : _stagingDirs )
+      {
+        for ( const Pathname & target : _targets )
+        {
+          if ( ! str::hasPrefix( target.asString(), dir.asString() + "/" ) )
+            continue;
+          // Remove the directories which became empty (rmdir fails on the others).
+          for ( Pathname sub { target.dirname() }; sub != dir && ::rmdir( sub.c_str() ) == 0; sub = sub.dirname() )
+          {}
+        }
+        if ( ::rmdir( dir.c_str() ) == 0 )
+          MIL << "Removed prefetch staging area " << dir << endl;
+      }
+    }
+
+    bool CommitPackagePrefetcher::add( const PoolItem & pi_r )
+    {
+      Package::constPtr pkg { pi_r->asKind<Package>() };
+      if ( ! pkg )
+        return false;
+
+      const RepoInfo & info { pkg->repoInfo() };
+      const OnMediaLocation & loc { pkg->location() };
+      if ( info.baseUrlsEmpty() || ! info.url().schemeIsDownloading() || pkg->mediaNr() > 1 || loc.checksum().empty() )
+        return false;	// no network download or no way to verify a staged file
+
+      if ( pkg->isCached() )
+        return false;
+
+      const Pathname stagingDir { repo::RepoMediaAccess::stagingPath( info ) };
+      if ( ! _stagingDirs.count( stagingDir ) )
+      {
+        if ( filesystem::assert_dir( stagingDir ) != 0 || ! PathInfo( stagingDir ).userMayRWX() )
+        {
+          WAR << "Can't use prefetch staging area " << stagingDir << endl;
+          return false;
+        }
+        _stagingDirs.insert( stagingDir );
+      }
+
+      // The staged file must be found like RepoMediaAccess finds its cached files.
+      const Pathname file { info.path() / loc.filename() };
+      if ( ! _targets.insert( stagingDir / file ).second )
+        return true;	// queued already
+
+      Job job;
+      job._repoAlias    = info.alias();
+      job._url          = urlOf( info, loc.filename() );
+      job._target       = stagingDir / file;
+      job._downloadSize = loc.downloadSize();
+      job._checksum     = loc.checksum();
+      job._pkgGpgCheck  = info.pkgGpgCheck();
+
+      if ( auto delta = usableDeltaRpm( pkg ) )
+      {
+        const OnMediaLocation & dloc { delta->location() };
+        job._delta = Delta{ urlOf( delta->repository().info(), dloc.filename() ),
+                            stagingDir / ".delta" / dloc.filename().basename(),
+                            dloc.downloadSize(),
+                            dloc.checksum() };
+        _targets.insert( job._delta->_target );
+      }
+      _downloadSize += job._downloadSize;
+      _jobs.push_back( std::move(job) );
+      return true;
+    }
+
+    unsigned CommitPackagePrefetcher::run( const ProgressData::ReceiverFnc & progress_r )
+    {
+      using Clock = std::chrono::steady_clock;
+
+      // per repo queues of jobs to start
+      std::map<std::string, std::vector<Job*>> queues;
+      std::map<std::string, unsigned> runningPerRepo;
+      ByteCount::SizeType total = 0;
+      _peakParallel = _peakPerRepo = 0;
+      for ( Job & job : _jobs )
+      {
+        if ( job._done )
+          continue;
+        queues[job._repoAlias].push_back( &job );
+        total += job._downloadSize;
+      }
+      if ( queues.empty() )
+        return 0;
+      for ( auto & q : queues )	// we take from the back
+        std::reverse( q.second.begin(), q.second.end() );
+
+      DeltaCostModel costs;
+      costs._maxApply = std::max( std::thread::hardware_concurrency() / 2, 1U );
+
+      MIL << "Prefetching " << ByteCount(total) << " from " << queues.size() << " repos (" << _maxParallel << " parallel, " << _maxPerRepo << " per repo)" << endl;
+
+      auto ev = zyppng::EventLoop::create();
+      auto downloader = std::make_shared<zyppng::Downloader>();
+      downloader->requestDispatcher()->setMaximumConcurrentConnections( std::max<long>( _maxParallel, ZConfig::instance().download_max_concurrent_connections() ) );
+
+      media::CredManagerOptions credOptions( ZConfig::instance().repoManagerRoot() );
+
+      ProgressData progress( total );
+      progress.name( _("Downloading packages") );
+      progress.sendTo( progress_r );
+
+      struct Running
+      {
+        Job * _job = nullptr;
+        bool _isDelta = false;
+        zyppng::DownloadRef _dl;
+        ByteCount::SizeType _now = 0;	// in bytes of the full package
+        std::vector<zyppng::connection> _conns;
+      };
+      struct Applying
+      {
+        Job * _job = nullptr;
+        zyppng::ProcessRef _proc;
+        Clock::time_point _start;
+        std::vector<zyppng::connection> _conns;
+      };
+      std::list<Running> running;
+      std::list<Applying> applying;
+      std::vector<Job*> applyQueue;
+      std::vector<zyppng::DownloadRef> finished;	// released after the loop, not inside their own signals
+      std::vector<zyppng::ProcessRef> finishedProcs;
+      ByteCount::SizeType finishedBytes = 0;
+      ByteCount::SizeType downloadedBytes = 0;		// to measure the download rate
+      std::optional<Clock::time_point> downloadStart;
+      unsigned succeeded = 0;
+      bool aborted = false;
+
+      auto reportProgress = [&]() {
+        if ( aborted )
+          return;
+        ByteCount::SizeType now = finishedBytes;
+        for ( const Running & r : running )
+          now += r._now;
+        if ( ! progress.set( std::min( now, total ) ) )
+        {
+          WAR << "Prefetch aborted by the user" << endl;
+          aborted = true;
+          std::vector<zyppng::DownloadRef> toCancel;
+          for ( const Running & r : running )
+            toCancel.push_back( r._dl );
+          for ( const auto & dl : toCancel )
+            dl->cancel();
+          std::vector<zyppng::ProcessRef> toStop;
+          for ( const Applying & a : applying )
+            toStop.push_back( a._proc );
+          for ( const auto & proc : toStop )
+            proc->stop( SIGKILL );
+        }
+      };
+
+      auto jobDone = [&]( Job & job_r, bool success_r ) {
+        job_r._done = true;
+        finishedBytes += job_r._downloadSize;
+        if ( success_r )
+        {
+          DBG << "Prefetched " << job_r._target << endl;
+          ++succeeded;
+        }
+        else
+          filesystem::unlink( job_r._target );
+      };
+
+      // A failed delta: download the full package instead.
+      auto dropDelta = [&]( Job & job_r ) {
+        filesystem::unlink( job_r._delta->_target );
+        filesystem::unlink( job_r._target );
+        job_r._delta.reset();
+        queues[job_r._repoAlias].push_back( &job_r );
+      };
+
+      std::function<void()> startNext;
+
+      auto onFinished = [&]( std::list<Running>::iterator it_r ) {
+        Running & r { *it_r };
+        Job & job { *r._job };
+        --runningPerRepo[job._repoAlias];
+
+        if ( r._dl->hasError() )
+        {
+          WAR << "Prefetch failed: " << ( r._isDelta ? job._delta->_url : job._url ) << ": " << r._dl->errorString() << endl;
+          if ( r._isDelta && ! aborted )
+            dropDelta( job );
+          else
+            jobDone( job, false );
+        }
+        else
+        {
+          downloadedBytes += ( r._isDelta ? job._delta->_downloadSize : job._downloadSize );
+          if ( downloadStart && downloadedBytes > 1024 * 1024 )
+            costs._downloadRate = downloadedBytes / std::chrono::duration<double>( Clock::now() - *downloadStart ).count();
+
+          if ( r._isDelta )
+          {
+            applyQueue.push_back( &job );	// the full package size is accounted when it is built
+            costs._pendingApply += job._downloadSize;
+          }
+          else
+            jobDone( job, true );
+        }
+
+        for ( auto & conn : r._conns )
+          conn.disconnect();
+        finished.push_back( std::move(r._dl) );
+        running.erase( it_r );
+
+        reportProgress();
+        startNext();
+      };
+
+      auto onApplied = [&]( std::list<Applying>::iterator it_r, int exitCode_r ) {
+        Applying & a { *it_r };
+        Job & job { *a._job };
+        costs._pendingApply -= std::min<ByteCount::SizeType>( costs._pendingApply, job._downloadSize );
+
+        while ( a._proc->canReadLine() )
+          DBG << "Applydeltarpm : " << a._proc->readLine().asStringView();
+
+        if ( exitCode_r != 0 )
+        {
+          WAR << "applydeltarpm failed (" << exitCode_r << "): " << job._delta->_target << endl;
+          if ( ! aborted )
+            dropDelta( job );
+          else
+            jobDone( job, false );
+        }
+        else
+        {
+          const double secs = std::chrono::duration<double>( Clock::now() - a._start ).count();
+          if ( secs > 0 )
+            costs._applyRate = ( costs._applyRate + job._downloadSize / secs ) / 2;
+          filesystem::unlink( job._delta->_target );
+          jobDone( job, true );
+        }
+
+        for ( auto & conn : a._conns )
+          conn.disconnect();
+        finishedProcs.push_back( std::move(a._proc) );
+        applying.erase( it_r );
+
+        reportProgress();
+        startNext();
+      };
+
+      auto startDownload = [&]( Job & job_r, bool isDelta_r ) {
+        const Url & url { isDelta_r ? job_r._delta->_url : job_r._url };
+        const Pathname & target { isDelta_r ? job_r._delta->_target : job_r._target };
+        const ByteCount & size { isDelta_r ? job_r._delta->_downloadSize : job_r._downloadSize };
+
+        auto it = running.insert( running.end(), Running() );
+        it->_job = &job_r;
+        it->_isDelta = isDelta_r;
+        // A corrupt package is dropped right away instead of being found by the cache lookup.
+        // A delta not matching its checksum fails here and is never passed to applydeltarpm.
+        it->_dl  = downloader->downloadFile( zyppng::DownloadSpec( url, target, size ).setExpectedFileChecksum( isDelta_r ? job_r._delta->_checksum : job_r._checksum ) );
+        it->_conns = {
+          it->_dl->connectFunc( &zyppng::Download::sigFinished, [&onFinished,it]( zyppng::Download & ) {
+            onFinished( it );
+          }),
+          it->_dl->connectFunc( &zyppng::Download::sigProgress, [&reportProgress,it]( zyppng::Download &, off_t dltotal, off_t dlnow ) {
+            // a delta counts as the full package
+            if ( it->_isDelta && dltotal > 0 )
+              dlnow = dlnow * double( it->_job->_downloadSize ) / dltotal;
+            it->_now = dlnow;
+            reportProgress();
+          }),
+          it->_dl->connectFunc( &zyppng::Download::sigAuthRequired, [&credOptions,url]( zyppng::Download &, zyppng::NetworkAuthData & auth_r, const std::string & ) {
+            // Use stored credentials only. Asking the user is left to the regular download.
+            media::CredentialManager cm( credOptions );
+            media::AuthData_Ptr cmcred { cm.getCred( url ) };
+            if ( cmcred && auth_r.lastDatabaseUpdate() < cmcred->lastDatabaseUpdate() )
+              auth_r = media::CurlAuthData( *cmcred );
+            else
+              auth_r = zyppng::NetworkAuthData();
+          })
+        };
+        _peakPerRepo = std::max( _peakPerRepo, ++runningPerRepo[job_r._repoAlias] );
+        _peakParallel = std::max<unsigned>( _peakParallel, running.size() );
+        if ( ! downloadStart )
+          downloadStart = Clock::now();
+        it->_dl->start();
+      };
+
+      auto startApply = [&]( Job & job_r ) {
+        const std::string delta { job_r._delta->_target.asString() };
+        const std::string target { job_r._target.asString() };
+        const char *const argv[] = {
+          "/usr/bin/applydeltarpm",
+          delta.c_str(),
+          target.c_str(),
+          nullptr
+        };
+
+        auto it = applying.insert( applying.end(), Applying() );
+        it->_job = &job_r;
+        it->_start = Clock::now();
+        it->_proc = zyppng::Process::create();
+        it->_proc->setOutputChannelMode( zyppng::Process::Merged );
+        it->_conns = {
+          it->_proc->connectFunc( &zyppng::Process::sigReadyRead, [it]() {
+            while ( it->_proc->canReadLine() )
+              DBG << "Applydeltarpm : " << it->_proc->readLine().asStringView();
+          }),
+          it->_proc->connectFunc( &zyppng::Process::sigFinished, [&onApplied,it]( int code_r ) {
+            onApplied( it, code_r );
+          })
+        };
+        if ( ! it->_proc->start( argv ) )
+        {
+          WAR << "Can't run applydeltarpm: " << it->_proc->execError() << endl;
+          for ( auto & conn : it->_conns )
+            conn.disconnect();
+          costs._pendingApply -= std::min<ByteCount::SizeType>( costs._pendingApply, job_r._downloadSize );
+          applying.erase( it );
+          dropDelta( job_r );
+          return false;
+        }
+        return true;
+      };
+
+      startNext = [&]() {
+        if ( ! aborted )
+        {
+          // rebuild packages from the downloaded deltas
+          while ( ! applyQueue.empty() && applying.size() < costs._maxApply )
+          {
+            Job & job { *applyQueue.front() };
+            applyQueue.erase( applyQueue.begin() );
+            startApply( job );
+          }
+
+          // round robin over the repos until all slots are used
+          bool started = true;
+          while ( started && running.size() < _maxParallel )
+          {
+            started = false;
+            for ( auto & [ alias, queue ] : queues )
+            {
+              if ( queue.empty() || runningPerRepo[alias] >= _maxPerRepo || running.size() >= _maxParallel )
+                continue;
+
+              Job & job { *queue.back() };
+              queue.pop_back();
+
+              bool useDelta = false;
+              if ( job._delta )
+              {
+                useDelta = costs.preferDelta( job._downloadSize, job._delta->_downloadSize );
+                DBG << ( useDelta ? "Use " : "Skip " ) << job._delta->_url << " (" << ByteCount(costs._downloadRate) << "/s download, "
+                    << ByteCount(costs._applyRate) << "/s rebuild, " << ByteCount(costs._pendingApply) << " pending)" << endl;
+                if ( ! useDelta )
+                  job._delta.reset();
+              }
+
+              const Pathname & target { useDelta ? job._delta->_target : job._target };
+              if ( filesystem::assert_dir( target.dirname() ) != 0 )
+              {
+                WAR << "Prefetch failed: can't create " << target.dirname() << endl;
+                jobDone( job, false );
+                continue;
+              }
+
+              startDownload( job, useDelta );
+              started = true;
+            }
+          }
+        }
+
+        if ( running.empty() && applying.empty() )
+          ev->quit();
+      };
+
+      startNext();
+      if ( ! running.empty() || ! applying.empty() )
+        ev->run();
+
+      MIL << "Prefetched " << succeeded << " packages (" << _peakParallel << " parallel, " << _peakPerRepo << " per repo at most)" << endl;
+      if ( aborted )
+        ZYPP_THROW( AbortRequestException( "Prefetch aborted by the user" ) );
+
+      progress.toMax();
+      return succeeded;
+    }
+
+    std::vector<Pathname> CommitPackagePrefetcher::stagedFilesToCheck() const
+    {
+      std::vector<Pathname> ret;
+      for ( const Job & job : _jobs )
+      {
+        if ( job._done && job._pkgGpgCheck && PathInfo( job._target ).isFile() )
+          ret.push_back( job._target );
+      }
+      return ret;
+    }
+
+    std::ostream & operator<<( std::ostream & str, const CommitPackagePrefetcher & obj )
+    {
+      return str << "CommitPackagePrefetcher[" << obj.size() << " packages, " << obj.downloadSize() << "]";
+    }
+
+  } // namespace target
+  ///////////////////////////////////////////////////////////////////
+} // namespace zypp
+///////////////////////////////////////////////////////////////////
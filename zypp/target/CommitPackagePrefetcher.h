@@ -0,0 +1,170 @@
+/*---------------------------------------------------------------------\
+|                          ____ _   __ __ ___                          |
+|                         |__  / \ / / . \ . \                         |
+|                           / / \ V /|  _/  _/                         |
+|                          / /__ | | | | | |                           |
+|                         /_____||_| |_| |_|                           |
+|                                                                      |
+\---------------------------------------------------------------------*/
+/** \file	zypp/target/CommitPackagePrefetcher.h
+ *
+*/
+#ifndef ZYPP_TARGET_COMMITPACKAGEPREFETCHER_H
+#define ZYPP_TARGET_COMMITPACKAGEPREFETCHER_H
+
+#include <iosfwd>
+#include <optional>
+#include <set>
+#include <vector>
+
+#include <zypp/base/NonCopyable.h>
+#include <zypp/ByteCount.h>
+#include <zypp/CheckSum.h>
+#include <zypp/PoolItem.h>
+#include <zypp/ProgressData.h>
+#include <zypp/Url.h>
+
+///////////////////////////////////////////////////////////////////
+namespace zypp
+{
+  ///////////////////////////////////////////////////////////////////
+  namespace target
+  {
+    ///////////////////////////////////////////////////////////////////
+    /// \class CommitPackagePrefetcher
+    /// \brief Download packages in advance, several of them at once.
+    ///
+    /// The packages are downloaded by the zyppng \ref zyppng::Downloader into
+    /// the \ref repo::RepoMediaAccess::stagingPath of their repository. When
+    /// the \ref CommitPackageCache provides a package, it is taken from there
+    /// (by checksum) and signature checked as if it was downloaded just now.
+    ///
+    /// A package which can not be prefetched is simply left out. It is then
+    /// downloaded (and any problem reported) the usual way.
+    ///
+    /// Only packages from downloading repos are prefetched. Packages which
+    /// are cached already are skipped.
+    ///
+    /// If a package may be built from a delta rpm (\ref ZConfig::download_use_deltarpm),
+    /// a simple cost model decides when the package is started, whether to download
+    /// the delta and run \c applydeltarpm, or to download the full package. It compares
+    /// the measured download rate with the measured rebuild rate of \c applydeltarpm,
+    /// taking the rebuilds already queued into account. Up to half as many \c applydeltarpm
+    /// as CPUs run at once. If the rebuild fails, the full package is downloaded.
+    ///
+    /// The staged files are removed when the prefetcher is destroyed.
+    ///////////////////////////////////////////////////////////////////
+    class CommitPackagePrefetcher : private base::NonCopyable
+    {
+      friend std::ostream & operator<<( std::ostream & str, const CommitPackagePrefetcher & obj );
+
+    public:
+      /** Download up to \a maxParallel_r packages at once, but no more than \a maxPerRepo_r from the same repo. */
+      CommitPackagePrefetcher( unsigned maxParallel_r, unsigned maxPerRepo_r );
+
+      /** Ctor using the limits from \ref ZConfig. */
+      CommitPackagePrefetcher();
+
+      /** Dtor removing the staged files. */
+      ~CommitPackagePrefetcher();
+
+    public:
+      /** Queue \a pi_r for download, unless it does not need or qualify for a prefetch.
+       * \return Whether \a pi_r was queued (now or before).
+       */
+      bool add( const PoolItem & pi_r );
+
+      /** Number of queued packages. */
+      unsigned size() const
+      { return _jobs.size(); }
+
+      /** Total download size of the queued packages. */
+      ByteCount downloadSize() const
+      { return _downloadSize; }
+
+      /** Download the queued packages.
+       *
+       * Blocks until all downloads are finished. Each package is downloaded at most
+       * once, so \c run can be called again after \ref add ing more packages.
+       *
+       * The aggregated download progress (in bytes) is sent to \a progress_r.
+       * If the receiver returns \c false, the remaining downloads are cancelled
+       * and \ref AbortRequestException is thrown.
+       *
+       * Apart from this, \c run does not touch the pool or trigger any callbacks,
+       * so it may be executed in a different thread.
+       *
+       * \return The number of successfully downloaded packages.
+       */
+      unsigned run( const ProgressData::ReceiverFnc & progress_r = ProgressData::ReceiverFnc() );
+
+      /** The successfully downloaded packages whose signature is to be checked (\ref RepoInfo::pkgGpgCheck). */
+      std::vector<Pathname> stagedFilesToCheck() const;
+
+      /** Most downloads running at once during the last \ref run. */
+      unsigned peakParallel() const
+      { return _peakParallel; }
+
+      /** Most downloads running at once from the same repo during the last \ref run. */
+      unsigned peakPerRepo() const
+      { return _peakPerRepo; }
+
+    public:
+      /** A delta rpm to build a package from. */
+      struct Delta
+      {
+        Url         _url;
+        Pathname    _target;
+        ByteCount   _downloadSize;
+        CheckSum    _checksum;		///< verified while downloading
+      };
+
+      /** A package to download. */
+      struct Job
+      {
+        std::string _repoAlias;
+        Url         _url;
+        Pathname    _target;
+        ByteCount   _downloadSize;
+        CheckSum    _checksum;		///< verified while downloading
+        std::optional<Delta> _delta;
+        bool        _pkgGpgCheck = true;
+        bool        _done = false;
+      };
+
+      /** Whether building a package from a delta rpm is expected to be faster than downloading it. */
+      struct DeltaCostModel
+      {
+        double _downloadRate = 4.0 * 1024 * 1024;	///< bytes/s over all downloads (a guess until measured)
+        double _applyRate = 8.0 * 1024 * 1024;		///< rebuilt bytes/s of one applydeltarpm (a guess until measured)
+        unsigned _maxApply = 1;				///< applydeltarpm running at once
+        ByteCount::SizeType _pendingApply = 0;		///< bytes to rebuild by the queued and running applydeltarpm
+
+        /** Whether to use a delta of \a delta_r bytes to build a package of \a full_r bytes. */
+        bool preferDelta( ByteCount::SizeType full_r, ByteCount::SizeType delta_r ) const
+        {
+          double viaFull  = full_r / _downloadRate;
+          double viaDelta = delta_r / _downloadRate + ( _pendingApply + full_r ) / ( _applyRate * _maxApply );
+          return viaDelta < viaFull;
+        }
+      };
+
+    private:
+      unsigned _maxParallel;
+      unsigned _maxPerRepo;
+      std::vector<Job> _jobs;
+      std::set<Pathname> _targets;
+      ByteCount _downloadSize;
+      std::set<Pathname> _stagingDirs;
+      unsigned _peakParallel = 0;
+      unsigned _peakPerRepo = 0;
+    };
+
+    /** \relates CommitPackagePrefetcher Stream output */
+    std::ostream & operator<<( std::ostream & str, const CommitPackagePrefetcher & obj );
+
+  } // namespace target
+  ///////////////////////////////////////////////////////////////////
+} // namespace zypp
+///////////////////////////////////////////////////////////////////
+#endif // ZYPP_TARGET_COMMITPACKAGEPREFETCHER_H
@@ -97,6 +97,10 @@ using std::endl;
 extern "C"
 {
 #include <solv/repo_rpmdb.h>
+#include <solv/repo_solv.h>
+#include <solv/repo_write.h>
+#include <solv/repo_products.h>
+#include <solv/repo_autopattern.h>
 #include <solv/chksum.h>
 }
 namespace zypp
@@ -124,6 +128,105 @@ namespace zypp
     inline RepoStatus rpmDbRepoStatus( const Pathname & root_r )
     { return RepoStatus( rpmDbStateHash( root_r ), Date() ); }
 
+    bool patchSystemSolv( const Pathname & root_r, const Pathname & dbPath_r, const Pathname & oldsolv_r, const Pathname & newsolv_r, const std::set<std::string> & committedNames_r )
+    {
+      if ( committedNames_r.empty() )
+        return false;
+
+      AutoDispose<::Pool*> poolGuard { ::pool_create(), ::pool_free };
+      ::Pool * pool = poolGuard;
+      ::Repo * repo = ::repo_create( pool, sat::Pool::instance().systemRepoAlias().c_str() );
+      {
+        AutoFILE fp { ::fopen( oldsolv_r.c_str(), "re" ) };
+        if ( ! fp || ::repo_add_solv( repo, fp, 0 ) != 0 )
+        {
+          WAR << "Can't patch " << oldsolv_r << ": " << ::pool_errstr( pool ) << endl;
+          return false;
+        }
+      }
+
+      // The database rpmdb2solv reads when called with -D (see TargetImpl::buildCache).
+      OnScopeExit dbPathGuard { rpm::librpmDb::scopedDbPath( dbPath_r ) };
+      AutoDispose<void*> state { ::rpm_state_create( pool, root_r.c_str() ), ::rpm_state_free };
+      std::set<sat::detail::IdType> rpmdbids;
+      {
+        sat::Queue q;
+        ::rpm_installedrpmdbids( state, nullptr, nullptr, q );
+        rpmdbids.insert( q.begin(), q.end() );
+      }
+
+      // Drop removed headers and the pseudo packages (no rpmdbid) which are regenerated below.
+      std::set<sat::detail::IdType> known;
+      unsigned removed = 0;
+      for ( sat::detail::SolvableIdType p = repo->start; p < sat::detail::SolvableIdType(repo->end); ++p )
+      {
+        ::Solvable * s = pool->solvables + p;
+        if ( s->repo != repo )
+          continue;
+
+        sat::detail::IdType rpmdbid = repo->rpmdbid ? repo->rpmdbid[p - repo->start] : 0;
+        if ( rpmdbid )
+        {
+          if ( rpmdbids.count( rpmdbid ) )
+          {
+            known.insert( rpmdbid );
+            continue;
+          }
+          if ( ! committedNames_r.count( ::pool_id2str( pool, s->name ) ) )
+          {
+            MIL << "Removed header " << rpmdbid << " (" << ::pool_id2str( pool, s->name ) << ") is not part of the commit." << endl;
+            return false;
+          }
+          ++removed;
+        }
+        ::repo_free_solvable( repo, p, 1 );
+      }
+
+      // A solv file of an empty database has no rpmdbids.
+      if ( ! repo->rpmdbid )
+        repo->rpmdbid = static_cast<sat::detail::IdType *>( ::repo_sidedata_create( repo, sizeof(sat::detail::IdType) ) );
+
+      unsigned added = 0;
+      for ( sat::detail::IdType rpmdbid : rpmdbids )
+      {
+        if ( known.count( rpmdbid ) )
+          continue;
+
+        void * hdr = ::rpm_byrpmdbid( state, rpmdbid );
+        sat::detail::SolvableIdType p = hdr ? ::repo_add_rpm_handle( repo, hdr, REPO_REUSE_REPODATA|REPO_NO_INTERNALIZE|RPM_ADD_TRIGGERS ) : 0;
+        if ( ! p )
+        {
+          WAR << "Can't read header " << rpmdbid << ": " << ::pool_errstr( pool ) << endl;
+          return false;
+        }
+        if ( ! committedNames_r.count( ::pool_id2str( pool, pool->solvables[p].name ) ) )
+        {
+          MIL << "Added header " << rpmdbid << " (" << ::pool_id2str( pool, pool->solvables[p].name ) << ") is not part of the commit." << endl;
+          return false;
+        }
+        repo->rpmdbid = static_cast<sat::detail::IdType *>( ::repo_sidedata_extend( repo, repo->rpmdbid, sizeof(sat::detail::IdType), p, 1 ) );
+        repo->rpmdbid[p - repo->start] = rpmdbid;
+        ++added;
+      }
+
+      ::repo_add_products( repo, Pathname::assertprefix( root_r, "/etc/products.d" ).c_str(), REPO_REUSE_REPODATA|REPO_NO_INTERNALIZE );
+      ::repo_add_autopattern( repo, 0 );
+      ::repo_internalize( repo );
+
+      FILE * fp = ::fopen( newsolv_r.c_str(), "we" );
+      int ret = fp ? ::repo_write( repo, fp ) : -1;
+      if ( fp && ::fclose( fp ) != 0 )
+        ret = -1;
+      if ( ret != 0 )
+      {
+        WAR << "Can't write " << newsolv_r << ": " << ::pool_errstr( pool ) << endl;
+        return false;
+      }
+
+      MIL << "Patched " << oldsolv_r << ": " << removed << " headers removed, " << added << " headers added" << endl;
+      return true;
+    }
+
   } // namespace target
 } // namespace
 ///////////////////////////////////////////////////////////////////
@@ -1010,6 +1113,12 @@ namespace zypp
     }
 
     bool TargetImpl::buildCache()
+    { return doBuildCache( nullptr ); }
+
+    bool TargetImpl::buildCache( const ZYppCommitResult & commitResult_r )
+    { return doBuildCache( &commitResult_r ); }
+
+    bool TargetImpl::doBuildCache( const ZYppCommitResult * commitResult_r )
     {
       Pathname base = solvfilesPath();
       Pathname rpmsolv       = base/"solv";
@@ -1085,50 +1194,68 @@ namespace zypp
         // Take care we unlink the solvfile on exception
         ManagedFile guard( base, filesystem::recursive_rmdir );
 
-        ExternalProgram::Arguments cmd;
+        // After a commit try to patch the old solv file rather than rebuilding it from scratch.
+        bool patched = false;
+        if ( commitResult_r && ! oldSolvFile.empty() )
+        {
+          std::set<std::string> committedNames;
+          for ( const sat::Transaction::Step & step : commitResult_r->transactionStepList() )
+          {
+            if ( step.stepStage() == sat::Transaction::STEP_DONE )
+              committedNames.insert( step.ident().asString() );
+          }
+          patched = patchSystemSolv( _root, rpm().dbPath(), oldSolvFile, tmpsolv.path(), committedNames );
+          if ( ! patched )
+            MIL << "Can't patch the solv file, rebuilding it." << endl;
+        }
+
+        if ( ! patched )
+        {
+          ExternalProgram::Arguments cmd;
 #ifdef ZYPP_RPMDB2SOLV_PATH
-        cmd.push_back( ZYPP_RPMDB2SOLV_PATH );
+          cmd.push_back( ZYPP_RPMDB2SOLV_PATH );
 #else
-        cmd.push_back( "rpmdb2solv" );
+          cmd.push_back( "rpmdb2solv" );
 #endif
-        if ( ! _root.empty() ) {
-          cmd.push_back( "-r" );
-          cmd.push_back( _root.asString() );
-        }
-        cmd.push_back( "-D" );
-        cmd.push_back( rpm().dbPath().asString() );
-        cmd.push_back( "-X" );	// autogenerate pattern/product/... from -package
-        // bsc#1104415: no more application support // cmd.push_back( "-A" );	// autogenerate application pseudo packages
-        cmd.push_back( "-p" );
-        cmd.push_back( Pathname::assertprefix( _root, "/etc/products.d" ).asString() );
-
-        if ( ! oldSolvFile.empty() )
-          cmd.push_back( oldSolvFile.asString() );
-
-        cmd.push_back( "-o" );
-        cmd.push_back( tmpsolv.path().asString() );
-
-        ExternalProgram prog( cmd, ExternalProgram::Stderr_To_Stdout );
-        std::string errdetail;
-
-        for ( std::string output( prog.receiveLine() ); output.length(); output = prog.receiveLine() ) {
-          WAR << "  " << output;
-          if ( errdetail.empty() ) {
-            errdetail = prog.command();
-            errdetail += '\n';
+          if ( ! _root.empty() ) {
+            cmd.push_back( "-r" );
+            cmd.push_back( _root.asString() );
+          }
+          cmd.push_back( "-D" );
+          cmd.push_back( rpm().dbPath().asString() );
+          cmd.push_back( "-X" );	// autogenerate pattern/product/... from -package
+          // bsc#1104415: no more application support // cmd.push_back( "-A" );	// autogenerate application pseudo packages
+          cmd.push_back( "-p" );
+          cmd.push_back( Pathname::assertprefix( _root, "/etc/products.d" ).asString() );
+
+          if ( ! oldSolvFile.empty() )
+            cmd.push_back( oldSolvFile.asString() );
+
+          cmd.push_back( "-o" );
+          cmd.push_back( tmpsolv.path().asString() );
+
+          ExternalProgram prog( cmd, ExternalProgram::Stderr_To_Stdout );
+          std::string errdetail;
+
+          for ( std::string output( prog.receiveLine() ); output.length(); output = prog.receiveLine() ) {
+            WAR << "  " << output;
+            if ( errdetail.empty() ) {
+              errdetail = prog.command();
+              errdetail += '\n';
+            }
+            errdetail += output;
           }
-          errdetail += output;
-        }
 
-        int ret = prog.close();
-        if ( ret != 0 )
-        {
-          Exception ex(str::form("Failed to cache rpm database (%d).", ret));
-          ex.remember( errdetail );
-          ZYPP_THROW(ex);
+          int ret = prog.close();
+          if ( ret != 0 )
+          {
+            Exception ex(str::form("Failed to cache rpm database (%d).", ret));
+            ex.remember( errdetail );
+            ZYPP_THROW(ex);
+          }
         }
 
-        ret = filesystem::rename( tmpsolv, rpmsolv );
+        int ret = filesystem::rename( tmpsolv, rpmsolv );
         if ( ret != 0 )
           ZYPP_THROW(Exception("Failed to move cache to final destination"));
         // if this fails, don't bother throwing exceptions
@@ -1462,11 +1589,45 @@ namespace zypp
         packageCache.setCommitList( steps.begin(), steps.end() );
 
         bool miss = false;
-        if ( policy_r.downloadMode() != DownloadAsNeeded  )
+        if ( policy_r.downloadMode() == DownloadInHeaps
+          && ! policy_r.dryRun()
+          && ! policy_r.singleTransModeEnabled()	// zypp-rpm needs all packages at once
+          && ZConfig::instance().download_max_heap_size() > 0 )
+        {
+          // Download the 1st heap now. The following ones are downloaded in
+          // the background while the packages are installed.
+          try
+          {
+            callback::SendReport<ProgressReport> report;
+            packageCache.downloadInHeaps( ZConfig::instance().download_max_heap_size(), ProgressReportAdaptor( report ) );
+          }
+          catch ( const AbortRequestException & exp )
+          {
+            ZYPP_CAUGHT( exp );
+            WAR << "commit heap download aborted by the user" << endl;
+            ZYPP_THROW( TargetAbortedException( ) );
+          }
+        }
+        else if ( policy_r.downloadMode() != DownloadAsNeeded  )
         {
-          // Preload the cache. Until now this means pre-loading all packages.
-          // Once DownloadInHeaps is fully implemented, this will change and
-          // we may actually have more than one heap.
+          // Preload the cache. This means pre-loading all packages, also for
+          // DownloadInHeaps unless download.max_heap_size is set.
+          //
+          // The packages are downloaded several at once first. The loop below
+          // picks them up, signature checks them and provides (and reports)
+          // whatever failed to download.
+          try
+          {
+            callback::SendReport<ProgressReport> report;
+            packageCache.prefetch( ProgressReportAdaptor( report ) );
+          }
+          catch ( const AbortRequestException & exp )
+          {
+            ZYPP_CAUGHT( exp );
+            WAR << "commit cache prefetch aborted by the user" << endl;
+            ZYPP_THROW( TargetAbortedException( ) );
+          }
+
           for_( it, steps.begin(), steps.end() )
           {
             switch ( it->stepType() )
@@ -1585,7 +1746,7 @@ namespace zypp
       ///////////////////////////////////////////////////////////////////
       if ( ! policy_r.dryRun() )
       {
-        buildCache();
+        buildCache( result );
       }
 
       MIL << "TargetImpl::commit(<pool>, " << policy_r << ") returns: " << result << endl;
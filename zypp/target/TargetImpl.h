@@ -41,6 +41,19 @@ namespace zypp
     DEFINE_PTR_TYPE(TargetImpl);
     class CommitPackageCache;
 
+    /** Incrementally update the \c @System solv file after a commit.
+     *
+     * Loads \a oldsolv_r into a private pool, drops the solvables of rpm headers
+     * no longer in the database at \a root_r / \a dbPath_r, adds the headers not
+     * yet in the solv file and regenerates products and patterns (like
+     * <tt>rpmdb2solv -D dbPath_r -X -p</tt>). The result is written to \a newsolv_r.
+     *
+     * Every added or removed header must belong to a package named in
+     * \a committedNames_r. If not, the rpm database was changed in some other
+     * way and \c false is returned, so the caller can fall back to a full rebuild.
+     */
+    bool patchSystemSolv( const Pathname & root_r, const Pathname & dbPath_r, const Pathname & oldsolv_r, const Pathname & newsolv_r, const std::set<std::string> & committedNames_r );
+
     ///////////////////////////////////////////////////////////////////
     //
     //	CLASS NAME : TargetImpl
@@ -108,6 +121,11 @@ namespace zypp
       void clearCache();
 
       bool buildCache();
+
+      /** \overload After a commit try to patch the solv file incrementally,
+       * using the packages processed in \a commitResult_r.
+       */
+      bool buildCache( const ZYppCommitResult & commitResult_r );
       //@}
 
     public:
@@ -217,6 +235,9 @@ namespace zypp
 
       /** Commit helper checking for file conflicts after download. */
       void commitFindFileConflicts( const ZYppCommitPolicy & policy_r, ZYppCommitResult & result_r );
+
+      /** Build or (after a commit) patch the solv file. */
+      bool doBuildCache( const ZYppCommitResult * commitResult_r );
     protected:
       /** Path to the target */
       Pathname _root;
@@ -23,9 +23,14 @@ extern "C"
 #include <fstream>
 #include <sstream>
 #include <list>
+#include <deque>
 #include <map>
+#include <memory>
+#include <optional>
 #include <set>
 #include <string>
+#include <thread>
+#include <tuple>
 #include <utility>
 #include <vector>
 #include <algorithm>
@@ -548,6 +553,69 @@ namespace
     rpmKeys_r.swap( rpmKeys );
     zyppKeys_r.swap( zyppKeys );
   }
+
+  ///////////////////////////////////////////////////////////////////
+  /// \brief Results of \ref RpmDb::checkPackageSignatures
+  ///
+  /// A result is remembered for the checked file and is used once, by a
+  /// \ref RpmDb::checkPackageSignature of the same file or a hardlink to it.
+  /// It is valid only as long as the checked file still exists unchanged,
+  /// which also makes sure its inode was not reused by a different file.
+  /// All results are dropped if the rpm keyring changes.
+  ///////////////////////////////////////////////////////////////////
+  struct SigCheckCache
+  {
+    struct Entry
+    {
+      Pathname _path;	//< the file checked
+      off_t _size;
+      time_t _mtime;
+      RpmDb::CheckPackageResult _result;
+      RpmDb::CheckPackageDetail _detail;
+    };
+    using Key = std::tuple<std::string,dev_t,ino_t>;	//< root, file
+
+    static SigCheckCache & instance()
+    { static SigCheckCache _instance; return _instance; }
+
+    void remember( const Pathname & root_r, const Pathname & path_r, RpmDb::CheckPackageResult result_r, RpmDb::CheckPackageDetail detail_r )
+    {
+      PathInfo file( path_r );
+      if ( file.isFile() )
+        _entries[Key( root_r.asString(), file.dev(), file.ino() )] = Entry{ path_r, file.size(), file.mtime(), result_r, std::move(detail_r) };
+    }
+
+    /** Take the remembered result for \a path_r, if there is a valid one. */
+    std::optional<Entry> take( const Pathname & root_r, const Pathname & path_r )
+    {
+      if ( _entries.empty() )
+        return std::nullopt;
+
+      PathInfo file( path_r );
+      if ( ! file.isFile() )
+        return std::nullopt;
+
+      auto it = _entries.find( Key( root_r.asString(), file.dev(), file.ino() ) );
+      if ( it == _entries.end() )
+        return std::nullopt;
+
+      Entry entry { std::move(it->second) };
+      _entries.erase( it );
+
+      PathInfo checked( entry._path );
+      if ( ! checked.isFile() || checked.dev() != file.dev() || checked.ino() != file.ino()
+        || checked.size() != entry._size || checked.mtime() != entry._mtime )
+        return std::nullopt;	// stale
+      return entry;
+    }
+
+    void clear()
+    { _entries.clear(); }
+
+  private:
+    std::map<Key,Entry> _entries;
+  };
+
 } // namespace
 ///////////////////////////////////////////////////////////////////
 
@@ -667,6 +735,7 @@ void RpmDb::exportTrustedKeysInZyppKeyRing()
 void RpmDb::importPubkey( const PublicKey & pubkey_r )
 {
   FAILIFNOTINITIALIZED;
+  SigCheckCache::instance().clear();	// results depend on the keyring
 
   // bnc#828672: On the fly key import in READONLY
   if ( zypp_readonly_hack::IGotIt() )
@@ -780,6 +849,7 @@ void RpmDb::importPubkey( const PublicKey & pubkey_r )
 void RpmDb::removePubkey( const PublicKey & pubkey_r )
 {
   FAILIFNOTINITIALIZED;
+  SigCheckCache::instance().clear();	// results depend on the keyring
 
   // check if the key is in the rpm database and just
   // return if it does not.
@@ -1117,53 +1187,16 @@ namespace
     int _oldMask = 0;
   };
 
-  std::ostream & operator<<( std::ostream & str, const RpmlogCapture & obj )
-  {
-    char sep = '\0';
-    for ( const auto & l : obj ) {
-      if ( sep ) str << sep; else sep = '\n';
-      str << l;
-    }
-    return str;
-  }
-
 
-  RpmDb::CheckPackageResult doCheckPackageSig( const Pathname & path_r,			// rpm file to check
-                                               const Pathname & root_r,			// target root
-                                               bool  requireGPGSig_r,			// whether no gpg signature is to be reported
-                                               RpmDb::CheckPackageDetail & detail_r )	// detailed result
+  /** Combine the result lines of a signature check into the \ref RpmDb::CheckPackageResult.
+   * \a lines_r are the lines rpm printed when checking \a path_r, \a res_r is its return value.
+   */
+  RpmDb::CheckPackageResult evaluateSigCheck( const Pathname & path_r,			// rpm file checked
+                                              bool  requireGPGSig_r,			// whether no gpg signature is to be reported
+                                              int res_r,				// rpm result
+                                              const std::vector<std::string> & lines_r,	// rpm output
+                                              RpmDb::CheckPackageDetail & detail_r )	// detailed result
   {
-    PathInfo file( path_r );
-    if ( ! file.isFile() )
-    {
-      ERR << "Not a file: " << file << endl;
-      return RpmDb::CHK_ERROR;
-    }
-
-    FD_t fd = ::Fopen( file.asString().c_str(), "r.ufdio" );
-    if ( fd == 0 || ::Ferror(fd) )
-    {
-      ERR << "Can't open file for reading: " << file << " (" << ::Fstrerror(fd) << ")" << endl;
-      if ( fd )
-        ::Fclose( fd );
-      return RpmDb::CHK_ERROR;
-    }
-    rpmts ts = ::rpmtsCreate();
-    ::rpmtsSetRootDir( ts, root_r.c_str() );
-    ::rpmtsSetVSFlags( ts, RPMVSF_DEFAULT );
-#ifdef HAVE_RPM_VERIFY_TRANSACTION_STEP
-    ::rpmtsSetVfyFlags( ts, RPMVSF_DEFAULT );
-#endif
-
-    RpmlogCapture vresult;
-    LocaleGuard guard( LC_ALL, "C" );	// bsc#1076415: rpm log output is localized, but we need to parse it :(
-    static rpmQVKArguments_s qva = ([](){ rpmQVKArguments_s qva; memset( &qva, 0, sizeof(rpmQVKArguments_s) ); return qva; })();
-    int res = ::rpmVerifySignatures( &qva, ts, fd, path_r.basename().c_str() );
-    guard.restore();
-
-    ts = rpmtsFree(ts);
-    ::Fclose( fd );
-
     // Check the individual signature/disgest results:
 
     // To.map back known result strings to enum, everything else is CHK_ERROR.
@@ -1197,7 +1230,7 @@ namespace
 
     static const str::regex rx( "^ *(Header|Payload)? .*(Signature, key|digest).*: ([A-Z]+)" );
     str::smatch what;
-    for ( const std::string & line : vresult )
+    for ( const std::string & line : lines_r )
     {
       if ( line[0] != ' ' ) // result lines are indented
         continue;
@@ -1225,7 +1258,7 @@ namespace
     }
 
     // Now combine the overall result:
-    RpmDb::CheckPackageResult ret = ( res ? RpmDb::CHK_ERROR : RpmDb::CHK_OK );
+    RpmDb::CheckPackageResult ret = ( res_r ? RpmDb::CHK_ERROR : RpmDb::CHK_OK );
 
     if ( count[RpmDb::CHK_FAIL] )
       ret = RpmDb::CHK_FAIL;
@@ -1314,13 +1347,52 @@ namespace
       }
 
       WAR << path_r << " (" << requireGPGSig_r << " -> " << ret << ")" << endl;
-      WAR << vresult << endl;
+      WAR << str::join( lines_r, "\n" ) << endl;
     }
     else
       DBG << path_r << " [0-Signature is OK]" << endl;
     return ret;
   }
 
+  RpmDb::CheckPackageResult doCheckPackageSig( const Pathname & path_r,			// rpm file to check
+                                               const Pathname & root_r,			// target root
+                                               bool  requireGPGSig_r,			// whether no gpg signature is to be reported
+                                               RpmDb::CheckPackageDetail & detail_r )	// detailed result
+  {
+    PathInfo file( path_r );
+    if ( ! file.isFile() )
+    {
+      ERR << "Not a file: " << file << endl;
+      return RpmDb::CHK_ERROR;
+    }
+
+    FD_t fd = ::Fopen( file.asString().c_str(), "r.ufdio" );
+    if ( fd == 0 || ::Ferror(fd) )
+    {
+      ERR << "Can't open file for reading: " << file << " (" << ::Fstrerror(fd) << ")" << endl;
+      if ( fd )
+        ::Fclose( fd );
+      return RpmDb::CHK_ERROR;
+    }
+    rpmts ts = ::rpmtsCreate();
+    ::rpmtsSetRootDir( ts, root_r.c_str() );
+    ::rpmtsSetVSFlags( ts, RPMVSF_DEFAULT );
+#ifdef HAVE_RPM_VERIFY_TRANSACTION_STEP
+    ::rpmtsSetVfyFlags( ts, RPMVSF_DEFAULT );
+#endif
+
+    RpmlogCapture vresult;
+    LocaleGuard guard( LC_ALL, "C" );	// bsc#1076415: rpm log output is localized, but we need to parse it :(
+    static rpmQVKArguments_s qva = ([](){ rpmQVKArguments_s qva; memset( &qva, 0, sizeof(rpmQVKArguments_s) ); return qva; })();
+    int res = ::rpmVerifySignatures( &qva, ts, fd, path_r.basename().c_str() );
+    guard.restore();
+
+    ts = rpmtsFree(ts);
+    ::Fclose( fd );
+
+    return evaluateSigCheck( path_r, requireGPGSig_r, res, vresult, detail_r );
+  }
+
 } // namespace
 ///////////////////////////////////////////////////////////////////
 //
@@ -1334,7 +1406,80 @@ RpmDb::CheckPackageResult RpmDb::checkPackage( const Pathname & path_r )
 { CheckPackageDetail dummy; return checkPackage( path_r, dummy ); }
 
 RpmDb::CheckPackageResult RpmDb::checkPackageSignature( const Pathname & path_r, RpmDb::CheckPackageDetail & detail_r )
-{ return doCheckPackageSig( path_r, root(), true/*requireGPGSig_r*/, detail_r ); }
+{
+  if ( auto checked = SigCheckCache::instance().take( root(), path_r ) )
+  {
+    DBG << path_r << " [checked in advance: " << checked->_result << "]" << endl;
+    detail_r.insert( detail_r.end(), checked->_detail.begin(), checked->_detail.end() );
+    return checked->_result;
+  }
+  return doCheckPackageSig( path_r, root(), true/*requireGPGSig_r*/, detail_r );
+}
+
+std::vector<RpmDb::CheckPackageResult> RpmDb::checkPackageSignatures( const std::vector<Pathname> & paths_r, unsigned jobs_r )
+{
+  std::vector<CheckPackageResult> ret;
+  ret.reserve( paths_r.size() );
+  if ( ! initialized() || paths_r.size() < 2 )
+  {
+    for ( const Pathname & path : paths_r )
+    {
+      CheckPackageDetail detail;
+      ret.push_back( doCheckPackageSig( path, root(), true/*requireGPGSig_r*/, detail ) );
+      SigCheckCache::instance().remember( root(), path, ret.back(), std::move(detail) );
+    }
+    return ret;
+  }
+
+  if ( ! jobs_r )
+    jobs_r = std::max( std::thread::hardware_concurrency(), 1U );
+  MIL << "Checking " << paths_r.size() << " package signatures (" << jobs_r << " parallel)" << endl;
+
+  // Each 'rpm -Kv' uses its own keyring handle. Its output is the same
+  // rpmVerifySignatures prints when checking a package in-process.
+  ret.resize( paths_r.size(), CHK_ERROR );
+  std::deque<std::pair<unsigned,std::unique_ptr<ExternalProgram>>> running;
+
+  auto collect = [&]() {
+    auto & [ idx, prog ] = running.front();
+    std::vector<std::string> lines;
+    for ( std::string line( prog->receiveLine() ); line.length(); line = prog->receiveLine() )
+    {
+      if ( line.back() == '\n' )
+        line.pop_back();
+      lines.push_back( std::move(line) );
+    }
+    int res = prog->close();
+
+    const Pathname & path { paths_r[idx] };
+    CheckPackageDetail detail;
+    if ( lines.empty() )	// rpm did not run
+      ERR << "Failed to check " << path << ": exit " << res << endl;
+    else
+      ret[idx] = evaluateSigCheck( path, true/*requireGPGSig_r*/, res, lines, detail );
+    SigCheckCache::instance().remember( root(), path, ret[idx], std::move(detail) );
+    running.pop_front();
+  };
+
+  for ( unsigned idx = 0; idx < paths_r.size(); ++idx )
+  {
+    if ( running.size() >= jobs_r )
+      collect();
+
+    ExternalProgram::Arguments argv {
+      "rpm",
+      "--root", _root.asString(),
+      "--dbpath", _dbPath.asString(),
+      "-Kv",
+      paths_r[idx].asString()
+    };
+    running.emplace_back( idx, std::make_unique<ExternalProgram>( argv, ExternalProgram::Stderr_To_Stdout, false, -1, true ) );
+  }
+  while ( ! running.empty() )
+    collect();
+
+  return ret;
+}
 
 
 // determine changed files of installed package
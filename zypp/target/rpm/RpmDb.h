@@ -417,6 +417,24 @@ public:
    */
   CheckPackageResult checkPackageSignature( const Pathname & path_r, CheckPackageDetail & detail_r );
 
+  /**
+   * Check the signatures of several rpm files at once (strict check like \ref checkPackageSignature).
+   *
+   * The files are checked by up to \a jobs_r concurrent <tt>rpm -Kv</tt> processes,
+   * each one using its own keyring handle. A value of \c 0 uses one per CPU.
+   *
+   * The results are remembered. The next \ref checkPackageSignature of a file (or a
+   * hardlink to it) returns the remembered result instead of checking it again, as
+   * long as the checked file still exists unchanged. Remembered results are dropped
+   * when a key is imported into or removed from the rpm database.
+   *
+   * @param paths_r which files to check
+   * @param jobs_r how many files to check at once
+   *
+   * @return The CheckPackageResult of each file
+   */
+  std::vector<CheckPackageResult> checkPackageSignatures( const std::vector<Pathname> & paths_r, unsigned jobs_r = 0 );
+
   /** install rpm package
    *
    * @param filename file to install
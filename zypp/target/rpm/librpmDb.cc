@@ -126,6 +126,7 @@ public:
   }
 
 private:
+  friend class librpmDb;	// scopedDbPath
   static void macroSetDbpath( const Pathname & dppath_r )
   { ::addMacro( NULL, "_dbpath", NULL, dppath_r.asString().c_str(), RMIL_CMDLINE ); }
 
@@ -179,6 +180,19 @@ Pathname librpmDb::suggestedDbPath( const Pathname & root_r )
   return internal::suggestedDbPath( root_r );
 }
 
+OnScopeExit librpmDb::scopedDbPath( const Pathname & dbPath_r )
+{
+  if ( ! globalInit() )
+    ZYPP_THROW(GlobalRpmInitException());
+
+  OnScopeExit ret;
+  if ( ! dbPath_r.empty() && dbPath_r != internal::rpmDefaultDbPath() ) {
+    ret.setDispose( &D::macroResetDbpath );
+    D::macroSetDbpath( dbPath_r );
+  }
+  return ret;
+}
+
 bool librpmDb::dbExists( const Pathname & root_r, const Pathname & dbPath_r )
 {
   if ( ! root_r.absolute() )
@@ -17,6 +17,7 @@
 #include <zypp/base/ReferenceCounted.h>
 #include <zypp/base/NonCopyable.h>
 #include <zypp/base/PtrTypes.h>
+#include <zypp/AutoDispose.h>
 #include <zypp/PathInfo.h>
 #include <zypp/target/rpm/RpmHeader.h>
 #include <zypp/target/rpm/RpmException.h>
@@ -120,6 +121,14 @@ public:
    */
   static librpmDb::constPtr dbOpenCreate( const Pathname & root_r, const Pathname & dbPath_r = Pathname() );
 
+  /** Let librpm use \a dbPath_r until the returned guard is destroyed.
+   * For code opening the rpmdb via librpm on its own, like libsolv's
+   * \c rpm_state_create. Does nothing if \a dbPath_r is the default.
+   *
+   * \throws GlobalRpmInitException if librpm can not be initialized.
+   */
+  static OnScopeExit scopedDbPath( const Pathname & dbPath_r );
+
   /**
    * Subclass to retrieve database content.
    **/